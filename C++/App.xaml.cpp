@@ -12,6 +12,7 @@
 #include "pch.h"
 #include "MainPage.xaml.h"
 #include "Common\SuspensionManager.h"
+#include "Common\StartupTrace.h"
 
 using namespace SDKSample;
 using namespace SDKSample::Common;
@@ -38,6 +39,8 @@ using namespace Windows::UI::Xaml::Navigation;
 /// </summary>
 App::App()
 {
+    StartupTrace::Mark(L"app constructing");
+
     InitializeComponent();
 
     auto suspending = rxrt::FromEventPattern<SuspendingEventHandler, SuspendingEventArgs>(
@@ -77,6 +80,8 @@ App::App()
 /// <param name="args">Details about the launch request and process.</param>
 void App::OnLaunched(LaunchActivatedEventArgs^ args)
 {
+    StartupTrace::Mark(L"launched");
+
     auto rootFrame = dynamic_cast<Frame^>(Window::Current->Content);
 
     // Do not repeat app initialization when the Window already has content,
@@ -0,0 +1,271 @@
+﻿//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ActivityClassifier.h
+// Declaration of the ActivityClassifier class
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <cmath>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        enum class Activity
+        {
+            Unknown,
+            Still,
+            Walking,
+            Vibrating,
+            InTransit
+        };
+
+        inline const wchar_t* ActivityName(Activity activity)
+        {
+            switch (activity)
+            {
+            case Activity::Still:
+                return L"Still";
+            case Activity::Walking:
+                return L"Walking";
+            case Activity::Vibrating:
+                return L"Vibrating";
+            case Activity::InTransit:
+                return L"In transit";
+            default:
+                return L"Unknown";
+            }
+        }
+
+        /// <summary>
+        /// Features of one window of readings, all computed on the magnitude so that they do
+        /// not depend on how the device is held.
+        /// </summary>
+        struct ActivityFeatures
+        {
+            enum Feature
+            {
+                // mean magnitude, in g
+                Mean,
+                // standard deviation of the magnitude, in g
+                Deviation,
+                // crossings of the window mean per second
+                Crossings,
+                // share of the variation that is above a quarter of the sample rate
+                HighBand,
+                Count
+            };
+
+            double Values[Count];
+        };
+
+        /// <summary>
+        /// A window of readings handed between the stages of a processing graph, made with
+        /// MakePooled so that windows are recycled instead of allocated.
+        /// </summary>
+        struct ReadingWindow
+        {
+            static const size_t Capacity = 128;
+
+            // the time between readings, in 100ns units
+            long long Period;
+            size_t Count;
+            SensorSample Samples[Capacity];
+        };
+
+        /// <summary>
+        /// Classifies windows of readings into an Activity.  Features are accumulated as the
+        /// readings arrive and the window is classified by walking a fixed decision tree that is
+        /// stored as a constant table.  Readings should arrive at a fixed rate, e.g. from the
+        /// Resampler.  The window buffer is allocated by the constructor, so classifying does
+        /// not allocate.
+        /// </summary>
+        class ActivityClassifier
+        {
+        public:
+            /// <summary>
+            /// window is the number of readings per decision, period the time between readings
+            /// in 100ns units.
+            /// </summary>
+            ActivityClassifier(size_t window, long long period) :
+                magnitudes(window),
+                current(Activity::Unknown)
+            {
+                SetPeriod(period);
+            }
+
+            /// <summary>
+            /// Changes the time between readings and starts a new window.
+            /// </summary>
+            void SetPeriod(long long period)
+            {
+                secondsPerReading = static_cast<double>(period) / 10000000.0;
+                Reset();
+            }
+
+            size_t Window() const
+            {
+                return magnitudes.size();
+            }
+
+            void Reset()
+            {
+                count = 0;
+                sum = 0.0;
+                squares = 0.0;
+                differenceSquares = 0.0;
+            }
+
+            Activity Current() const
+            {
+                return current;
+            }
+
+            const ActivityFeatures& Features() const
+            {
+                return features;
+            }
+
+            /// <summary>
+            /// Returns true when the reading completed a window and Current was updated.
+            /// </summary>
+            bool Push(const SensorSample& sample)
+            {
+                Add(sample);
+                if (count < magnitudes.size())
+                {
+                    return false;
+                }
+
+                Extract();
+                current = Classify(features);
+                Reset();
+                return true;
+            }
+
+            /// <summary>
+            /// Classifies count readings as one window, e.g. a window cut by timestamp that may
+            /// be short, and updates Current.  Readings beyond Window are ignored.
+            /// </summary>
+            Activity Classify(const SensorSample* readings, size_t count)
+            {
+                Reset();
+                count = count < magnitudes.size() ? count : magnitudes.size();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    Add(readings[i]);
+                }
+                if (count != 0)
+                {
+                    Extract();
+                    current = Classify(features);
+                    Reset();
+                }
+                return current;
+            }
+
+            /// <summary>
+            /// Walks the decision tree.
+            /// </summary>
+            static Activity Classify(const ActivityFeatures& features)
+            {
+                const Node* nodes = Tree();
+                int index = 0;
+                while (nodes[index].Feature != Leaf)
+                {
+                    const Node& node = nodes[index];
+                    index = features.Values[node.Feature] < node.Threshold ? node.Below : node.Above;
+                }
+                return nodes[index].Result;
+            }
+
+        private:
+            static const int Leaf = -1;
+
+            struct Node
+            {
+                int Feature;
+                double Threshold;
+                int Below;
+                int Above;
+                Activity Result;
+            };
+
+            /// <summary>
+            /// The tree, one node per row.  Thresholds assume windows of about a second of
+            /// readings in g.
+            /// </summary>
+            static const Node* Tree()
+            {
+                static const Node nodes[] = {
+                    /* 0 */ {ActivityFeatures::Deviation, 0.02, 1, 2, Activity::Unknown},
+                    /* 1 */ {Leaf, 0.0, 0, 0, Activity::Still},
+                    /* 2 */ {ActivityFeatures::HighBand, 0.5, 4, 3, Activity::Unknown},
+                    /* 3 */ {Leaf, 0.0, 0, 0, Activity::Vibrating},
+                    /* 4 */ {ActivityFeatures::Deviation, 0.08, 5, 6, Activity::Unknown},
+                    /* 5 */ {Leaf, 0.0, 0, 0, Activity::InTransit},
+                    /* 6 */ {ActivityFeatures::Crossings, 2.0, 5, 7, Activity::Unknown},
+                    /* 7 */ {Leaf, 0.0, 0, 0, Activity::Walking}
+                };
+                return nodes;
+            }
+
+            void Add(const SensorSample& sample)
+            {
+                double magnitude = std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+                if (count != 0)
+                {
+                    double difference = magnitude - magnitudes[count - 1];
+                    differenceSquares += difference * difference;
+                }
+                magnitudes[count++] = magnitude;
+                sum += magnitude;
+                squares += magnitude * magnitude;
+            }
+
+            void Extract()
+            {
+                double n = static_cast<double>(count);
+                double mean = sum / n;
+                double variance = squares / n - mean * mean;
+                variance = variance > 0.0 ? variance : 0.0;
+
+                int crossings = 0;
+                for (size_t i = 1; i < count; ++i)
+                {
+                    if ((magnitudes[i - 1] < mean) != (magnitudes[i] < mean))
+                    {
+                        ++crossings;
+                    }
+                }
+
+                // the first difference has twice the variance of white noise and a
+                // small share of the variance of slow motion
+                double differenceVariance = count > 1 ? differenceSquares / (n - 1.0) : 0.0;
+
+                features.Values[ActivityFeatures::Mean] = mean;
+                features.Values[ActivityFeatures::Deviation] = std::sqrt(variance);
+                features.Values[ActivityFeatures::Crossings] = crossings / (n * secondsPerReading);
+                features.Values[ActivityFeatures::HighBand] = variance > 0.0 ? differenceVariance / (4.0 * variance) : 0.0;
+            }
+
+            std::vector<double> magnitudes;
+            double secondsPerReading;
+            size_t count;
+            double sum;
+            double squares;
+            double differenceSquares;
+            ActivityFeatures features;
+            Activity current;
+        };
+    }
+}
@@ -0,0 +1,131 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// AllocationCounter.cpp
+// Implementation of the AllocationCounter class
+//
+
+#include "pch.h"
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace SDKSample::Common;
+
+#if defined(_MSC_VER)
+#define ALLOCATION_THREAD_LOCAL __declspec(thread)
+#else
+#define ALLOCATION_THREAD_LOCAL __thread
+#endif
+
+namespace
+{
+    const int stageCount = static_cast<int>(AllocationStage::Count);
+
+    std::atomic<unsigned long long> counts[stageCount];
+
+    ALLOCATION_THREAD_LOCAL int currentStage = static_cast<int>(AllocationStage::Other);
+}
+
+bool AllocationCounter::Enabled()
+{
+#if defined(SDKSAMPLE_COUNT_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationStage AllocationCounter::Enter(AllocationStage stage)
+{
+    auto previous = static_cast<AllocationStage>(currentStage);
+    currentStage = static_cast<int>(stage);
+    return previous;
+}
+
+void AllocationCounter::Record()
+{
+    counts[currentStage].fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocationSnapshot AllocationCounter::Snapshot()
+{
+    AllocationSnapshot snapshot;
+    for (int i = 0; i < stageCount; ++i)
+    {
+        snapshot.Counts[i] = counts[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+const wchar_t* AllocationCounter::StageName(AllocationStage stage)
+{
+    switch (stage)
+    {
+    case AllocationStage::Sensor:
+        return L"sensor";
+    case AllocationStage::Ui:
+        return L"ui";
+    default:
+        return L"other";
+    }
+}
+
+#if defined(SDKSAMPLE_COUNT_ALLOCATIONS)
+
+// Replace the global allocation functions so that every allocation in the app is counted.
+
+void* operator new(size_t size)
+{
+    AllocationCounter::Record();
+    void* p = std::malloc(size != 0 ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw()
+{
+    AllocationCounter::Record();
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) throw()
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw()
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) throw()
+{
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,92 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// AllocationCounter.h
+// Declaration of the AllocationCounter class
+//
+
+#pragma once
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// The pipeline stage that allocations are charged to.  The stage is tracked per thread.
+        /// </summary>
+        enum class AllocationStage
+        {
+            Other,
+            Sensor,
+            Ui,
+            Count
+        };
+
+        /// <summary>
+        /// A copy of the allocation counters at one point in time.
+        /// </summary>
+        struct AllocationSnapshot
+        {
+            unsigned long long Counts[static_cast<int>(AllocationStage::Count)];
+
+            unsigned long long Total() const
+            {
+                unsigned long long total = 0;
+                for (auto count : Counts)
+                {
+                    total += count;
+                }
+                return total;
+            }
+        };
+
+        /// <summary>
+        /// Counts calls to the global operator new, charged to the stage of the calling thread.
+        /// Counting is only compiled in when SDKSAMPLE_COUNT_ALLOCATIONS is defined (Debug
+        /// builds); otherwise every count stays zero.  Allocations made by the WinRT heap,
+        /// e.g. for Platform::String, do not go through operator new and are not counted.
+        /// </summary>
+        class AllocationCounter
+        {
+        public:
+            static bool Enabled();
+
+            /// <summary>
+            /// Makes stage the current stage of the calling thread and returns the previous one.
+            /// </summary>
+            static AllocationStage Enter(AllocationStage stage);
+
+            static void Record();
+
+            static AllocationSnapshot Snapshot();
+
+            static const wchar_t* StageName(AllocationStage stage);
+        };
+
+        /// <summary>
+        /// Charges the allocations made on this thread during its lifetime to a stage.
+        /// </summary>
+        class AllocationScope
+        {
+        public:
+            explicit AllocationScope(AllocationStage stage) : previous(AllocationCounter::Enter(stage))
+            {
+            }
+
+            ~AllocationScope()
+            {
+                AllocationCounter::Enter(previous);
+            }
+
+        private:
+            AllocationScope(const AllocationScope&);
+            AllocationScope& operator=(const AllocationScope&);
+
+            AllocationStage previous;
+        };
+    }
+}
@@ -0,0 +1,173 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BlockPool.h
+// Declaration of the BlockPool and PoolAllocator classes
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Recycles the memory of blocks of one size.  Blocks are taken on a producing thread
+        /// and given back on whichever thread drops the last reference, so the free list is
+        /// guarded by a lock that is held for a push or a pop.  Up to Retained free blocks are
+        /// kept; the rest go back to the heap.
+        /// </summary>
+        class BlockPool
+        {
+        public:
+            static const size_t Retained = 64;
+
+            BlockPool() : size(0)
+            {
+            }
+
+            ~BlockPool()
+            {
+                for (auto block : free)
+                {
+                    ::operator delete(block);
+                }
+            }
+
+            void* Allocate(size_t bytes)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (size == 0)
+                    {
+                        size = bytes;
+                        free.reserve(Retained);
+                    }
+                    if (bytes == size && !free.empty())
+                    {
+                        void* block = free.back();
+                        free.pop_back();
+                        return block;
+                    }
+                }
+                return ::operator new(bytes);
+            }
+
+            void Free(void* block, size_t bytes)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (bytes == size && free.size() < Retained)
+                    {
+                        free.push_back(block);
+                        return;
+                    }
+                }
+                ::operator delete(block);
+            }
+
+        private:
+            BlockPool(const BlockPool&);
+            BlockPool& operator=(const BlockPool&);
+
+            std::mutex lock;
+            size_t size;
+            std::vector<void*> free;
+        };
+
+        /// <summary>
+        /// An allocator for std::allocate_shared that takes the object and its reference counts
+        /// from a BlockPool in one piece.  Each copy holds the pool, so it lives until the last
+        /// block is given back.
+        /// </summary>
+        template<class T>
+        class PoolAllocator
+        {
+        public:
+            typedef T value_type;
+            typedef T* pointer;
+            typedef const T* const_pointer;
+            typedef T& reference;
+            typedef const T& const_reference;
+            typedef size_t size_type;
+            typedef ptrdiff_t difference_type;
+
+            template<class U>
+            struct rebind
+            {
+                typedef PoolAllocator<U> other;
+            };
+
+            explicit PoolAllocator(const std::shared_ptr<BlockPool>& pool) : pool(pool)
+            {
+            }
+
+            template<class U>
+            PoolAllocator(const PoolAllocator<U>& other) : pool(other.Pool())
+            {
+            }
+
+            T* allocate(size_t count)
+            {
+                return static_cast<T*>(pool->Allocate(count * sizeof(T)));
+            }
+
+            void deallocate(T* block, size_t count)
+            {
+                pool->Free(block, count * sizeof(T));
+            }
+
+            template<class U, class... Arguments>
+            void construct(U* place, Arguments&&... arguments)
+            {
+                ::new (static_cast<void*>(place)) U(std::forward<Arguments>(arguments)...);
+            }
+
+            template<class U>
+            void destroy(U* place)
+            {
+                place->~U();
+            }
+
+            const std::shared_ptr<BlockPool>& Pool() const
+            {
+                return pool;
+            }
+
+            template<class U>
+            bool operator==(const PoolAllocator<U>& other) const
+            {
+                return pool == other.Pool();
+            }
+
+            template<class U>
+            bool operator!=(const PoolAllocator<U>& other) const
+            {
+                return pool != other.Pool();
+            }
+
+        private:
+            std::shared_ptr<BlockPool> pool;
+        };
+
+        /// <summary>
+        /// A T made with std::allocate_shared from pool, so that it is recycled with its
+        /// reference counts when the last reference is dropped.
+        /// </summary>
+        template<class T>
+        std::shared_ptr<T> MakePooled(const std::shared_ptr<BlockPool>& pool)
+        {
+            return std::allocate_shared<T>(PoolAllocator<T>(pool));
+        }
+    }
+}
@@ -0,0 +1,291 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BoundedQueue.h
+// Declaration of the BoundedQueue class
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// What BoundedQueue does with a value that arrives while the queue is full.
+        /// </summary>
+        enum class OverflowPolicy
+        {
+            // keep only the newest value, the queue never holds more than one
+            LatestOnly,
+            // drop the oldest queued value to make room
+            DropOldest,
+            // wait on the producer thread until the consumer makes room
+            BlockProducer,
+            // like LatestOnly, but deliver at most once per interval
+            Sample
+        };
+
+        /// <summary>
+        /// Hands values from a producer thread to a consumer that runs wherever the scheduler
+        /// runs its work, e.g. the ui thread, holding at most Capacity values in between.  At
+        /// most one drain is scheduled at a time and it delivers the values that were queued
+        /// when it started, so a slow consumer sees fresh values instead of a growing backlog.
+        /// The scheduler is a function that runs work after a delay, so the queue can be driven
+        /// by a dispatcher in the app and by VirtualTimeScheduler elsewhere.  Finish queues the
+        /// end of the stream behind the values, and Close drops them; once Close returns the
+        /// consumer is not called again.  Create it with std::make_shared, scheduled drains keep
+        /// it alive.
+        /// </summary>
+        template<class T>
+        class BoundedQueue : public std::enable_shared_from_this<BoundedQueue<T>>
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+            typedef std::function<void()> Work;
+            typedef std::function<void(clock::duration, Work)> Scheduler;
+            typedef std::function<void(const T&)> Consumer;
+
+            /// <summary>
+            /// interval is only used by OverflowPolicy::Sample.
+            /// </summary>
+            BoundedQueue(OverflowPolicy policy, size_t capacity, clock::duration interval, Scheduler scheduler, Consumer consumer) :
+                policy(policy),
+                interval(interval),
+                scheduler(std::move(scheduler)),
+                consumer(std::move(consumer)),
+                values(policy == OverflowPolicy::LatestOnly || policy == OverflowPolicy::Sample || capacity == 0 ? 1 : capacity),
+                head(0),
+                size(0),
+                scheduled(false),
+                closed(false),
+                finishing(false),
+                pushed(0),
+                delivered(0),
+                dropped(0),
+                blocked(0),
+                maximumDepth(0)
+            {
+            }
+
+            OverflowPolicy Policy() const
+            {
+                return policy;
+            }
+
+            size_t Capacity() const
+            {
+                return values.size();
+            }
+
+            void Push(const T& value)
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (closed || finishing)
+                {
+                    return;
+                }
+                ++pushed;
+
+                if (size == values.size())
+                {
+                    if (policy == OverflowPolicy::BlockProducer)
+                    {
+                        ++blocked;
+                        space.wait(guard, [this]()
+                        {
+                            return size < values.size() || closed || finishing;
+                        });
+                        if (closed || finishing)
+                        {
+                            return;
+                        }
+                    }
+                    else
+                    {
+                        // LatestOnly and Sample hold one value, so this replaces it
+                        head = (head + 1) % values.size();
+                        --size;
+                        ++dropped;
+                    }
+                }
+
+                values[(head + size) % values.size()] = value;
+                ++size;
+                maximumDepth = size > maximumDepth ? size : maximumDepth;
+
+                ScheduleDrain(guard);
+            }
+
+            /// <summary>
+            /// Ends the stream: values pushed afterwards are ignored, and once the queued values
+            /// are delivered the queue is closed and terminal runs where the consumer does, e.g.
+            /// to pass on OnCompleted or OnError after the last value.
+            /// </summary>
+            void Finish(Work terminal)
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (closed || finishing)
+                {
+                    return;
+                }
+                finishing = true;
+                this->terminal = std::move(terminal);
+                space.notify_all();
+                ScheduleDrain(guard);
+            }
+
+            /// <summary>
+            /// Drops the queued values and a pending Finish, and releases a blocked producer.
+            /// Values pushed afterwards are ignored.  If the consumer is running on another
+            /// thread, waits for it to return, so that it is not called after Close.
+            /// </summary>
+            void Close()
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                closed = true;
+                dropped += size;
+                size = 0;
+                terminal = nullptr;
+                space.notify_all();
+                idle.wait(guard, [this]()
+                {
+                    return delivering == std::thread::id() || delivering == std::this_thread::get_id();
+                });
+            }
+
+            size_t Depth() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return size;
+            }
+
+            unsigned long long Pushed() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return pushed;
+            }
+
+            unsigned long long Delivered() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return delivered;
+            }
+
+            unsigned long long Dropped() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return dropped;
+            }
+
+            std::wstring Report(const std::wstring& name) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                std::wostringstream out;
+                out << name
+                    << L": pushed=" << pushed
+                    << L" delivered=" << delivered
+                    << L" dropped=" << dropped
+                    << L" producer waits=" << blocked
+                    << L" queued max=" << maximumDepth << L"/" << values.size()
+                    << L"\n";
+                return out.str();
+            }
+
+        private:
+            BoundedQueue(const BoundedQueue&);
+            BoundedQueue& operator=(const BoundedQueue&);
+
+            void ScheduleDrain(std::unique_lock<std::mutex>& guard)
+            {
+                if (scheduled || closed || (size == 0 && !terminal))
+                {
+                    return;
+                }
+                scheduled = true;
+                auto self = this->shared_from_this();
+                auto delay = policy == OverflowPolicy::Sample ? interval : clock::duration::zero();
+                guard.unlock();
+                scheduler(delay, [self]()
+                {
+                    self->Drain();
+                });
+                guard.lock();
+            }
+
+            void Drain()
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                // only what is queued now, so that a fast producer cannot keep the consumer here;
+                // Close may come from the consumer or another thread between values
+                for (size_t remaining = size; remaining != 0 && size != 0 && !closed; --remaining)
+                {
+                    T value = values[head];
+                    head = (head + 1) % values.size();
+                    --size;
+                    ++delivered;
+                    space.notify_one();
+
+                    delivering = std::this_thread::get_id();
+                    guard.unlock();
+                    consumer(value);
+                    guard.lock();
+                    delivering = std::thread::id();
+                    idle.notify_all();
+                }
+                scheduled = false;
+
+                if (!closed && size == 0 && terminal)
+                {
+                    // the end of the stream, after the last value, with the queue closed
+                    Work last = std::move(terminal);
+                    terminal = nullptr;
+                    closed = true;
+                    guard.unlock();
+                    last();
+                    return;
+                }
+                ScheduleDrain(guard);
+            }
+
+            OverflowPolicy policy;
+            clock::duration interval;
+            Scheduler scheduler;
+            Consumer consumer;
+
+            mutable std::mutex lock;
+            std::condition_variable space;
+            // signalled when the consumer returns
+            std::condition_variable idle;
+            std::vector<T> values;
+            size_t head;
+            size_t size;
+            bool scheduled;
+            bool closed;
+            bool finishing;
+            Work terminal;
+            // the thread that is running the consumer, if any
+            std::thread::id delivering;
+
+            unsigned long long pushed;
+            unsigned long long delivered;
+            unsigned long long dropped;
+            unsigned long long blocked;
+            size_t maximumDepth;
+        };
+    }
+}
@@ -0,0 +1,241 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BroadcastHub.h
+// Declaration of the SensorBatch struct and the BroadcastHub class
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "BlockPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// The readings delivered by one sensor callback.
+        /// </summary>
+        struct SensorBatch
+        {
+            static const size_t Capacity = 8;
+
+            size_t Count;
+            SensorSample Samples[Capacity];
+        };
+
+        /// <summary>
+        /// Fans immutable, ref-counted blocks out to any number of subscribers.  Publish hands
+        /// each subscriber the same block by const reference, so a block costs no copies no
+        /// matter how many subscribers there are; a subscriber that wants to keep a block copies
+        /// the Block pointer.  Allocate takes blocks from a pool that they return to when the
+        /// last reference is dropped, so publishing does not allocate once the pool is warm.
+        /// The subscriber list is copy-on-write: Subscribe and Unsubscribe build a new list
+        /// under a writer lock and swap the pointer in, and Publish reads it without a lock.
+        /// A replaced list is freed once the publisher is not reading it, which Publish shows
+        /// with a hazard pointer, so Publish must be called by one thread at a time, as the
+        /// readings of one sensor are.  Subscribers are called on the publishing thread and must
+        /// not block.  Terminate ends the stream: every subscriber is told and dropped, or only
+        /// the ones it is given, so that the stream of one source can end while the sinks of
+        /// the hub stay subscribed for the next.
+        /// </summary>
+        template<class T>
+        class BroadcastHub
+        {
+        public:
+            typedef std::shared_ptr<const T> Block;
+            typedef std::function<void(const Block&)> Subscriber;
+            // called once with null when the stream completes, or with the error that ended it
+            typedef std::function<void(const std::exception_ptr&)> Terminal;
+            typedef unsigned long long Token;
+
+            BroadcastHub() :
+                blocks(std::make_shared<BlockPool>()),
+                subscribers(new List()),
+                reading(nullptr),
+                nextToken(0)
+            {
+            }
+
+            ~BroadcastHub()
+            {
+                delete subscribers.load();
+                for (auto list : retired)
+                {
+                    delete list;
+                }
+            }
+
+            /// <summary>
+            /// A block to fill and publish, from the pool of the hub.
+            /// </summary>
+            std::shared_ptr<T> Allocate()
+            {
+                return MakePooled<T>(blocks);
+            }
+
+            Token Subscribe(Subscriber subscriber, Terminal terminal = nullptr)
+            {
+                std::lock_guard<std::mutex> guard(writers);
+                auto list = new List(*subscribers.load());
+                Entry entry = {nextToken++, std::move(subscriber), std::move(terminal)};
+                list->push_back(entry);
+                Replace(list);
+                return entry.Id;
+            }
+
+            /// <summary>
+            /// Returns the number of subscribers that are left.
+            /// </summary>
+            size_t Unsubscribe(Token token)
+            {
+                std::lock_guard<std::mutex> guard(writers);
+                auto current = subscribers.load();
+                auto list = new List();
+                list->reserve(current->size());
+                for (auto& entry : *current)
+                {
+                    if (entry.Id != token)
+                    {
+                        list->push_back(entry);
+                    }
+                }
+                Replace(list);
+                return list->size();
+            }
+
+            size_t Subscribers() const
+            {
+                std::lock_guard<std::mutex> guard(writers);
+                return subscribers.load()->size();
+            }
+
+            void Publish(const Block& block) const
+            {
+                // announce the list before reading it, and check it was not replaced meanwhile
+                const List* list = subscribers.load();
+                for (;;)
+                {
+                    reading.store(list);
+                    const List* again = subscribers.load();
+                    if (again == list)
+                    {
+                        break;
+                    }
+                    list = again;
+                }
+                for (auto& entry : *list)
+                {
+                    entry.OnBlock(block);
+                }
+                reading.store(nullptr, std::memory_order_release);
+            }
+
+            /// <summary>
+            /// Ends the stream with error, or completes it if error is null: each subscriber's
+            /// Terminal is called, on this thread, and the subscribers are dropped.
+            /// </summary>
+            void Terminate(const std::exception_ptr& error)
+            {
+                Terminate(error, [](Token)
+                {
+                    return true;
+                });
+            }
+
+            /// <summary>
+            /// Ends the stream for the subscribers of tokens only: their Terminals are called, on
+            /// this thread, and they are dropped.  The others stay subscribed.
+            /// </summary>
+            void Terminate(const std::exception_ptr& error, const std::vector<Token>& tokens)
+            {
+                Terminate(error, [&](Token token)
+                {
+                    return std::find(tokens.begin(), tokens.end(), token) != tokens.end();
+                });
+            }
+
+        private:
+            BroadcastHub(const BroadcastHub&);
+            BroadcastHub& operator=(const BroadcastHub&);
+
+            struct Entry
+            {
+                Token Id;
+                Subscriber OnBlock;
+                Terminal OnTerminal;
+            };
+            typedef std::vector<Entry> List;
+
+            template<class Ends>
+            void Terminate(const std::exception_ptr& error, Ends ends)
+            {
+                std::vector<Terminal> terminals;
+                {
+                    std::lock_guard<std::mutex> guard(writers);
+                    auto current = subscribers.load();
+                    auto list = new List();
+                    for (auto& entry : *current)
+                    {
+                        if (!ends(entry.Id))
+                        {
+                            list->push_back(entry);
+                        }
+                        else if (entry.OnTerminal)
+                        {
+                            terminals.push_back(entry.OnTerminal);
+                        }
+                    }
+                    Replace(list);
+                }
+
+                // outside the lock, since a subscriber may unsubscribe in response
+                for (auto& terminal : terminals)
+                {
+                    terminal(error);
+                }
+            }
+
+            // swaps list in and frees the replaced lists that the publisher is not reading;
+            // called under the writer lock
+            void Replace(const List* list)
+            {
+                retired.push_back(subscribers.exchange(list));
+                const List* inUse = reading.load();
+                size_t kept = 0;
+                for (auto old : retired)
+                {
+                    if (old == inUse)
+                    {
+                        retired[kept++] = old;
+                    }
+                    else
+                    {
+                        delete old;
+                    }
+                }
+                retired.resize(kept);
+            }
+
+            std::shared_ptr<BlockPool> blocks;
+            mutable std::mutex writers;
+            std::atomic<const List*> subscribers;
+            mutable std::atomic<const List*> reading;
+            std::vector<const List*> retired;
+            Token nextToken;
+        };
+    }
+}
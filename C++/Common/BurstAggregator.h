@@ -0,0 +1,133 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BurstAggregator.h
+// Declaration of the BurstAggregator class
+//
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// A burst of events merged into one gesture.  Start and End are the timestamps of the
+        /// first and last event in 100ns units.  Completed is when the gesture was closed.
+        /// </summary>
+        struct ShakeGesture
+        {
+            typedef std::chrono::steady_clock clock;
+
+            unsigned int Events;
+            long long Start;
+            long long End;
+            double PeakIntensity;
+            clock::time_point Completed;
+
+            long long Duration() const
+            {
+                return End - Start;
+            }
+        };
+
+        /// <summary>
+        /// Merges events that are less than Gap apart into one ShakeGesture.  A gesture is closed
+        /// by the first event after the gap, or by Flush once the gap has passed without one, so
+        /// the events can be added on one thread and flushed from a timer on another.
+        /// </summary>
+        class BurstAggregator
+        {
+        public:
+            typedef ShakeGesture::clock clock;
+
+            /// <summary>
+            /// gap is in 100ns units, like the event timestamps.
+            /// </summary>
+            explicit BurstAggregator(long long gap) : gap(gap), pending(false)
+            {
+            }
+
+            long long Gap() const
+            {
+                return gap;
+            }
+
+            /// <summary>
+            /// Adds an event.  Returns true and fills completed when the event closed the previous
+            /// gesture.
+            /// </summary>
+            bool Add(long long timestamp, double intensity, ShakeGesture& completed)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                bool closed = false;
+                if (pending && timestamp - current.End >= gap)
+                {
+                    completed = Close();
+                    closed = true;
+                }
+                if (!pending)
+                {
+                    pending = true;
+                    current.Events = 0;
+                    current.Start = timestamp;
+                    current.End = timestamp;
+                    current.PeakIntensity = intensity;
+                }
+                ++current.Events;
+                current.Start = timestamp < current.Start ? timestamp : current.Start;
+                current.End = timestamp > current.End ? timestamp : current.End;
+                current.PeakIntensity = intensity > current.PeakIntensity ? intensity : current.PeakIntensity;
+                return closed;
+            }
+
+            /// <summary>
+            /// Closes the pending gesture if no event arrived for the gap before now, in 100ns
+            /// units on the same clock as the event timestamps.  Returns true and fills completed
+            /// when it did.
+            /// </summary>
+            bool Flush(long long now, ShakeGesture& completed)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!pending || now - current.End < gap)
+                {
+                    return false;
+                }
+                completed = Close();
+                return true;
+            }
+
+            /// <summary>
+            /// Drops the pending gesture.
+            /// </summary>
+            void Reset()
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                pending = false;
+            }
+
+        private:
+            BurstAggregator(const BurstAggregator&);
+            BurstAggregator& operator=(const BurstAggregator&);
+
+            ShakeGesture Close()
+            {
+                pending = false;
+                current.Completed = clock::now();
+                return current;
+            }
+
+            long long gap;
+            std::mutex lock;
+            bool pending;
+            ShakeGesture current;
+        };
+    }
+}
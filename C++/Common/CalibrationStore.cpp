@@ -0,0 +1,65 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CalibrationStore.cpp
+// Implementation of the CalibrationStore class
+//
+
+#include "pch.h"
+#include "CalibrationStore.h"
+#include "SuspensionManager.h"
+
+#include <collection.h>
+
+using namespace SDKSample::Common;
+
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation::Collections;
+
+namespace
+{
+    String^ calibrationKey = "AccelerometerCalibration";
+    String^ biasKeys[] = {"BiasX", "BiasY", "BiasZ"};
+    String^ scaleKeys[] = {"ScaleX", "ScaleY", "ScaleZ"};
+}
+
+CalibrationParameters CalibrationStore::Load()
+{
+    auto parameters = CalibrationParameters::Identity();
+    auto sessionState = SuspensionManager::SessionState;
+    if (!sessionState->HasKey(calibrationKey))
+    {
+        return parameters;
+    }
+
+    auto state = dynamic_cast<IMap<String^, Object^>^>(sessionState->Lookup(calibrationKey));
+    if (state == nullptr)
+    {
+        return parameters;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        if (state->HasKey(biasKeys[i]) && state->HasKey(scaleKeys[i]))
+        {
+            parameters.Bias[i] = safe_cast<double>(state->Lookup(biasKeys[i]));
+            parameters.Scale[i] = safe_cast<double>(state->Lookup(scaleKeys[i]));
+        }
+    }
+    return parameters;
+}
+
+void CalibrationStore::Save(const CalibrationParameters& parameters)
+{
+    auto state = ref new Map<String^, Object^>();
+    for (int i = 0; i < 3; ++i)
+    {
+        state->Insert(biasKeys[i], parameters.Bias[i]);
+        state->Insert(scaleKeys[i], parameters.Scale[i]);
+    }
+    SuspensionManager::SessionState->Insert(calibrationKey, state);
+}
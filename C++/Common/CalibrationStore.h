@@ -0,0 +1,35 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CalibrationStore.h
+// Declaration of the CalibrationStore class
+//
+
+#pragma once
+
+#include "SensorCalibration.h"
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Keeps the accelerometer calibration in <see cref="SuspensionManager::SessionState"/>
+        /// so that it survives navigation between scenarios and process lifetime management.
+        /// </summary>
+        class CalibrationStore
+        {
+        public:
+            /// <summary>
+            /// Returns the stored parameters, or the identity calibration when none are stored.
+            /// </summary>
+            static CalibrationParameters Load();
+
+            static void Save(const CalibrationParameters& parameters);
+        };
+    }
+}
@@ -0,0 +1,140 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CancellableWork.h
+// Declaration of the CancellableWork class
+//
+
+#pragma once
+
+#include "PipelineMetrics.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Cancellation and timing for the background work of a ReactiveCommand.  The ui thread
+        /// calls Queued when the command executes and Cancel when the work is no longer wanted;
+        /// the background thread calls Begin, checks the ticket between steps and waits with
+        /// WaitFor, which returns as soon as the work is cancelled so the thread is released
+        /// immediately.  Queue wait and execution time are recorded for each run.
+        /// </summary>
+        class CancellableWork
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+
+            struct Ticket
+            {
+                unsigned long long Generation;
+                clock::time_point Started;
+            };
+
+            CancellableWork() : generation(0), queuedGeneration(0)
+            {
+            }
+
+            /// <summary>
+            /// Called on the ui thread when the command executes.  Work that is cancelled after
+            /// this point, even before it starts, sees the cancellation.
+            /// </summary>
+            void Queued()
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                queuedAt = clock::now();
+                queuedGeneration = generation;
+            }
+
+            /// <summary>
+            /// Called on the background thread when the work starts.
+            /// </summary>
+            Ticket Begin()
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                Ticket ticket = {queuedGeneration, clock::now()};
+                queueWait.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(ticket.Started - queuedAt));
+                return ticket;
+            }
+
+            /// <summary>
+            /// Called on the background thread when the work finishes, cancelled or not.
+            /// </summary>
+            void End(const Ticket& ticket)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                execution.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - ticket.Started));
+            }
+
+            void Cancel()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    ++generation;
+                }
+                cancelled.notify_all();
+            }
+
+            bool IsCancelled(const Ticket& ticket) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return ticket.Generation != generation;
+            }
+
+            /// <summary>
+            /// Waits for the given time.  Returns false if the work was cancelled, either before
+            /// or during the wait.
+            /// </summary>
+            template<class Rep, class Period>
+            bool WaitFor(const Ticket& ticket, std::chrono::duration<Rep, Period> time)
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                return !cancelled.wait_for(guard, time, [&]()
+                {
+                    return ticket.Generation != generation;
+                });
+            }
+
+            std::wstring Report(const std::wstring& name) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                std::wostringstream out;
+                out << name
+                    << L": runs=" << execution.Count()
+                    << L" queue wait p50=" << Milliseconds(queueWait.Percentile(0.50)) << L"ms"
+                    << L" max=" << Milliseconds(queueWait.Maximum()) << L"ms"
+                    << L" execution p50=" << Milliseconds(execution.Percentile(0.50)) << L"ms"
+                    << L" max=" << Milliseconds(execution.Maximum()) << L"ms"
+                    << L"\n";
+                return out.str();
+            }
+
+        private:
+            CancellableWork(const CancellableWork&);
+            CancellableWork& operator=(const CancellableWork&);
+
+            static double Milliseconds(std::chrono::nanoseconds duration)
+            {
+                return static_cast<double>(duration.count()) / 1000000.0;
+            }
+
+            mutable std::mutex lock;
+            std::condition_variable cancelled;
+            unsigned long long generation;
+            unsigned long long queuedGeneration;
+            clock::time_point queuedAt;
+            LatencyHistogram queueWait;
+            LatencyHistogram execution;
+        };
+    }
+}
@@ -0,0 +1,620 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CompressedHistory.h
+// Declaration of the BitStream, HistoryChunk and CompressedHistory classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "TraceIndex.h"
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Appends bits to, and reads them back from, a vector of 64-bit words, most significant
+        /// bit first.
+        /// </summary>
+        class BitStream
+        {
+        public:
+            BitStream() : bits(0)
+            {
+            }
+
+            size_t Bits() const
+            {
+                return bits;
+            }
+
+            size_t Bytes() const
+            {
+                return words.capacity() * sizeof(uint64_t);
+            }
+
+            void Reserve(size_t count)
+            {
+                words.reserve((count + 63) / 64);
+            }
+
+            void Shrink()
+            {
+                words.shrink_to_fit();
+            }
+
+            /// <summary>
+            /// Appends the low count bits of value, count from 1 to 64.
+            /// </summary>
+            void Write(uint64_t value, unsigned int count)
+            {
+                if (count < 64)
+                {
+                    value &= (uint64_t(1) << count) - 1;
+                }
+                unsigned int used = bits % 64;
+                if (used == 0)
+                {
+                    words.push_back(0);
+                }
+                unsigned int free = 64 - used;
+                if (count <= free)
+                {
+                    words.back() |= value << (free - count);
+                }
+                else
+                {
+                    words.back() |= value >> (count - free);
+                    words.push_back(value << (64 - (count - free)));
+                }
+                bits += count;
+            }
+
+            /// <summary>
+            /// Reads count bits, count from 1 to 64, at position and advances it.
+            /// </summary>
+            uint64_t Read(size_t& position, unsigned int count) const
+            {
+                size_t word = position / 64;
+                unsigned int used = position % 64;
+                unsigned int left = 64 - used;
+                uint64_t value = (words[word] << used) >> (64 - count);
+                if (count > left)
+                {
+                    value |= words[word + 1] >> (64 - (count - left));
+                }
+                position += count;
+                return value;
+            }
+
+        private:
+            std::vector<uint64_t> words;
+            size_t bits;
+        };
+
+        /// <summary>
+        /// Readings compressed as in Gorilla: each timestamp as the change from the previous
+        /// interval, which takes one bit for a steady sensor and a 14 or 20-bit field for the
+        /// jitter of a sensor timestamped in 100ns ticks, and each axis as the XOR with its
+        /// previous value, of which only the bits that differ are stored.  A chunk holds up to a
+        /// fixed number of readings and decodes on its own, so a range query only decodes the
+        /// chunks that overlap it.  Received is not stored.
+        /// </summary>
+        class HistoryChunk
+        {
+        public:
+            explicit HistoryChunk(size_t capacity) : capacity(capacity), count(0), first(0), last(0), interval(0)
+            {
+                // a steady stream takes a few dozen bits per reading
+                stream.Reserve(capacity * 64);
+                for (int i = 0; i < 3; ++i)
+                {
+                    axes[i].Previous = 0;
+                    axes[i].Leading = NoWindow;
+                    axes[i].Trailing = 0;
+                }
+                summary.Reset();
+            }
+
+            size_t Count() const
+            {
+                return count;
+            }
+
+            bool Full() const
+            {
+                return count == capacity;
+            }
+
+            long long First() const
+            {
+                return first;
+            }
+
+            long long Last() const
+            {
+                return last;
+            }
+
+            const BlockSummary& Summary() const
+            {
+                return summary;
+            }
+
+            size_t Bytes() const
+            {
+                return sizeof(*this) + stream.Bytes();
+            }
+
+            /// <summary>
+            /// Releases the space reserved for readings that will not be appended.
+            /// </summary>
+            void Seal()
+            {
+                stream.Shrink();
+            }
+
+            void Append(const SensorSample& sample)
+            {
+                if (count == 0)
+                {
+                    first = sample.Timestamp;
+                    stream.Write(static_cast<uint64_t>(sample.Timestamp), 64);
+                }
+                else
+                {
+                    long long current = sample.Timestamp - last;
+                    WriteDeltaOfDelta(current - interval);
+                    interval = current;
+                }
+                last = sample.Timestamp;
+
+                WriteValue(axes[0], sample.X);
+                WriteValue(axes[1], sample.Y);
+                WriteValue(axes[2], sample.Z);
+                ++count;
+                summary.Add(sample);
+            }
+
+            /// <summary>
+            /// Calls visit(const SensorSample&amp;) for each reading from begin to end inclusive.
+            /// </summary>
+            template<class Visit>
+            void Decode(long long begin, long long end, Visit visit) const
+            {
+                size_t position = 0;
+                long long timestamp = 0;
+                long long current = 0;
+                Axis decoded[3];
+                for (int i = 0; i < 3; ++i)
+                {
+                    decoded[i].Previous = 0;
+                    decoded[i].Leading = 0;
+                    decoded[i].Trailing = 0;
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (i == 0)
+                    {
+                        timestamp = static_cast<long long>(stream.Read(position, 64));
+                    }
+                    else
+                    {
+                        current += ReadDeltaOfDelta(position);
+                        timestamp += current;
+                    }
+                    SensorSample sample;
+                    sample.Timestamp = timestamp;
+                    sample.X = ReadValue(decoded[0], position);
+                    sample.Y = ReadValue(decoded[1], position);
+                    sample.Z = ReadValue(decoded[2], position);
+                    sample.Received = SensorSample::clock::time_point();
+                    if (timestamp > end)
+                    {
+                        return;
+                    }
+                    if (timestamp >= begin)
+                    {
+                        visit(sample);
+                    }
+                }
+            }
+
+        private:
+            static const unsigned int NoWindow = 65;
+
+            struct Axis
+            {
+                uint64_t Previous;
+                // the window of meaningful bits of the last difference that was written in full
+                unsigned int Leading;
+                unsigned int Trailing;
+            };
+
+            static unsigned int LeadingZeros(uint64_t value)
+            {
+                unsigned int zeros = 0;
+                for (uint64_t bit = uint64_t(1) << 63; bit != 0 && (value & bit) == 0; bit >>= 1)
+                {
+                    ++zeros;
+                }
+                return zeros;
+            }
+
+            static unsigned int TrailingZeros(uint64_t value)
+            {
+                unsigned int zeros = 0;
+                for (uint64_t bit = 1; bit != 0 && (value & bit) == 0; bit <<= 1)
+                {
+                    ++zeros;
+                }
+                return zeros;
+            }
+
+            static uint64_t Bits(double value)
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+
+            static double Value(uint64_t bits)
+            {
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            // '0' for 0, prefixes 10, 110 and 1110 for 14, 20 and 32 bit two's complement values,
+            // and 1111 for a full 64-bit value.  Gorilla's 7, 9 and 12 bits suit timestamps in
+            // seconds; in 100ns ticks they would hold less than 0.2ms of jitter, and 14 bits
+            // hold 0.8ms, 20 bits 52ms and 32 bits 3.5 minutes
+            void WriteDeltaOfDelta(long long value)
+            {
+                if (value == 0)
+                {
+                    stream.Write(0, 1);
+                }
+                else if (value >= -(1LL << 13) && value < (1LL << 13))
+                {
+                    stream.Write(2, 2);
+                    stream.Write(static_cast<uint64_t>(value), 14);
+                }
+                else if (value >= -(1LL << 19) && value < (1LL << 19))
+                {
+                    stream.Write(6, 3);
+                    stream.Write(static_cast<uint64_t>(value), 20);
+                }
+                else if (value >= -(1LL << 31) && value < (1LL << 31))
+                {
+                    stream.Write(14, 4);
+                    stream.Write(static_cast<uint64_t>(value), 32);
+                }
+                else
+                {
+                    stream.Write(15, 4);
+                    stream.Write(static_cast<uint64_t>(value), 64);
+                }
+            }
+
+            long long ReadDeltaOfDelta(size_t& position) const
+            {
+                static const unsigned int widths[] = {0, 14, 20, 32, 64};
+                unsigned int prefix = 0;
+                while (prefix < 4 && stream.Read(position, 1) != 0)
+                {
+                    ++prefix;
+                }
+                unsigned int width = widths[prefix];
+                if (width == 0)
+                {
+                    return 0;
+                }
+                uint64_t value = stream.Read(position, width);
+                if (width < 64 && (value >> (width - 1)) != 0)
+                {
+                    return static_cast<long long>(value) - (1LL << width);
+                }
+                return static_cast<long long>(value);
+            }
+
+            // '0' for the same value, '10' and the bits within the window of the previous
+            // difference, or '11', 5 bits of leading zeros, 6 bits of length and the bits
+            void WriteValue(Axis& axis, double value)
+            {
+                uint64_t bits = Bits(value);
+                uint64_t difference = bits ^ axis.Previous;
+                axis.Previous = bits;
+                if (difference == 0)
+                {
+                    stream.Write(0, 1);
+                    return;
+                }
+                unsigned int leading = LeadingZeros(difference);
+                unsigned int trailing = TrailingZeros(difference);
+                leading = leading > 31 ? 31 : leading;
+                if (axis.Leading != NoWindow && leading >= axis.Leading && trailing >= axis.Trailing)
+                {
+                    stream.Write(2, 2);
+                    stream.Write(difference >> axis.Trailing, 64 - axis.Leading - axis.Trailing);
+                    return;
+                }
+                unsigned int length = 64 - leading - trailing;
+                stream.Write(3, 2);
+                stream.Write(leading, 5);
+                // a length of 64 is written as 0
+                stream.Write(length & 63, 6);
+                stream.Write(difference >> trailing, length);
+                axis.Leading = leading;
+                axis.Trailing = trailing;
+            }
+
+            double ReadValue(Axis& axis, size_t& position) const
+            {
+                if (stream.Read(position, 1) == 0)
+                {
+                    return Value(axis.Previous);
+                }
+                if (stream.Read(position, 1) != 0)
+                {
+                    axis.Leading = static_cast<unsigned int>(stream.Read(position, 5));
+                    unsigned int length = static_cast<unsigned int>(stream.Read(position, 6));
+                    length = length == 0 ? 64 : length;
+                    axis.Trailing = 64 - axis.Leading - length;
+                }
+                axis.Previous ^= stream.Read(position, 64 - axis.Leading - axis.Trailing) << axis.Trailing;
+                return Value(axis.Previous);
+            }
+
+            size_t capacity;
+            size_t count;
+            long long first;
+            long long last;
+            long long interval;
+            Axis axes[3];
+            BitStream stream;
+            BlockSummary summary;
+        };
+
+        /// <summary>
+        /// The readings of the last Retention, in 100ns units, compressed in chunks of
+        /// ChunkReadings.  Append takes the lock for a few bit writes, and Query copies the
+        /// chunks it needs under the lock and decodes them after releasing it, so the history
+        /// can be filled on the sensor thread and inspected from any other.  Readings must
+        /// arrive in timestamp order; Append drops one that is older than the previous.  The
+        /// sealed chunks are indexed by a TraceIndex, so aggregate queries only decode the
+        /// chunks that their summaries cannot answer, also after releasing the lock.
+        /// </summary>
+        class CompressedHistory
+        {
+        public:
+            CompressedHistory(long long retention, size_t chunkReadings) :
+                retention(retention),
+                chunkReadings(chunkReadings),
+                samples(0),
+                dropped(0),
+                sealedBytes(0)
+            {
+            }
+
+            bool Append(const SensorSample& sample)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (open != nullptr && sample.Timestamp < open->Last())
+                {
+                    ++dropped;
+                    return false;
+                }
+                if (open == nullptr)
+                {
+                    if (!sealed.empty() && sample.Timestamp < sealed.back()->Last())
+                    {
+                        ++dropped;
+                        return false;
+                    }
+                    open = std::make_shared<HistoryChunk>(chunkReadings);
+                }
+                open->Append(sample);
+                ++samples;
+                if (open->Full())
+                {
+                    open->Seal();
+                    sealedBytes += open->Bytes();
+                    index.Add(open->Summary());
+                    sealed.push_back(open);
+                    open.reset();
+                }
+
+                // forget the chunks that ended before the retention
+                while (!sealed.empty() && sealed.front()->Last() < sample.Timestamp - retention)
+                {
+                    samples -= sealed.front()->Count();
+                    sealedBytes -= sealed.front()->Bytes();
+                    sealed.pop_front();
+                    index.DropFront();
+                }
+                return true;
+            }
+
+            /// <summary>
+            /// Calls visit(const SensorSample&amp;) for each reading from begin to end inclusive, in
+            /// order, and returns how many there were.
+            /// </summary>
+            template<class Visit>
+            size_t Query(long long begin, long long end, Visit visit) const
+            {
+                std::vector<std::shared_ptr<const HistoryChunk>> chunks;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    // the chunks are in time order, find the first one that reaches begin
+                    size_t low = 0;
+                    size_t high = sealed.size();
+                    while (low < high)
+                    {
+                        size_t middle = low + (high - low) / 2;
+                        if (sealed[middle]->Last() < begin)
+                        {
+                            low = middle + 1;
+                        }
+                        else
+                        {
+                            high = middle;
+                        }
+                    }
+                    for (size_t i = low; i < sealed.size() && sealed[i]->First() <= end; ++i)
+                    {
+                        chunks.push_back(sealed[i]);
+                    }
+                    if (open != nullptr && open->Last() >= begin && open->First() <= end)
+                    {
+                        // the open chunk keeps growing, decode a copy
+                        chunks.push_back(std::make_shared<HistoryChunk>(*open));
+                    }
+                }
+
+                size_t visited = 0;
+                for (auto& chunk : chunks)
+                {
+                    chunk->Decode(begin, end, [&](const SensorSample& sample)
+                    {
+                        ++visited;
+                        visit(sample);
+                    });
+                }
+                return visited;
+            }
+
+            /// <summary>
+            /// Finds the largest magnitude of the readings from begin to end inclusive.  Returns
+            /// false when there are none.
+            /// </summary>
+            bool MaximumMagnitude(long long begin, long long end, double& maximum) const
+            {
+                // the summaries are read under the lock, and the chunks at the edges of the range
+                // are copied out, as Query does, to be decoded after releasing it
+                std::vector<std::shared_ptr<const HistoryChunk>> edges;
+                bool found;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    found = index.MaximumMagnitude(begin, end,
+                        [&](unsigned long long number, const std::function<void(const SensorSample&)>&)
+                        {
+                            edges.push_back(sealed[static_cast<size_t>(number - index.FirstBlock())]);
+                        },
+                        maximum);
+                    if (open != nullptr && open->Last() >= begin && open->First() <= end)
+                    {
+                        // the open chunk keeps growing, decode a copy
+                        edges.push_back(std::make_shared<HistoryChunk>(*open));
+                    }
+                }
+
+                for (auto& chunk : edges)
+                {
+                    if (found && chunk->Summary().MaximumMagnitude <= maximum)
+                    {
+                        continue;
+                    }
+                    chunk->Decode(begin, end, [&](const SensorSample& sample)
+                    {
+                        double magnitude = std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+                        if (!found || magnitude > maximum)
+                        {
+                            maximum = magnitude;
+                            found = true;
+                        }
+                    });
+                }
+                return found;
+            }
+
+            /// <summary>
+            /// Calls visit(const BlockSummary&amp;) for each sealed chunk whose RMS magnitude is
+            /// above rms, in order, and returns how many there were.
+            /// </summary>
+            template<class Visit>
+            size_t ChunksAbove(double rms, Visit visit) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return index.BlocksAbove(rms, [&](unsigned long long, const BlockSummary& summary)
+                {
+                    visit(summary);
+                });
+            }
+
+            size_t Samples() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return samples;
+            }
+
+            /// <summary>
+            /// The timestamps of the oldest and newest readings kept.  Returns false when there
+            /// are none.
+            /// </summary>
+            bool Span(long long& oldest, long long& newest) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (sealed.empty() && open == nullptr)
+                {
+                    return false;
+                }
+                oldest = !sealed.empty() ? sealed.front()->First() : open->First();
+                newest = open != nullptr ? open->Last() : sealed.back()->Last();
+                return true;
+            }
+
+            size_t Bytes() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return sealedBytes + (open != nullptr ? open->Bytes() : 0);
+            }
+
+            std::wstring Report(const std::wstring& name) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                size_t bytes = sealedBytes + (open != nullptr ? open->Bytes() : 0);
+                std::wostringstream out;
+                out << name
+                    << L": readings=" << samples
+                    << L" chunks=" << sealed.size() + (open != nullptr ? 1 : 0)
+                    << L" bytes=" << bytes
+                    << L" bytes/reading=" << (samples != 0 ? static_cast<double>(bytes) / samples : 0.0)
+                    << L" dropped=" << dropped
+                    << L"\n";
+                return out.str();
+            }
+
+        private:
+            CompressedHistory(const CompressedHistory&);
+            CompressedHistory& operator=(const CompressedHistory&);
+
+            long long retention;
+            size_t chunkReadings;
+            mutable std::mutex lock;
+            std::deque<std::shared_ptr<HistoryChunk>> sealed;
+            std::shared_ptr<HistoryChunk> open;
+            TraceIndex index;
+            size_t samples;
+            unsigned long long dropped;
+            size_t sealedBytes;
+        };
+    }
+}
@@ -0,0 +1,50 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// DebugOutput.h
+// The flag that turns the diagnostic reports of the app on, and the DebugOutput function
+//
+
+#pragma once
+
+#include <string>
+
+// Reports of the pipeline metrics, queues, status messages, scenario switches and startup
+// phases go to the debugger output in debug builds.  Define SDKSAMPLE_DEBUG_OUTPUT as 0 or 1
+// to override that.
+#if !defined(SDKSAMPLE_DEBUG_OUTPUT)
+#if defined(_DEBUG)
+#define SDKSAMPLE_DEBUG_OUTPUT 1
+#else
+#define SDKSAMPLE_DEBUG_OUTPUT 0
+#endif
+#endif
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Writes the text report() returns to the debugger output when SDKSAMPLE_DEBUG_OUTPUT
+        /// is set.  report is not called otherwise, so a report costs nothing in a release
+        /// build.  An empty text is not written.
+        /// </summary>
+        template<class Report>
+        void DebugOutput(Report report)
+        {
+#if SDKSAMPLE_DEBUG_OUTPUT
+            std::wstring text = report();
+            if (!text.empty())
+            {
+                OutputDebugStringW(text.c_str());
+            }
+#else
+            (void) report;
+#endif
+        }
+    }
+}
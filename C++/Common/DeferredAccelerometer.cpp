@@ -0,0 +1,64 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// DeferredAccelerometer.cpp
+// Implementation of the DeferredAccelerometer class
+//
+
+#include "pch.h"
+#include "DeferredAccelerometer.h"
+#include "StartupTrace.h"
+#include "DebugOutput.h"
+
+#include <atomic>
+#include <mutex>
+
+using namespace SDKSample::Common;
+
+using namespace Windows::Devices::Sensors;
+
+namespace
+{
+    // GetDefault runs once; a caller that arrives while it runs waits for it, and later
+    // callers only read the flag
+    std::once_flag acquired;
+    std::atomic<bool> prefetching(false);
+    Accelerometer^ accelerometer = nullptr;
+}
+
+void DeferredAccelerometer::Prefetch()
+{
+    if (prefetching.exchange(true))
+    {
+        return;
+    }
+
+    concurrency::create_task([]()
+    {
+        // background thread
+        auto sensor = Get();
+        if (sensor != nullptr)
+        {
+            // the first read of a capability goes to the driver as well
+            (void) sensor->MinimumReportInterval;
+        }
+        StartupTrace::Mark(L"accelerometer prefetched");
+        DebugOutput([]()
+        {
+            return StartupTrace::Report();
+        });
+    });
+}
+
+Accelerometer^ DeferredAccelerometer::Get()
+{
+    std::call_once(acquired, []()
+    {
+        accelerometer = Accelerometer::GetDefault();
+    });
+    return accelerometer;
+}
@@ -0,0 +1,39 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// DeferredAccelerometer.h
+// Declaration of the DeferredAccelerometer class
+//
+
+#pragma once
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// The default accelerometer, acquired the first time a scenario needs it instead of when
+        /// a scenario page is constructed.  Prefetch acquires it on a background thread, so that
+        /// the first enable does not wait for the sensor stack either.
+        /// </summary>
+        class DeferredAccelerometer
+        {
+        public:
+            /// <summary>
+            /// Starts acquiring the accelerometer on a background thread, once, and writes the
+            /// startup trace to the DebugOutput when it is done.
+            /// </summary>
+            static void Prefetch();
+
+            /// <summary>
+            /// Returns the accelerometer, or nullptr when there is none.  Waits for a prefetch
+            /// that is in progress.  Safe to call from any thread.
+            /// </summary>
+            static Windows::Devices::Sensors::Accelerometer^ Get();
+        };
+    }
+}
@@ -0,0 +1,416 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// EventTimeWindows.h
+// Declaration of the EventTimeWindows and SessionWindows classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Window aggregate that keeps the count, the sums of each axis and the largest
+        /// magnitude.
+        /// </summary>
+        struct ReadingSummary
+        {
+            size_t Count;
+            double Sum[3];
+            double MaximumMagnitude;
+
+            void Reset()
+            {
+                Count = 0;
+                Sum[0] = Sum[1] = Sum[2] = 0.0;
+                MaximumMagnitude = 0.0;
+            }
+
+            void Add(const SensorSample& sample)
+            {
+                ++Count;
+                Sum[0] += sample.X;
+                Sum[1] += sample.Y;
+                Sum[2] += sample.Z;
+                double magnitude = std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+                MaximumMagnitude = (std::max)(MaximumMagnitude, magnitude);
+            }
+
+            void Merge(const ReadingSummary& other)
+            {
+                Count += other.Count;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    Sum[axis] += other.Sum[axis];
+                }
+                MaximumMagnitude = (std::max)(MaximumMagnitude, other.MaximumMagnitude);
+            }
+
+            double Mean(int axis) const
+            {
+                return Count != 0 ? Sum[axis] / Count : 0.0;
+            }
+        };
+
+        /// <summary>
+        /// Window aggregate that keeps the readings themselves, in timestamp order once Sort
+        /// has been called.  The storage is reused from window to window.
+        /// </summary>
+        struct ReadingCollector
+        {
+            std::vector<SensorSample> Readings;
+
+            void Reset()
+            {
+                Readings.clear();
+            }
+
+            void Add(const SensorSample& sample)
+            {
+                Readings.push_back(sample);
+            }
+
+            void Merge(const ReadingCollector& other)
+            {
+                Readings.insert(Readings.end(), other.Readings.begin(), other.Readings.end());
+            }
+
+            void Sort()
+            {
+                std::stable_sort(Readings.begin(), Readings.end(), [](const SensorSample& a, const SensorSample& b)
+                {
+                    return a.Timestamp < b.Timestamp;
+                });
+            }
+        };
+
+        /// <summary>
+        /// Tumbling or sliding windows over the reading timestamps rather than the order the
+        /// readings arrive in.  Window k covers [k * Slide, k * Slide + Size) in 100ns units.
+        /// The watermark trails the latest timestamp seen by the allowed lateness, and a window
+        /// is emitted once the watermark passes its end, so readings that arrive up to lateness
+        /// late still land in their windows; readings whose windows were all emitted are counted
+        /// in Late and dropped.  The open windows live in a ring indexed by k, sized from Size,
+        /// Slide and lateness when the object is constructed.  Aggregate needs Reset() and
+        /// Add(const SensorSample&amp;), e.g. ReadingSummary or ReadingCollector.
+        /// </summary>
+        template<class Aggregate>
+        class EventTimeWindows
+        {
+        public:
+            /// <summary>
+            /// Tumbling windows when slide equals size.
+            /// </summary>
+            EventTimeWindows(long long size, long long slide, long long lateness, const Aggregate& prototype = Aggregate()) :
+                size(size),
+                slide(slide),
+                lateness(lateness)
+            {
+                Slot empty = {(std::numeric_limits<long long>::min)(), prototype};
+                empty.Value.Reset();
+                ring.assign(static_cast<size_t>((size + lateness) / slide + 2), empty);
+                Reset();
+            }
+
+            void Reset()
+            {
+                started = false;
+                late = 0;
+                for (auto& slot : ring)
+                {
+                    if (slot.Index != (std::numeric_limits<long long>::min)())
+                    {
+                        slot.Index = (std::numeric_limits<long long>::min)();
+                        slot.Value.Reset();
+                    }
+                }
+            }
+
+            long long Watermark() const
+            {
+                return started ? latest - lateness : (std::numeric_limits<long long>::min)();
+            }
+
+            unsigned long long Late() const
+            {
+                return late;
+            }
+
+            /// <summary>
+            /// Adds a reading and calls emit(start, end, Aggregate&amp;) for each window that the
+            /// watermark closed, in window order.  Windows without readings are not emitted.
+            /// </summary>
+            template<class Emit>
+            void Push(const SensorSample& sample, Emit emit)
+            {
+                long long t = sample.Timestamp;
+                long long first = FloorDivide(t - size, slide) + 1;
+                long long last = FloorDivide(t, slide);
+
+                if (!started)
+                {
+                    started = true;
+                    latest = t;
+                    // readings up to lateness before the first one still have open windows
+                    firstOpen = FloorDivide(t - lateness - size, slide) + 1;
+                    lastOpen = firstOpen - 1;
+                }
+                else if (t > latest)
+                {
+                    latest = t;
+                    Advance(emit);
+                }
+
+                if (last < firstOpen)
+                {
+                    ++late;
+                    return;
+                }
+                for (long long k = (std::max)(first, firstOpen); k <= last; ++k)
+                {
+                    Slot& slot = ring[Position(k)];
+                    if (slot.Index != k)
+                    {
+                        slot.Index = k;
+                        slot.Value.Reset();
+                    }
+                    slot.Value.Add(sample);
+                }
+                lastOpen = (std::max)(lastOpen, last);
+            }
+
+            /// <summary>
+            /// Emits every open window, e.g. when the stream ends.
+            /// </summary>
+            template<class Emit>
+            void Flush(Emit emit)
+            {
+                if (!started)
+                {
+                    return;
+                }
+                for (; firstOpen <= lastOpen; ++firstOpen)
+                {
+                    Close(firstOpen, emit);
+                }
+            }
+
+        private:
+            struct Slot
+            {
+                long long Index;
+                Aggregate Value;
+            };
+
+            static long long FloorDivide(long long value, long long divisor)
+            {
+                long long quotient = value / divisor;
+                return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+            }
+
+            size_t Position(long long k) const
+            {
+                long long count = static_cast<long long>(ring.size());
+                return static_cast<size_t>(((k % count) + count) % count);
+            }
+
+            template<class Emit>
+            void Advance(Emit& emit)
+            {
+                // the first window that still ends after the watermark
+                long long needed = FloorDivide(latest - lateness - size, slide) + 1;
+                for (; firstOpen < needed && firstOpen <= lastOpen; ++firstOpen)
+                {
+                    Close(firstOpen, emit);
+                }
+                // windows past lastOpen never had readings
+                firstOpen = (std::max)(firstOpen, needed);
+            }
+
+            template<class Emit>
+            void Close(long long k, Emit& emit)
+            {
+                Slot& slot = ring[Position(k)];
+                if (slot.Index == k)
+                {
+                    emit(k * slide, k * slide + size, slot.Value);
+                    slot.Index = (std::numeric_limits<long long>::min)();
+                    slot.Value.Reset();
+                }
+            }
+
+            long long size;
+            long long slide;
+            long long lateness;
+            std::vector<Slot> ring;
+            bool started;
+            long long latest;
+            long long firstOpen;
+            long long lastOpen;
+            unsigned long long late;
+        };
+
+        /// <summary>
+        /// Session windows over the reading timestamps: readings less than gap apart belong to
+        /// the same session, and a late reading can join or merge sessions until the watermark,
+        /// which trails the latest timestamp by the allowed lateness, passes the session end by
+        /// gap.  The open sessions are kept in start order in storage that is reused.  Aggregate
+        /// needs Merge(const Aggregate&amp;) as well.
+        /// </summary>
+        template<class Aggregate>
+        class SessionWindows
+        {
+        public:
+            SessionWindows(long long gap, long long lateness, const Aggregate& prototype = Aggregate()) :
+                gap(gap),
+                lateness(lateness),
+                prototype(prototype)
+            {
+                this->prototype.Reset();
+                Reset();
+            }
+
+            void Reset()
+            {
+                started = false;
+                late = 0;
+                open = 0;
+            }
+
+            long long Watermark() const
+            {
+                return started ? latest - lateness : (std::numeric_limits<long long>::min)();
+            }
+
+            unsigned long long Late() const
+            {
+                return late;
+            }
+
+            /// <summary>
+            /// Adds a reading and calls emit(start, end, Aggregate&amp;) for each session that the
+            /// watermark closed, in start order.  end is one past the last reading.
+            /// </summary>
+            template<class Emit>
+            void Push(const SensorSample& sample, Emit emit)
+            {
+                long long t = sample.Timestamp;
+                if (!started || t > latest)
+                {
+                    started = true;
+                    latest = t;
+                    Advance(emit);
+                }
+                if (t + gap <= Watermark())
+                {
+                    ++late;
+                    return;
+                }
+
+                // the sessions that the reading touches are adjacent in start order
+                size_t first = 0;
+                while (first < open && sessions[first].End - 1 + gap <= t)
+                {
+                    ++first;
+                }
+                size_t last = first;
+                while (last < open && sessions[last].Start - gap < t)
+                {
+                    ++last;
+                }
+
+                if (first == last)
+                {
+                    // a new session at first
+                    if (open == sessions.size())
+                    {
+                        Session empty = {0, 0, prototype};
+                        sessions.push_back(empty);
+                    }
+                    std::rotate(sessions.begin() + first, sessions.begin() + open, sessions.begin() + open + 1);
+                    ++open;
+                    Session& session = sessions[first];
+                    session.Start = t;
+                    session.End = t + 1;
+                    session.Value.Reset();
+                    session.Value.Add(sample);
+                    return;
+                }
+
+                // join the first session and merge the rest into it
+                Session& session = sessions[first];
+                session.Start = (std::min)(session.Start, t);
+                session.End = (std::max)(session.End, t + 1);
+                session.Value.Add(sample);
+                for (size_t i = first + 1; i < last; ++i)
+                {
+                    session.Start = (std::min)(session.Start, sessions[i].Start);
+                    session.End = (std::max)(session.End, sessions[i].End);
+                    session.Value.Merge(sessions[i].Value);
+                }
+                Remove(first + 1, last);
+            }
+
+            template<class Emit>
+            void Flush(Emit emit)
+            {
+                for (size_t i = 0; i < open; ++i)
+                {
+                    emit(sessions[i].Start, sessions[i].End, sessions[i].Value);
+                }
+                open = 0;
+            }
+
+        private:
+            struct Session
+            {
+                long long Start;
+                long long End;
+                Aggregate Value;
+            };
+
+            template<class Emit>
+            void Advance(Emit& emit)
+            {
+                size_t closed = 0;
+                while (closed < open && sessions[closed].End - 1 + gap <= Watermark())
+                {
+                    emit(sessions[closed].Start, sessions[closed].End, sessions[closed].Value);
+                    ++closed;
+                }
+                Remove(0, closed);
+            }
+
+            /// <summary>
+            /// Moves the open sessions [first, last) behind the open ones, keeping their storage.
+            /// </summary>
+            void Remove(size_t first, size_t last)
+            {
+                std::rotate(sessions.begin() + first, sessions.begin() + last, sessions.begin() + open);
+                open -= last - first;
+            }
+
+            long long gap;
+            long long lateness;
+            Aggregate prototype;
+            std::vector<Session> sessions;
+            size_t open;
+            bool started;
+            long long latest;
+            unsigned long long late;
+        };
+    }
+}
@@ -0,0 +1,258 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// FixedPoint.h
+// Fixed-point kernels for readings, and the FixedSlidingStatistics and FixedSensorStatistics classes
+//
+// Only the rolling statistics of the shown readings are fixed-point: ReadingStatistics is
+// FixedSensorStatistics in the SDKSAMPLE_FIXED_POINT build.  Calibration, resampling, the
+// activity windows and the history stay in double in every build.
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "WindowedStatistics.h"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Readings as Q15 fractions of FullScale g, so the per-reading work is integer
+        /// arithmetic.  Accuracy against the double path, for readings within FullScale:
+        /// - an axis is off by at most half a step, FullScale / 65536 = 0.00025 g;
+        /// - a magnitude is off by at most 0.0005 g from quantization plus one step,
+        ///   0.0005 g, from truncating the square root, so 0.001 g in all;
+        /// - the sliding sums are exact, so means, minimums and maximums stay within the same
+        ///   bounds and do not drift.
+        /// Readings beyond FullScale are clamped.
+        /// </summary>
+        namespace FixedPoint
+        {
+            // g at the full scale of Q15
+            inline double FullScale()
+            {
+                return 16.0;
+            }
+
+            inline int16_t ToQ15(double value)
+            {
+                double scaled = value * (32768.0 / FullScale());
+                scaled += scaled < 0.0 ? -0.5 : 0.5;
+                if (scaled >= 32767.0)
+                {
+                    return 32767;
+                }
+                if (scaled <= -32768.0)
+                {
+                    return -32768;
+                }
+                return static_cast<int16_t>(scaled);
+            }
+
+            inline double FromQ15(double value)
+            {
+                return value * (FullScale() / 32768.0);
+            }
+
+            /// <summary>
+            /// floor(sqrt(value)).  The single precision square root, which the FPU does in a
+            /// few cycles, is within one of the result and is corrected with integer compares.
+            /// </summary>
+            inline uint32_t SquareRoot(uint32_t value)
+            {
+                uint32_t root = static_cast<uint32_t>(std::sqrt(static_cast<float>(value)));
+                while (static_cast<uint64_t>(root) * root > value)
+                {
+                    --root;
+                }
+                while (static_cast<uint64_t>(root + 1) * (root + 1) <= value)
+                {
+                    ++root;
+                }
+                return root;
+            }
+
+            /// <summary>
+            /// The magnitude of a Q15 reading, in Q15.  The sum of squares is Q30 and at most
+            /// 3 * 2^30, which fits in 32 unsigned bits.
+            /// </summary>
+            inline uint32_t Magnitude(int16_t x, int16_t y, int16_t z)
+            {
+                uint32_t squares =
+                    static_cast<uint32_t>(static_cast<int32_t>(x) * x) +
+                    static_cast<uint32_t>(static_cast<int32_t>(y) * y) +
+                    static_cast<uint32_t>(static_cast<int32_t>(z) * z);
+                return SquareRoot(squares);
+            }
+        }
+
+        /// <summary>
+        /// SlidingStatistics over Q15 values.  The window sums are kept as exact 64-bit integers
+        /// and only turned into doubles by Current, and the minimum and maximum come from the
+        /// same monotonic deques as in SlidingStatistics, so both Push and Current are O(1)
+        /// amortized integer work.
+        /// </summary>
+        class FixedSlidingStatistics
+        {
+        public:
+            /// <summary>
+            /// window is the number of values summarized, at least 1.
+            /// </summary>
+            explicit FixedSlidingStatistics(size_t window) :
+                window(window),
+                values(window),
+                extremes(window)
+            {
+                if (window == 0)
+                {
+                    throw std::invalid_argument("FixedSlidingStatistics: the window is empty");
+                }
+                Reset();
+            }
+
+            void Reset()
+            {
+                count = 0;
+                next = 0;
+                sum = 0;
+                sumOfSquares = 0;
+                extremes.Reset();
+            }
+
+            size_t Window() const
+            {
+                return window;
+            }
+
+            void Push(int32_t value)
+            {
+                int32_t& slot = values[next];
+                if (count < window)
+                {
+                    ++count;
+                }
+                else
+                {
+                    sum -= slot;
+                    sumOfSquares -= static_cast<int64_t>(slot) * slot;
+                }
+                slot = value;
+                sum += value;
+                sumOfSquares += static_cast<int64_t>(value) * value;
+                extremes.Push(value);
+                next = next + 1 == window ? 0 : next + 1;
+            }
+
+            /// <summary>
+            /// The statistics in g.
+            /// </summary>
+            Statistics Current() const
+            {
+                Statistics statistics = {count, 0.0, 0.0, 0.0, 0.0, 0.0};
+                if (count == 0)
+                {
+                    return statistics;
+                }
+                double n = static_cast<double>(count);
+                double mean = sum / n;
+                double meanOfSquares = sumOfSquares / n;
+                double variance = meanOfSquares - mean * mean;
+                statistics.Mean = FixedPoint::FromQ15(mean);
+                statistics.Variance = FixedPoint::FromQ15(FixedPoint::FromQ15(variance > 0.0 ? variance : 0.0));
+                statistics.Rms = FixedPoint::FromQ15(std::sqrt(meanOfSquares));
+                statistics.Minimum = FixedPoint::FromQ15(extremes.Minimum());
+                statistics.Maximum = FixedPoint::FromQ15(extremes.Maximum());
+                return statistics;
+            }
+
+        private:
+            size_t window;
+            std::vector<int32_t> values;
+            size_t count;
+            size_t next;
+            int64_t sum;
+            int64_t sumOfSquares;
+            SlidingExtremes<int32_t> extremes;
+        };
+
+        /// <summary>
+        /// SensorStatistics that quantizes each reading to Q15 and runs FixedSlidingStatistics
+        /// over each axis and the fixed-point magnitude.
+        /// </summary>
+        class FixedSensorStatistics
+        {
+        public:
+            explicit FixedSensorStatistics(size_t window) :
+                x(window),
+                y(window),
+                z(window),
+                magnitude(window)
+            {
+            }
+
+            void Reset()
+            {
+                x.Reset();
+                y.Reset();
+                z.Reset();
+                magnitude.Reset();
+            }
+
+            void Push(const SensorSample& sample)
+            {
+                int16_t qx = FixedPoint::ToQ15(sample.X);
+                int16_t qy = FixedPoint::ToQ15(sample.Y);
+                int16_t qz = FixedPoint::ToQ15(sample.Z);
+                x.Push(qx);
+                y.Push(qy);
+                z.Push(qz);
+                magnitude.Push(static_cast<int32_t>(FixedPoint::Magnitude(qx, qy, qz)));
+            }
+
+            Statistics X() const
+            {
+                return x.Current();
+            }
+
+            Statistics Y() const
+            {
+                return y.Current();
+            }
+
+            Statistics Z() const
+            {
+                return z.Current();
+            }
+
+            Statistics Magnitude() const
+            {
+                return magnitude.Current();
+            }
+
+        private:
+            FixedSlidingStatistics x;
+            FixedSlidingStatistics y;
+            FixedSlidingStatistics z;
+            FixedSlidingStatistics magnitude;
+        };
+
+        // the statistics behind the readings shown by the scenarios, fixed-point where the
+        // SDKSAMPLE_FIXED_POINT mode is built in (the ARM configurations)
+#if defined(SDKSAMPLE_FIXED_POINT)
+        typedef FixedSensorStatistics ReadingStatistics;
+#else
+        typedef SensorStatistics<SlidingStatistics> ReadingStatistics;
+#endif
+    }
+}
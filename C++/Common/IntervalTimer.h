@@ -0,0 +1,95 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// IntervalTimer.h
+// Declaration of the IntervalTimer class
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Calls tick with 0, 1, 2, ... every period until it is cancelled.  Each tick is
+        /// scheduled one period after the previous one ran, as a DispatcherTimer does, through a
+        /// scheduler like the one BoundedQueue takes: DispatcherScheduler in the app and
+        /// VirtualTimeScheduler::Scheduler in tests, so the ticks of a long session can be
+        /// replayed without waiting for them.  Create it with Start.
+        /// </summary>
+        class IntervalTimer : public std::enable_shared_from_this<IntervalTimer>
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+            typedef std::function<void()> Work;
+            typedef std::function<void(clock::duration, Work)> Scheduler;
+            typedef std::function<void(size_t)> Tick;
+
+            static std::shared_ptr<IntervalTimer> Start(Scheduler scheduler, clock::duration period, Tick tick)
+            {
+                std::shared_ptr<IntervalTimer> timer(new IntervalTimer(std::move(scheduler), period, std::move(tick)));
+                timer->ScheduleNext();
+                return timer;
+            }
+
+            /// <summary>
+            /// No tick starts after this returns; the one that is scheduled runs as a no-op.
+            /// </summary>
+            void Cancel()
+            {
+                cancelled = true;
+            }
+
+            size_t Ticks() const
+            {
+                return count;
+            }
+
+        private:
+            IntervalTimer(Scheduler scheduler, clock::duration period, Tick tick) :
+                scheduler(std::move(scheduler)),
+                period(period),
+                tick(std::move(tick)),
+                cancelled(false),
+                count(0)
+            {
+            }
+
+            IntervalTimer(const IntervalTimer&);
+            IntervalTimer& operator=(const IntervalTimer&);
+
+            void ScheduleNext()
+            {
+                auto self = shared_from_this();
+                scheduler(period, [self]()
+                {
+                    if (self->cancelled)
+                    {
+                        return;
+                    }
+                    self->tick(self->count++);
+                    if (!self->cancelled)
+                    {
+                        self->ScheduleNext();
+                    }
+                });
+            }
+
+            Scheduler scheduler;
+            clock::duration period;
+            Tick tick;
+            std::atomic<bool> cancelled;
+            std::atomic<size_t> count;
+        };
+    }
+}
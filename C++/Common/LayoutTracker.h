@@ -0,0 +1,95 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// LayoutTracker.h
+// Declaration of the LayoutTracker class
+//
+
+#pragma once
+
+#include <cmath>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// The layouts of the main page, split at the same width as
+        /// LayoutAwarePage::DetermineVisualState.
+        /// </summary>
+        enum class LayoutBucket
+        {
+            Unknown,
+            Below768,
+            Default
+        };
+
+        /// <summary>
+        /// Decides how much of the main page layout a size change needs.  Size events are
+        /// coalesced: Schedule returns true only for the first event since the last Update, so
+        /// one update handles a whole burst with the latest width.  Update then reports whether
+        /// the width and the layout bucket changed since the layout was last applied, so that
+        /// rows, columns and visual states are only touched when the bucket changes.
+        /// </summary>
+        class LayoutTracker
+        {
+        public:
+            struct Changes
+            {
+                bool Width;
+                bool Bucket;
+            };
+
+            static LayoutBucket BucketFor(double width)
+            {
+                return width < 768 ? LayoutBucket::Below768 : LayoutBucket::Default;
+            }
+
+            LayoutTracker() : pending(false), width(-1.0), bucket(LayoutBucket::Unknown)
+            {
+            }
+
+            /// <summary>
+            /// Call for each size event.  Returns true when an update has to be scheduled.
+            /// </summary>
+            bool Schedule()
+            {
+                if (pending)
+                {
+                    return false;
+                }
+                pending = true;
+                return true;
+            }
+
+            /// <summary>
+            /// Call from the scheduled update with the current width.
+            /// </summary>
+            Changes Update(double current)
+            {
+                pending = false;
+                Changes changes = {std::fabs(current - width) >= 0.5, BucketFor(current) != bucket};
+                Applied(current);
+                return changes;
+            }
+
+            /// <summary>
+            /// Records a full layout that was applied outside of Update, e.g. for a new scenario.
+            /// </summary>
+            void Applied(double current)
+            {
+                width = current;
+                bucket = BucketFor(current);
+            }
+
+        private:
+            bool pending;
+            double width;
+            LayoutBucket bucket;
+        };
+    }
+}
@@ -0,0 +1,124 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// LruCache.h
+// Declaration of the LruCache class
+//
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Holds up to Capacity values by key and evicts the least recently used one to make
+        /// room.  Evicted values are handed to a callback so that the owner can release them.
+        /// </summary>
+        template<class Key, class Value>
+        class LruCache
+        {
+        public:
+            explicit LruCache(size_t capacity) : capacity(capacity)
+            {
+            }
+
+            size_t Capacity() const
+            {
+                return capacity;
+            }
+
+            size_t Size() const
+            {
+                return index.size();
+            }
+
+            /// <summary>
+            /// Changes the capacity, calling evict(const Key&amp;, Value&amp;) for each value that
+            /// no longer fits.
+            /// </summary>
+            template<class Evict>
+            void SetCapacity(size_t value, Evict evict)
+            {
+                capacity = value;
+                Trim(evict);
+            }
+
+            /// <summary>
+            /// Returns the value and marks it most recently used, or nullptr.
+            /// </summary>
+            Value* Find(const Key& key)
+            {
+                auto found = index.find(key);
+                if (found == index.end())
+                {
+                    return nullptr;
+                }
+                entries.splice(entries.begin(), entries, found->second);
+                return &found->second->second;
+            }
+
+            /// <summary>
+            /// Adds or replaces the value as the most recently used one, calling
+            /// evict(const Key&amp;, Value&amp;) for each value that no longer fits.  A replaced value
+            /// is not passed to evict.
+            /// </summary>
+            template<class Evict>
+            void Insert(const Key& key, const Value& value, Evict evict)
+            {
+                auto found = index.find(key);
+                if (found != index.end())
+                {
+                    found->second->second = value;
+                    entries.splice(entries.begin(), entries, found->second);
+                }
+                else
+                {
+                    entries.push_front(std::make_pair(key, value));
+                    index[key] = entries.begin();
+                }
+                Trim(evict);
+            }
+
+            bool Remove(const Key& key)
+            {
+                auto found = index.find(key);
+                if (found == index.end())
+                {
+                    return false;
+                }
+                entries.erase(found->second);
+                index.erase(found);
+                return true;
+            }
+
+        private:
+            typedef std::list<std::pair<Key, Value>> Entries;
+
+            template<class Evict>
+            void Trim(Evict& evict)
+            {
+                while (index.size() > capacity)
+                {
+                    auto& last = entries.back();
+                    evict(last.first, last.second);
+                    index.erase(last.first);
+                    entries.pop_back();
+                }
+            }
+
+            size_t capacity;
+            Entries entries;
+            std::map<Key, typename Entries::iterator> index;
+        };
+    }
+}
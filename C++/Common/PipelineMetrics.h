@@ -0,0 +1,251 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// PipelineMetrics.h
+// Declaration of the LatencyHistogram and PipelineMetrics classes
+//
+
+#pragma once
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Fixed size log-linear histogram of durations in nanoseconds.  Each power of two is
+        /// split into 16 buckets so percentiles are reported within ~6% of the recorded value.
+        /// Recording never allocates.
+        /// </summary>
+        class LatencyHistogram
+        {
+        public:
+            LatencyHistogram()
+            {
+                Reset();
+            }
+
+            void Reset()
+            {
+                std::fill(counts, counts + BucketCount, 0u);
+                count = 0;
+                maximum = 0;
+            }
+
+            void Record(std::chrono::nanoseconds duration)
+            {
+                auto value = duration.count() > 0 ? static_cast<unsigned long long>(duration.count()) : 0ull;
+                ++counts[BucketIndex(value)];
+                ++count;
+                maximum = (std::max)(maximum, value);
+            }
+
+            unsigned long long Count() const
+            {
+                return count;
+            }
+
+            std::chrono::nanoseconds Maximum() const
+            {
+                return std::chrono::nanoseconds(static_cast<long long>(maximum));
+            }
+
+            /// <summary>
+            /// Returns the upper bound of the bucket that holds the given fraction of the
+            /// recorded values, e.g. 0.99 for p99.
+            /// </summary>
+            std::chrono::nanoseconds Percentile(double fraction) const
+            {
+                if (count == 0)
+                {
+                    return std::chrono::nanoseconds(0);
+                }
+                auto target = static_cast<unsigned long long>(std::ceil(fraction * static_cast<double>(count)));
+                target = (std::max)(target, 1ull);
+                unsigned long long seen = 0;
+                for (size_t i = 0; i < BucketCount; ++i)
+                {
+                    seen += counts[i];
+                    if (seen >= target)
+                    {
+                        return std::chrono::nanoseconds(static_cast<long long>((std::min)(BucketUpper(i), maximum)));
+                    }
+                }
+                return Maximum();
+            }
+
+        private:
+            static const size_t SubBuckets = 16;
+            static const size_t BucketCount = 64 * SubBuckets;
+
+            static size_t BucketIndex(unsigned long long value)
+            {
+                if (value < SubBuckets)
+                {
+                    return static_cast<size_t>(value);
+                }
+                size_t exponent = 0;
+                while (value >= SubBuckets * 2)
+                {
+                    value >>= 1;
+                    ++exponent;
+                }
+                return (exponent + 1) * SubBuckets + static_cast<size_t>(value - SubBuckets);
+            }
+
+            static unsigned long long BucketUpper(size_t index)
+            {
+                if (index < SubBuckets)
+                {
+                    return index;
+                }
+                auto exponent = index / SubBuckets - 1;
+                auto sub = index % SubBuckets;
+                return ((SubBuckets + sub + 1ull) << exponent) - 1;
+            }
+
+            unsigned int counts[BucketCount];
+            unsigned long long count;
+            unsigned long long maximum;
+        };
+
+        /// <summary>
+        /// Collects throughput, end-to-end latency and allocations per sample for one scenario
+        /// pipeline.  Latency is measured from the moment a sample entered the pipeline to the
+        /// moment it was consumed.  Allocations are taken from the AllocationCounter, so they
+        /// include everything the app allocated while the samples were flowing.  Not
+        /// thread-safe; record from the thread that consumes the samples.
+        /// </summary>
+        class PipelineMetrics
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+
+            PipelineMetrics() : allocationBudget(0.0)
+            {
+                Reset();
+            }
+
+            void Reset()
+            {
+                latency.Reset();
+                first = clock::time_point();
+                last = clock::time_point();
+                allocationsAtReset = AllocationCounter::Snapshot();
+            }
+
+            /// <summary>
+            /// The number of allocations per sample that the pipeline is expected to stay
+            /// within.  Zero means no budget.
+            /// </summary>
+            void SetAllocationBudget(double perSample)
+            {
+                allocationBudget = perSample;
+            }
+
+            void Record(clock::time_point received)
+            {
+                auto now = clock::now();
+                if (latency.Count() == 0)
+                {
+                    first = now;
+                }
+                last = now;
+                latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - received));
+            }
+
+            unsigned long long Samples() const
+            {
+                return latency.Count();
+            }
+
+            const LatencyHistogram& Latency() const
+            {
+                return latency;
+            }
+
+            /// <summary>
+            /// Samples per second between the first and the last recorded sample.
+            /// </summary>
+            double Throughput() const
+            {
+                auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(last - first).count();
+                return seconds > 0.0 ? static_cast<double>(latency.Count() - 1) / seconds : 0.0;
+            }
+
+            /// <summary>
+            /// Allocations per sample since the last reset, for one stage.
+            /// </summary>
+            double AllocationsPerSample(AllocationStage stage) const
+            {
+                auto index = static_cast<int>(stage);
+                return PerSample(AllocationCounter::Snapshot().Counts[index] - allocationsAtReset.Counts[index]);
+            }
+
+            double AllocationsPerSample() const
+            {
+                return PerSample(AllocationCounter::Snapshot().Total() - allocationsAtReset.Total());
+            }
+
+            bool OverAllocationBudget() const
+            {
+                return AllocationCounter::Enabled() && allocationBudget > 0.0 && AllocationsPerSample() > allocationBudget;
+            }
+
+            std::wstring Report(const std::wstring& name) const
+            {
+                std::wostringstream out;
+                out << name
+                    << L": samples=" << latency.Count()
+                    << L" throughput=" << Throughput() << L"/s"
+                    << L" p50=" << Microseconds(latency.Percentile(0.50)) << L"us"
+                    << L" p99=" << Microseconds(latency.Percentile(0.99)) << L"us"
+                    << L" p999=" << Microseconds(latency.Percentile(0.999)) << L"us"
+                    << L" max=" << Microseconds(latency.Maximum()) << L"us";
+                if (AllocationCounter::Enabled())
+                {
+                    out << L" allocs/sample=" << AllocationsPerSample();
+                    for (int i = 0; i < static_cast<int>(AllocationStage::Count); ++i)
+                    {
+                        auto stage = static_cast<AllocationStage>(i);
+                        out << L" " << AllocationCounter::StageName(stage) << L"=" << AllocationsPerSample(stage);
+                    }
+                    if (OverAllocationBudget())
+                    {
+                        out << L" OVER BUDGET (" << allocationBudget << L")";
+                    }
+                }
+                out << L"\n";
+                return out.str();
+            }
+
+        private:
+            static double Microseconds(std::chrono::nanoseconds duration)
+            {
+                return static_cast<double>(duration.count()) / 1000.0;
+            }
+
+            double PerSample(unsigned long long allocations) const
+            {
+                return latency.Count() != 0 ? static_cast<double>(allocations) / static_cast<double>(latency.Count()) : 0.0;
+            }
+
+            LatencyHistogram latency;
+            clock::time_point first;
+            clock::time_point last;
+            AllocationSnapshot allocationsAtReset;
+            double allocationBudget;
+        };
+    }
+}
@@ -0,0 +1,530 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ProcessingGraph.h
+// Declaration of the RingQueue, WorkerPool and ProcessingStage classes
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// A deque in a ring that doubles when it is full and never shrinks, so that a queue
+        /// that has reached its working size is pushed and popped without allocating.
+        /// </summary>
+        template<class T>
+        class RingQueue
+        {
+        public:
+            RingQueue() : items(16), head(0), size(0)
+            {
+            }
+
+            bool Empty() const
+            {
+                return size == 0;
+            }
+
+            size_t Size() const
+            {
+                return size;
+            }
+
+            void PushBack(T value)
+            {
+                if (size == items.size())
+                {
+                    Grow();
+                }
+                items[(head + size) % items.size()] = std::move(value);
+                ++size;
+            }
+
+            bool PopFront(T& value)
+            {
+                if (size == 0)
+                {
+                    return false;
+                }
+                value = std::move(items[head]);
+                items[head] = T();
+                head = (head + 1) % items.size();
+                --size;
+                return true;
+            }
+
+            bool PopBack(T& value)
+            {
+                if (size == 0)
+                {
+                    return false;
+                }
+                size_t last = (head + size - 1) % items.size();
+                value = std::move(items[last]);
+                items[last] = T();
+                --size;
+                return true;
+            }
+
+            void Clear()
+            {
+                T value;
+                while (PopFront(value))
+                {
+                }
+            }
+
+        private:
+            void Grow()
+            {
+                std::vector<T> grown(items.size() * 2);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    grown[i] = std::move(items[(head + i) % items.size()]);
+                }
+                items.swap(grown);
+                head = 0;
+            }
+
+            std::vector<T> items;
+            size_t head;
+            size_t size;
+        };
+
+        /// <summary>
+        /// A fixed set of threads that share posted work by stealing it from each other.  Work
+        /// posted from outside the pool goes to a shared queue and starts in the order it was
+        /// posted.  Work posted by a worker, e.g. the next value of a stage, goes to that
+        /// worker's own queue, which it runs newest first while its data is still in cache;
+        /// idle workers take from the shared queue and then steal the oldest work of the others.
+        /// The queues keep their storage, so posting does not allocate once they have grown to
+        /// the work in flight, as long as the work fits in std::function without allocating.
+        /// </summary>
+        class WorkerPool
+        {
+        public:
+            typedef std::function<void()> Work;
+
+            /// <summary>
+            /// One thread per core, leaving one for the ui and sensor threads.
+            /// </summary>
+            static size_t DefaultThreads()
+            {
+                size_t cores = std::thread::hardware_concurrency();
+                return cores > 2 ? cores - 1 : 1;
+            }
+
+            explicit WorkerPool(size_t threads) : state(std::make_shared<State>())
+            {
+                threads = threads != 0 ? threads : 1;
+                state->queued = 0;
+                state->stolen = 0;
+                state->stopping = false;
+                for (size_t i = 0; i < threads; ++i)
+                {
+                    state->local.push_back(std::unique_ptr<Queue>(new Queue()));
+                }
+
+                // the workers wait for the ids before taking any work
+                std::lock_guard<std::mutex> guard(state->lock);
+                for (size_t i = 0; i < threads; ++i)
+                {
+                    auto shared = state;
+                    workers.push_back(std::thread([shared, i]()
+                    {
+                        Run(shared, i);
+                    }));
+                    state->ids.push_back(workers.back().get_id());
+                }
+            }
+
+            /// <summary>
+            /// Work that is still queued is dropped.  The pool can be released by work that is
+            /// running on it, that thread finishes on its own.
+            /// </summary>
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(state->lock);
+                    state->stopping = true;
+                }
+                state->ready.notify_all();
+                for (auto& worker : workers)
+                {
+                    if (worker.get_id() == std::this_thread::get_id())
+                    {
+                        worker.detach();
+                    }
+                    else
+                    {
+                        worker.join();
+                    }
+                }
+                Clear(state->injected);
+                for (auto& queue : state->local)
+                {
+                    Clear(*queue);
+                }
+            }
+
+            size_t Threads() const
+            {
+                return workers.size();
+            }
+
+            /// <summary>
+            /// The index of the calling worker, from 0 to Threads() - 1, or Threads() on any
+            /// other thread, e.g. to keep state per worker.
+            /// </summary>
+            size_t Worker() const
+            {
+                return Self(*state);
+            }
+
+            void Post(Work work)
+            {
+                size_t self = Self(*state);
+                Queue& queue = self < state->local.size() ? *state->local[self] : state->injected;
+                {
+                    std::lock_guard<std::mutex> guard(queue.lock);
+                    queue.work.PushBack(std::move(work));
+                }
+                {
+                    std::lock_guard<std::mutex> guard(state->lock);
+                    ++state->queued;
+                }
+                state->ready.notify_one();
+            }
+
+            /// <summary>
+            /// The number of times a worker ran work from another worker's queue.
+            /// </summary>
+            unsigned long long Stolen() const
+            {
+                std::lock_guard<std::mutex> guard(state->lock);
+                return state->stolen;
+            }
+
+        private:
+            WorkerPool(const WorkerPool&);
+            WorkerPool& operator=(const WorkerPool&);
+
+            struct Queue
+            {
+                std::mutex lock;
+                RingQueue<Work> work;
+            };
+
+            // owned by the threads as well, so that a detached thread never touches the pool
+            struct State
+            {
+                // guards queued, stolen, stopping and ids; each queue has its own lock
+                mutable std::mutex lock;
+                std::condition_variable ready;
+                Queue injected;
+                std::vector<std::unique_ptr<Queue>> local;
+                std::vector<std::thread::id> ids;
+                // work in the queues that no worker has claimed yet
+                size_t queued;
+                unsigned long long stolen;
+                bool stopping;
+            };
+
+            // the index of the calling worker, or the number of workers for other threads
+            static size_t Self(const State& state)
+            {
+                std::lock_guard<std::mutex> guard(state.lock);
+                auto id = std::this_thread::get_id();
+                size_t index = 0;
+                while (index < state.ids.size() && state.ids[index] != id)
+                {
+                    ++index;
+                }
+                return index < state.ids.size() ? index : state.local.size();
+            }
+
+            static bool TakeNewest(Queue& queue, Work& work)
+            {
+                std::lock_guard<std::mutex> guard(queue.lock);
+                return queue.work.PopBack(work);
+            }
+
+            static bool TakeOldest(Queue& queue, Work& work)
+            {
+                std::lock_guard<std::mutex> guard(queue.lock);
+                return queue.work.PopFront(work);
+            }
+
+            static void Clear(Queue& queue)
+            {
+                std::lock_guard<std::mutex> guard(queue.lock);
+                queue.work.Clear();
+            }
+
+            static void Run(std::shared_ptr<State> state, size_t index)
+            {
+                size_t workers = state->local.size();
+                Work work;
+                for (;;)
+                {
+                    {
+                        std::unique_lock<std::mutex> guard(state->lock);
+                        state->ready.wait(guard, [&]()
+                        {
+                            return state->stopping || state->queued != 0;
+                        });
+                        if (state->stopping)
+                        {
+                            return;
+                        }
+                        // claimed, so one item is left in some queue for this worker
+                        --state->queued;
+                    }
+
+                    bool stolen = false;
+                    for (;;)
+                    {
+                        if (TakeNewest(*state->local[index], work) || TakeOldest(state->injected, work))
+                        {
+                            break;
+                        }
+                        size_t victim = 1;
+                        while (victim < workers && !TakeOldest(*state->local[(index + victim) % workers], work))
+                        {
+                            ++victim;
+                        }
+                        if (victim < workers)
+                        {
+                            stolen = true;
+                            break;
+                        }
+                        // another worker took the item that was found first, the one left
+                        // for this worker is in a queue that was already looked at
+                        std::this_thread::yield();
+                    }
+                    if (stolen)
+                    {
+                        std::lock_guard<std::mutex> guard(state->lock);
+                        ++state->stolen;
+                    }
+
+                    work();
+                    work = nullptr;
+                }
+            }
+
+            std::shared_ptr<State> state;
+            std::vector<std::thread> workers;
+        };
+
+        /// <summary>
+        /// One operator of a processing graph, run on a WorkerPool.  step(value, emit) is called
+        /// for each pushed value and may emit any number of results.  Up to Concurrency values
+        /// are processed at once; with a concurrency of one the values are processed one at a
+        /// time in the order they were pushed, so step may keep state, and with more the
+        /// values must be independent, e.g. whole windows.  Either way the results reach sink
+        /// in the order the values were pushed and one at a time, so stages can be chained by
+        /// pushing from one sink into the next stage to overlap the work of each stage.
+        /// Values in flight live in a ring of twice Concurrency slots that keep their result
+        /// storage, and a value waits in the pending queue while the oldest result in the ring
+        /// is not out yet, so nothing is allocated per value once the queues have grown.
+        /// Create it with std::make_shared; the stage keeps itself alive while it has work.
+        /// </summary>
+        template<class In, class Out>
+        class ProcessingStage : public std::enable_shared_from_this<ProcessingStage<In, Out>>
+        {
+        public:
+            typedef std::function<void(const Out&)> Emit;
+            typedef std::function<void(const In&, const Emit&)> Step;
+            typedef std::function<void(const Out&)> Sink;
+
+            ProcessingStage(std::shared_ptr<WorkerPool> pool, size_t concurrency, Step step, Sink sink) :
+                pool(std::move(pool)),
+                concurrency(concurrency != 0 ? concurrency : 1),
+                step(std::move(step)),
+                sink(std::move(sink)),
+                slots(2 * this->concurrency),
+                inFlight(0),
+                nextIn(0),
+                nextOut(0),
+                emitting(false),
+                closed(false)
+            {
+            }
+
+            size_t Concurrency() const
+            {
+                return concurrency;
+            }
+
+            void Push(const In& value)
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (closed)
+                {
+                    return;
+                }
+                pending.PushBack(value);
+                Dispatch(guard);
+            }
+
+            /// <summary>
+            /// Drops the pending values and stops calling sink, for a graph that is no longer
+            /// needed.  Values that are being processed finish and their results are dropped.
+            /// Called from outside the pool, waits for them, so that sink is not called after
+            /// Close returns.
+            /// </summary>
+            void Close()
+            {
+                std::shared_ptr<ProcessingStage> released;
+                std::unique_lock<std::mutex> guard(lock);
+                closed = true;
+                pending.Clear();
+                if (pool->Worker() == pool->Threads())
+                {
+                    idle.wait(guard, [this]()
+                    {
+                        return inFlight == 0 && !emitting;
+                    });
+                }
+                // a thread that is still in the sink releases the stage when it leaves
+                if (inFlight == 0 && !emitting)
+                {
+                    released = std::move(self);
+                }
+                guard.unlock();
+            }
+
+        private:
+            ProcessingStage(const ProcessingStage&);
+            ProcessingStage& operator=(const ProcessingStage&);
+
+            typedef unsigned long long Sequence;
+
+            struct Slot
+            {
+                Slot() : Finished(false)
+                {
+                }
+
+                In Value;
+                std::vector<Out> Results;
+                bool Finished;
+            };
+
+            void Dispatch(std::unique_lock<std::mutex>& guard)
+            {
+                while (inFlight < concurrency && !pending.Empty() && nextIn - nextOut < slots.size())
+                {
+                    Sequence sequence = nextIn++;
+                    Slot& slot = slots[sequence % slots.size()];
+                    pending.PopFront(slot.Value);
+                    slot.Finished = false;
+                    ++inFlight;
+                    if (self == nullptr)
+                    {
+                        self = this->shared_from_this();
+                    }
+
+                    // this and the sequence fit in std::function without allocating
+                    guard.unlock();
+                    pool->Post([this, sequence]()
+                    {
+                        Run(sequence);
+                    });
+                    guard.lock();
+                }
+            }
+
+            void Run(Sequence sequence)
+            {
+                // the slot is not reused until its results are out, so it is read unlocked
+                Slot& slot = slots[sequence % slots.size()];
+                std::vector<Out>& results = slot.Results;
+                step(slot.Value, [&results](const Out& result)
+                {
+                    results.push_back(result);
+                });
+
+                std::shared_ptr<ProcessingStage> released;
+                std::unique_lock<std::mutex> guard(lock);
+                --inFlight;
+                slot.Finished = true;
+
+                // whichever thread finds the next results in order delivers them, the others
+                // leave theirs in their slots
+                while (!emitting && !closed && nextOut != nextIn && slots[nextOut % slots.size()].Finished)
+                {
+                    Slot& ready = slots[nextOut % slots.size()];
+                    emitting = true;
+
+                    guard.unlock();
+                    for (auto& result : ready.Results)
+                    {
+                        sink(result);
+                    }
+                    guard.lock();
+                    ready.Results.clear();
+                    ready.Value = In();
+                    ready.Finished = false;
+                    ++nextOut;
+                    emitting = false;
+                }
+                if (closed)
+                {
+                    slot.Results.clear();
+                    slot.Value = In();
+                }
+                else
+                {
+                    Dispatch(guard);
+                }
+
+                // nothing is queued on the pool and no thread is in the sink, so the stage may
+                // go once its owners have
+                if (inFlight == 0 && !emitting && (closed || pending.Empty()))
+                {
+                    released = std::move(self);
+                }
+                if (closed)
+                {
+                    idle.notify_all();
+                }
+                guard.unlock();
+            }
+
+            std::shared_ptr<WorkerPool> pool;
+            size_t concurrency;
+            Step step;
+            Sink sink;
+
+            std::mutex lock;
+            // signalled for Close when a value finishes after it
+            std::condition_variable idle;
+            RingQueue<In> pending;
+            std::vector<Slot> slots;
+            size_t inFlight;
+            Sequence nextIn;
+            Sequence nextOut;
+            bool emitting;
+            bool closed;
+            // the stage itself while work is queued on the pool
+            std::shared_ptr<ProcessingStage> self;
+        };
+    }
+}
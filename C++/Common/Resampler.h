@@ -0,0 +1,216 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// Resampler.h
+// Declaration of the Resampler class
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Converts readings that arrive at an irregular rate, slower or faster than the output,
+        /// into readings at an exact period.  The readings are joined by straight lines and the
+        /// line is averaged over each cell of a grid Oversampling times finer than the output,
+        /// so every reading counts however many fall into a cell: a source much faster than the
+        /// output is decimated without aliasing, and a slower one is interpolated.  The cells
+        /// are then low-pass filtered by a windowed-sinc FIR with its cutoff at the output
+        /// Nyquist rate and decimated, evaluating only the output phase of the filter.  The
+        /// filter history is kept twice, back to back, per axis so that each output is three
+        /// straight dot products over contiguous memory that the compiler can vectorize.
+        /// Outputs fall on exact multiples of the period from the first reading, Span / 2
+        /// periods behind the newest reading, and carry its Received time.
+        /// Gaps longer than MaximumGap output periods restart the filter instead of
+        /// interpolating across them.
+        /// </summary>
+        class Resampler
+        {
+        public:
+            static const int Oversampling = 16;
+            static const int Span = 8;
+            static const int Taps = Oversampling * Span;
+            static const int MaximumGap = 10;
+
+            /// <summary>
+            /// period is the output period in 100ns units, at least Oversampling.
+            /// </summary>
+            explicit Resampler(long long period) :
+                period(period),
+                taps(Taps),
+                history(3 * 2 * Taps, 0.0)
+            {
+                if (period < Oversampling)
+                {
+                    throw std::invalid_argument("Resampler: the period is shorter than the grid");
+                }
+                DesignFilter();
+                Reset();
+            }
+
+            long long Period() const
+            {
+                return period;
+            }
+
+            void Reset()
+            {
+                primed = false;
+                filled = 0;
+                position = 0;
+            }
+
+            /// <summary>
+            /// Feeds one reading and calls emit(const SensorSample&amp;) for each output reading
+            /// that it completes.
+            /// </summary>
+            template<class Emit>
+            void Push(const SensorSample& sample, Emit emit)
+            {
+                if (primed && sample.Timestamp - previous.Timestamp > MaximumGap * period)
+                {
+                    Reset();
+                }
+                if (!primed)
+                {
+                    previous = sample;
+                    origin = sample.Timestamp;
+                    cell = 0;
+                    cellStart = origin;
+                    cellEnd = Boundary(1);
+                    sum[0] = sum[1] = sum[2] = 0.0;
+                    primed = true;
+                    return;
+                }
+                if (sample.Timestamp <= previous.Timestamp)
+                {
+                    // drop readings that do not move time forward
+                    return;
+                }
+
+                // add the line from the previous reading to this one to each cell it crosses
+                long long from = previous.Timestamp;
+                while (cellEnd <= sample.Timestamp)
+                {
+                    Integrate(sample, from, cellEnd);
+                    double width = static_cast<double>(cellEnd - cellStart);
+                    Append(sum[0] / width, sum[1] / width, sum[2] / width);
+                    sum[0] = sum[1] = sum[2] = 0.0;
+                    from = cellEnd;
+                    ++cell;
+                    cellStart = cellEnd;
+                    cellEnd = Boundary(cell + 1);
+
+                    // the filter is centred on a cell boundary that is a whole number of periods
+                    if (cell % Oversampling == 0 && filled == Taps)
+                    {
+                        SensorSample output;
+                        output.Timestamp = Boundary(cell - Taps / 2);
+                        output.X = Filter(0);
+                        output.Y = Filter(1);
+                        output.Z = Filter(2);
+                        output.Received = sample.Received;
+                        emit(output);
+                    }
+                }
+                Integrate(sample, from, sample.Timestamp);
+                previous = sample;
+            }
+
+        private:
+            void DesignFilter()
+            {
+                // Blackman windowed sinc, cutoff at half the output rate
+                const double pi = 3.14159265358979323846;
+                double cutoff = 0.5 / Oversampling;
+                double total = 0.0;
+                for (int i = 0; i < Taps; ++i)
+                {
+                    double m = i - (Taps - 1) / 2.0;
+                    double sinc = std::sin(2.0 * pi * cutoff * m) / (pi * m);
+                    double window = 0.42 - 0.5 * std::cos(2.0 * pi * i / (Taps - 1)) + 0.08 * std::cos(4.0 * pi * i / (Taps - 1));
+                    taps[i] = sinc * window;
+                    total += taps[i];
+                }
+                for (int i = 0; i < Taps; ++i)
+                {
+                    taps[i] /= total;
+                }
+            }
+
+            // the start of cell k, exact however long the session
+            long long Boundary(long long k) const
+            {
+                return origin + k / Oversampling * period + k % Oversampling * period / Oversampling;
+            }
+
+            // adds the integral of the line from previous to sample over [begin, end]
+            void Integrate(const SensorSample& sample, long long begin, long long end)
+            {
+                double span = static_cast<double>(sample.Timestamp - previous.Timestamp);
+                double a = static_cast<double>(begin - previous.Timestamp) / span;
+                double b = static_cast<double>(end - previous.Timestamp) / span;
+                double width = static_cast<double>(end - begin);
+                double middle = (a + b) / 2.0;
+                sum[0] += width * (previous.X + (sample.X - previous.X) * middle);
+                sum[1] += width * (previous.Y + (sample.Y - previous.Y) * middle);
+                sum[2] += width * (previous.Z + (sample.Z - previous.Z) * middle);
+            }
+
+            void Append(double x, double y, double z)
+            {
+                double values[3] = {x, y, z};
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    double* line = &history[axis * 2 * Taps];
+                    line[position] = values[axis];
+                    line[position + Taps] = values[axis];
+                }
+                position = position + 1 == Taps ? 0 : position + 1;
+                if (filled < Taps)
+                {
+                    ++filled;
+                }
+            }
+
+            double Filter(int axis) const
+            {
+                // the oldest value is at position, so the window is contiguous
+                const double* line = &history[axis * 2 * Taps + position];
+                const double* coefficients = &taps[0];
+                double total = 0.0;
+                for (int i = 0; i < Taps; ++i)
+                {
+                    total += line[i] * coefficients[i];
+                }
+                return total;
+            }
+
+            long long period;
+            std::vector<double> taps;
+            std::vector<double> history;
+            bool primed;
+            int filled;
+            int position;
+            SensorSample previous;
+            long long origin;
+            // the cell being filled and the integral of each axis over it so far
+            long long cell;
+            long long cellStart;
+            long long cellEnd;
+            double sum[3];
+        };
+    }
+}
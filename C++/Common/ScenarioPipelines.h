@@ -0,0 +1,511 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ScenarioPipelines.h
+// Declaration of the Scenario1Pipeline, Scenario2Pipeline and Scenario3Pipeline classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "PipelineMetrics.h"
+#include "SensorCalibration.h"
+#include "CancellableWork.h"
+#include "IntervalTimer.h"
+#include "BroadcastHub.h"
+#include "FixedPoint.h"
+#include "ActivityClassifier.h"
+#include "ProcessingGraph.h"
+#include "BlockPool.h"
+#include "EventTimeWindows.h"
+#include "CompressedHistory.h"
+#include "BurstAggregator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// What the Scenario1 page does with each reading, without rx or the Windows Runtime,
+        /// so the benchmarks and tests run the same steps the page does.  The page calls each
+        /// step from the rx operator it belongs to:
+        /// - Calibrate on the sensor thread, before Arbitrate and Broadcast;
+        /// - the sinks that Subscribe adds to the hub, for each batch Broadcast publishes;
+        /// - Analyze for each reading from Resample, which cuts the activity windows and
+        ///   classifies them on the worker pool, with Restart and End in line with the readings;
+        /// - Show and Shown on the ui thread, for each reading from ObserveOnBounded.
+        /// Warmup seeds the calibration when the scenario is enabled.  The worker pool, the
+        /// report interval and the ui thread that shows an activity are handed in.
+        /// </summary>
+        class Scenario1Pipeline
+        {
+        public:
+            typedef std::shared_ptr<const ReadingWindow> ActivityWindow;
+            typedef BroadcastHub<SensorBatch> Hub;
+
+            // readings per activity window, about a second
+            static const size_t WindowReadings = 64;
+
+            /// <summary>
+            /// The allocations per shown reading the page allows.
+            /// </summary>
+            static double AllocationBudget()
+            {
+                return 8.0;
+            }
+
+            /// <summary>
+            /// period() is the report interval in 100ns units, read when the first reading of a
+            /// run is analyzed.  showActivity is called on a worker thread with each activity,
+            /// in window order.
+            /// </summary>
+            Scenario1Pipeline(
+                const std::shared_ptr<WorkerPool>& pool,
+                std::function<long long()> period,
+                std::function<void(const Activity&)> showActivity,
+                const CalibrationParameters& calibration) :
+                calibration(calibration),
+                seeding(false),
+                // the last five minutes of readings for inspection, compressed in chunks of 512
+                history(std::make_shared<CompressedHistory>(5LL * 60 * 10000000, 512)),
+                // rolling statistics of the magnitude over the last window of readings
+                statistics(WindowReadings)
+            {
+                metrics.SetAllocationBudget(AllocationBudget());
+
+                // one classifier per worker, and windows recycled through a pool
+                auto classifiers = std::make_shared<std::vector<std::unique_ptr<ActivityClassifier>>>(pool->Threads() + 1);
+                auto windowBlocks = std::make_shared<BlockPool>();
+                classify = std::make_shared<ProcessingStage<ActivityWindow, Activity>>(pool, pool->Threads(),
+                    [pool, classifiers](const ActivityWindow& window, const std::function<void(const Activity&)>& emit)
+                    {
+                        // on a worker thread, which alone uses its classifier
+                        auto& classifier = (*classifiers)[pool->Worker()];
+                        if (classifier == nullptr)
+                        {
+                            classifier.reset(new ActivityClassifier(WindowReadings, window->Period));
+                        }
+                        classifier->SetPeriod(window->Period);
+                        emit(classifier->Classify(window->Samples, window->Count));
+                    },
+                    std::move(showActivity));
+
+                auto classifyStage = classify;
+                auto windows = std::make_shared<std::unique_ptr<EventTimeWindows<ReadingCollector>>>();
+                auto windowPeriod = std::make_shared<long long>(0);
+                cutWindows = std::make_shared<ProcessingStage<WindowInput, ActivityWindow>>(pool, 1,
+                    [period, windows, windowPeriod, windowBlocks](const WindowInput& input, const std::function<void(const ActivityWindow&)>& emit)
+                    {
+                        // on a worker thread, one input at a time
+                        auto cut = [&](long long, long long, ReadingCollector& collected)
+                        {
+                            collected.Sort();
+                            auto window = MakePooled<ReadingWindow>(windowBlocks);
+                            window->Period = *windowPeriod;
+                            window->Count = (std::min)(collected.Readings.size(), ReadingWindow::Capacity);
+                            std::copy(collected.Readings.begin(), collected.Readings.begin() + window->Count, window->Samples);
+                            emit(window);
+                        };
+                        if (input.What != WindowInput::Reading)
+                        {
+                            // the last windows of a run are classified when it ends, and a new run
+                            // starts from nothing, at the report interval it was enabled with
+                            if (*windows && input.What == WindowInput::End)
+                            {
+                                (*windows)->Flush(cut);
+                            }
+                            windows->reset();
+                            return;
+                        }
+                        if (!*windows)
+                        {
+                            // windows by timestamp, the period is known once the first reading arrives
+                            long long readingPeriod = period();
+                            if (readingPeriod <= 0)
+                            {
+                                return;
+                            }
+                            long long size = static_cast<long long>(WindowReadings) * readingPeriod;
+                            windows->reset(new EventTimeWindows<ReadingCollector>(size, size, readingPeriod));
+                            *windowPeriod = readingPeriod;
+                        }
+                        (*windows)->Push(input.Sample, cut);
+                    },
+                    [classifyStage](const ActivityWindow& window)
+                    {
+                        classifyStage->Push(window);
+                    });
+            }
+
+            /// <summary>
+            /// Refines the calibration while the device is still, unless the warm-up is seeding
+            /// it, and corrects the reading.  On the sensor thread.
+            /// </summary>
+            SensorSample Calibrate(const SensorSample& sample)
+            {
+                if (!seeding.load(std::memory_order_relaxed))
+                {
+                    calibration.Update(sample);
+                }
+                return calibration.Apply(sample);
+            }
+
+            /// <summary>
+            /// Feeds the calibration of pipeline one stationary period of fresh readings, so a
+            /// device that lies still is calibrated from the first readings that are shown.  Each
+            /// step polls once, with poll(SensorSample&amp;), which returns false when there is no
+            /// reading, and schedules the next one interval later on scheduler, so no thread is
+            /// held between polls; in the app the steps run on the worker pool.  The first step
+            /// is scheduled at once and begins the work, so its queue wait is that of the
+            /// scheduler; call work.Queued first.  done(bool seeded) is called by the last step,
+            /// with false when the work was cancelled, which the next step sees.  Calibrate
+            /// leaves the calibration alone until then.
+            /// </summary>
+            template<class Poll, class Done>
+            static void Warmup(
+                const std::shared_ptr<Scenario1Pipeline>& pipeline,
+                const std::shared_ptr<CancellableWork>& work,
+                IntervalTimer::Scheduler scheduler,
+                IntervalTimer::clock::duration interval,
+                Poll poll,
+                Done done)
+            {
+                auto run = std::make_shared<WarmupRun<Poll, Done>>(pipeline, work, std::move(scheduler), interval, std::move(poll), std::move(done));
+                auto scheduled = run->scheduler;
+                scheduled(IntervalTimer::clock::duration::zero(), [run]()
+                {
+                    run->ticket = run->work->Begin();
+                    run->pipeline->seeding.store(true);
+                    WarmupRun<Poll, Done>::Step(run);
+                });
+            }
+
+            CalibrationParameters Calibration() const
+            {
+                return calibration.Parameters();
+            }
+
+            /// <summary>
+            /// Subscribes the consumers that do not need rx to hub: the shared memory ring, if
+            /// there is one, and the history.  Ring is anything with Publish(const SensorSample&amp;).
+            /// They are subscribed once and stay when a Broadcast connection to hub ends.
+            /// </summary>
+            template<class Ring>
+            void Subscribe(Hub& hub, const std::shared_ptr<Ring>& ring)
+            {
+                if (ring != nullptr)
+                {
+                    hub.Subscribe([ring](const Hub::Block& batch)
+                    {
+                        // on sensor thread
+                        for (size_t i = 0; i < batch->Count; ++i)
+                        {
+                            ring->Publish(batch->Samples[i]);
+                        }
+                    });
+                }
+                auto kept = history;
+                hub.Subscribe([kept](const Hub::Block& batch)
+                {
+                    // on sensor thread
+                    for (size_t i = 0; i < batch->Count; ++i)
+                    {
+                        kept->Append(batch->Samples[i]);
+                    }
+                });
+            }
+
+            /// <summary>
+            /// Hands a resampled reading to the activity windows.  On the sensor thread.
+            /// </summary>
+            void Analyze(const SensorSample& sample)
+            {
+                WindowInput input = {WindowInput::Reading, sample};
+                cutWindows->Push(input);
+            }
+
+            /// <summary>
+            /// The scenario is enabled: the next reading starts new windows.  On the ui thread.
+            /// </summary>
+            void Restart()
+            {
+                WindowInput restart = {WindowInput::Restart, SensorSample()};
+                cutWindows->Push(restart);
+            }
+
+            /// <summary>
+            /// Adds a reading to the rolling statistics and returns those of the magnitude.  On
+            /// the ui thread.
+            /// </summary>
+            Statistics Show(const SensorSample& sample)
+            {
+                statistics.Push(sample);
+                return statistics.Magnitude();
+            }
+
+            /// <summary>
+            /// The reading is on screen.  On the ui thread.
+            /// </summary>
+            void Shown(const SensorSample& sample)
+            {
+                metrics.Record(sample.Received);
+            }
+
+            /// <summary>
+            /// The scenario ended: the last windows are classified and the statistics cleared.
+            /// On the ui thread.
+            /// </summary>
+            void End()
+            {
+                WindowInput end = {WindowInput::End, SensorSample()};
+                cutWindows->Push(end);
+                statistics.Reset();
+            }
+
+            /// <summary>
+            /// Waits for the windows that are being cut and classified, and drops the rest.
+            /// </summary>
+            void Close()
+            {
+                cutWindows->Close();
+                classify->Close();
+            }
+
+            const std::shared_ptr<CompressedHistory>& History() const
+            {
+                return history;
+            }
+
+            /// <summary>
+            /// Read and reset on the ui thread.
+            /// </summary>
+            PipelineMetrics& Metrics()
+            {
+                return metrics;
+            }
+
+        private:
+            Scenario1Pipeline(const Scenario1Pipeline&);
+            Scenario1Pipeline& operator=(const Scenario1Pipeline&);
+
+            // one warm-up, owned by the step that is scheduled
+            template<class Poll, class Done>
+            struct WarmupRun
+            {
+                WarmupRun(
+                    const std::shared_ptr<Scenario1Pipeline>& pipeline,
+                    const std::shared_ptr<CancellableWork>& work,
+                    IntervalTimer::Scheduler scheduler,
+                    IntervalTimer::clock::duration interval,
+                    Poll poll,
+                    Done done) :
+                    pipeline(pipeline),
+                    work(work),
+                    scheduler(std::move(scheduler)),
+                    interval(interval),
+                    poll(std::move(poll)),
+                    done(std::move(done)),
+                    readings(0),
+                    last(0)
+                {
+                }
+
+                static void Step(const std::shared_ptr<WarmupRun>& run)
+                {
+                    if (run->work->IsCancelled(run->ticket) || run->readings == SensorCalibration::WindowLength)
+                    {
+                        run->pipeline->seeding.store(false);
+                        run->work->End(run->ticket);
+                        run->done(run->readings == SensorCalibration::WindowLength);
+                        return;
+                    }
+                    SensorSample sample;
+                    if (run->poll(sample) && (run->readings == 0 || sample.Timestamp != run->last))
+                    {
+                        run->last = sample.Timestamp;
+                        run->pipeline->calibration.Update(sample);
+                        ++run->readings;
+                    }
+                    auto next = run;
+                    run->scheduler(run->readings == SensorCalibration::WindowLength ? IntervalTimer::clock::duration::zero() : run->interval, [next]()
+                    {
+                        Step(next);
+                    });
+                }
+
+                std::shared_ptr<Scenario1Pipeline> pipeline;
+                std::shared_ptr<CancellableWork> work;
+                IntervalTimer::Scheduler scheduler;
+                IntervalTimer::clock::duration interval;
+                Poll poll;
+                Done done;
+                CancellableWork::Ticket ticket;
+                int readings;
+                long long last;
+            };
+
+            // what the stage that cuts the activity windows is handed: a reading, or a mark that
+            // the scenario was enabled or ended, which reaches the stage in line with the readings
+            struct WindowInput
+            {
+                enum Kind
+                {
+                    Reading,
+                    Restart,
+                    End
+                };
+
+                Kind What;
+                SensorSample Sample;
+            };
+
+            SensorCalibration calibration;
+            std::atomic<bool> seeding;
+            std::shared_ptr<CompressedHistory> history;
+            ReadingStatistics statistics;
+            PipelineMetrics metrics;
+            std::shared_ptr<ProcessingStage<ActivityWindow, Activity>> classify;
+            std::shared_ptr<ProcessingStage<WindowInput, ActivityWindow>> cutWindows;
+        };
+
+        /// <summary>
+        /// What the Scenario2 page does with each shake: shakes less than the gap apart are
+        /// merged into one gesture, which is closed by the next shake on the sensor thread or by
+        /// a ui timer once the gap has passed without one, and shown on the ui thread.
+        /// </summary>
+        class Scenario2Pipeline
+        {
+        public:
+            static double AllocationBudget()
+            {
+                return 8.0;
+            }
+
+            /// <summary>
+            /// gap is in 100ns units.
+            /// </summary>
+            explicit Scenario2Pipeline(long long gap) :
+                gestures(gap)
+            {
+                metrics.SetAllocationBudget(AllocationBudget());
+            }
+
+            /// <summary>
+            /// The intensity of a shake, the magnitude of the acceleration when it is reported.
+            /// </summary>
+            static double Intensity(double x, double y, double z)
+            {
+                return std::sqrt(x * x + y * y + z * z);
+            }
+
+            long long Gap() const
+            {
+                return gestures.Gap();
+            }
+
+            /// <summary>
+            /// A shake, on the sensor thread.  Returns true with the gesture it closed.
+            /// </summary>
+            bool Shake(long long timestamp, double intensity, ShakeGesture& completed)
+            {
+                return gestures.Add(timestamp, intensity, completed);
+            }
+
+            /// <summary>
+            /// The ui timer, at now in the time of the shakes.  Returns true with the gesture that
+            /// ended more than the gap ago.
+            /// </summary>
+            bool Flush(long long now, ShakeGesture& completed)
+            {
+                return gestures.Flush(now, completed);
+            }
+
+            /// <summary>
+            /// The gesture is on screen.  On the ui thread.
+            /// </summary>
+            void Shown(const ShakeGesture& gesture)
+            {
+                metrics.Record(gesture.Completed);
+            }
+
+            /// <summary>
+            /// The scenario ended: a gesture in progress is dropped.
+            /// </summary>
+            void End()
+            {
+                gestures.Reset();
+            }
+
+            PipelineMetrics& Metrics()
+            {
+                return metrics;
+            }
+
+        private:
+            Scenario2Pipeline(const Scenario2Pipeline&);
+            Scenario2Pipeline& operator=(const Scenario2Pipeline&);
+
+            BurstAggregator gestures;
+            PipelineMetrics metrics;
+        };
+
+        /// <summary>
+        /// What the Scenario3 page does with each polled reading: it is corrected with the
+        /// calibration fitted in Scenario1, arbitrated by the rx operator, and shown on the
+        /// thread of the poll timer.
+        /// </summary>
+        class Scenario3Pipeline
+        {
+        public:
+            static double AllocationBudget()
+            {
+                return 4.0;
+            }
+
+            explicit Scenario3Pipeline(const CalibrationParameters& calibration) :
+                calibration(calibration)
+            {
+                metrics.SetAllocationBudget(AllocationBudget());
+            }
+
+            /// <summary>
+            /// Corrects a polled reading.
+            /// </summary>
+            SensorSample Calibrate(const SensorSample& sample) const
+            {
+                return calibration.Apply(sample);
+            }
+
+            /// <summary>
+            /// The reading is on screen.
+            /// </summary>
+            void Shown(const SensorSample& sample)
+            {
+                metrics.Record(sample.Received);
+            }
+
+            PipelineMetrics& Metrics()
+            {
+                return metrics;
+            }
+
+        private:
+            Scenario3Pipeline(const Scenario3Pipeline&);
+            Scenario3Pipeline& operator=(const Scenario3Pipeline&);
+
+            SensorCalibration calibration;
+            PipelineMetrics metrics;
+        };
+    }
+}
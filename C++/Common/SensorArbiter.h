@@ -0,0 +1,177 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorArbiter.h
+// Declaration of the SensorArbiter class
+//
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Shares one sensor between consumers that want readings at different report intervals.
+        /// The sensor runs at the shortest interval any active consumer asked for, clamped to the
+        /// minimum the device supports, and Deliver thins the readings back out to the interval
+        /// of each consumer.  The device is only touched through the apply callback, which is
+        /// called with the new interval whenever it changes, and with 0 once the last consumer
+        /// is released so that the sensor goes back to its default.
+        /// </summary>
+        class SensorArbiter
+        {
+        public:
+            typedef unsigned long long Consumer;
+            typedef std::function<void(unsigned int)> Apply;
+
+            /// <summary>
+            /// Intervals are in milliseconds, like Accelerometer::ReportInterval.
+            /// </summary>
+            SensorArbiter(unsigned int minimumInterval, Apply apply) :
+                minimumInterval(minimumInterval),
+                apply(apply),
+                next(1),
+                interval(0),
+                changes(0)
+            {
+            }
+
+            /// <summary>
+            /// Adds a consumer that wants a reading every requested milliseconds, or that has no
+            /// preference when requested is 0.
+            /// </summary>
+            Consumer Acquire(unsigned int requested)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                State state = {requested != 0 && requested < minimumInterval ? minimumInterval : requested, 0, false, 0, 0};
+                Consumer consumer = next++;
+                consumers[consumer] = state;
+                Update();
+                return consumer;
+            }
+
+            void Release(Consumer consumer)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (consumers.erase(consumer) != 0)
+                {
+                    Update();
+                }
+            }
+
+            /// <summary>
+            /// Returns true when the reading at timestamp, in 100ns units, is due for consumer.
+            /// Readings are passed on once the interval of the consumer has elapsed, less half of
+            /// the sensor interval to absorb jitter, so a consumer at the sensor interval gets
+            /// every reading and one at twice the interval every other reading.
+            /// </summary>
+            bool Deliver(Consumer consumer, long long timestamp)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                auto found = consumers.find(consumer);
+                if (found == consumers.end())
+                {
+                    return false;
+                }
+                State& state = found->second;
+                long long due = (static_cast<long long>(state.Interval) * 2 - interval) * 5000;
+                if (state.Started && timestamp - state.Last < due)
+                {
+                    ++state.Skipped;
+                    return false;
+                }
+                state.Started = true;
+                state.Last = timestamp;
+                ++state.Delivered;
+                return true;
+            }
+
+            /// <summary>
+            /// The interval the sensor runs at, or 0 when there are no consumers with a
+            /// preference.
+            /// </summary>
+            unsigned int Interval() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return interval;
+            }
+
+            size_t Consumers() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return consumers.size();
+            }
+
+            std::wstring Report(const std::wstring& name) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                std::wostringstream out;
+                out << name
+                    << L": consumers=" << consumers.size()
+                    << L" interval=" << interval << L"ms"
+                    << L" interval changes=" << changes
+                    << L"\n";
+                for (auto& consumer : consumers)
+                {
+                    out << L"  consumer " << consumer.first
+                        << L": interval=" << consumer.second.Interval << L"ms"
+                        << L" delivered=" << consumer.second.Delivered
+                        << L" skipped=" << consumer.second.Skipped
+                        << L"\n";
+                }
+                return out.str();
+            }
+
+        private:
+            SensorArbiter(const SensorArbiter&);
+            SensorArbiter& operator=(const SensorArbiter&);
+
+            struct State
+            {
+                unsigned int Interval;
+                long long Last;
+                bool Started;
+                unsigned long long Delivered;
+                unsigned long long Skipped;
+            };
+
+            void Update()
+            {
+                unsigned int shortest = 0;
+                for (auto& consumer : consumers)
+                {
+                    unsigned int requested = consumer.second.Interval;
+                    if (requested != 0 && (shortest == 0 || requested < shortest))
+                    {
+                        shortest = requested;
+                    }
+                }
+                if (shortest != interval)
+                {
+                    interval = shortest;
+                    ++changes;
+                    apply(interval);
+                }
+            }
+
+            unsigned int minimumInterval;
+            Apply apply;
+            mutable std::mutex lock;
+            Consumer next;
+            unsigned int interval;
+            unsigned long long changes;
+            std::map<Consumer, State> consumers;
+        };
+    }
+}
@@ -0,0 +1,303 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorCalibration.h
+// Declaration of the SensorCalibration class
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <cmath>
+#include <mutex>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Per-axis bias and scale.  A corrected value is (raw - Bias) * Scale, in g.
+        /// </summary>
+        struct CalibrationParameters
+        {
+            double Bias[3];
+            double Scale[3];
+
+            static CalibrationParameters Identity()
+            {
+                CalibrationParameters parameters = {{0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}};
+                return parameters;
+            }
+        };
+
+        /// <summary>
+        /// Streaming accelerometer calibration.  While the device is held still the reading is
+        /// gravity alone, so the mean of each stationary period is a point on the ellipsoid
+        /// a x^2 + b y^2 + c z^2 + d x + e y + f z = 1 described by the sensor's bias and scale.
+        /// Each point is folded into 6x6 least-squares normal equations with a forgetting factor,
+        /// so memory is fixed and an update costs one 6x6 solve no matter how long the history.
+        /// Apply is cheap and is meant to run on every sample; Update runs the detection and
+        /// fit and is meant for the sensor thread.  Both are thread-safe.
+        /// </summary>
+        class SensorCalibration
+        {
+        public:
+            /// <summary>
+            /// The number of consecutive readings that make one stationary period.
+            /// </summary>
+            static const int WindowLength = 32;
+
+            SensorCalibration() : parameters(CalibrationParameters::Identity())
+            {
+                ResetFit();
+            }
+
+            explicit SensorCalibration(const CalibrationParameters& initial) : parameters(initial)
+            {
+                ResetFit();
+            }
+
+            CalibrationParameters Parameters() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return parameters;
+            }
+
+            /// <summary>
+            /// Number of stationary periods that went into the current fit.
+            /// </summary>
+            unsigned int Points() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return points;
+            }
+
+            SensorSample Apply(SensorSample sample) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                sample.X = (sample.X - parameters.Bias[0]) * parameters.Scale[0];
+                sample.Y = (sample.Y - parameters.Bias[1]) * parameters.Scale[1];
+                sample.Z = (sample.Z - parameters.Bias[2]) * parameters.Scale[2];
+                return sample;
+            }
+
+            /// <summary>
+            /// Feeds one raw sample to the stationary detector.  Returns true when the sample
+            /// completed a stationary period and the parameters were refitted.
+            /// </summary>
+            bool Update(const SensorSample& sample)
+            {
+                std::lock_guard<std::mutex> updating(fit);
+                double v[3] = {sample.X, sample.Y, sample.Z};
+                double magnitude = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+                // a still device reads close to 1g
+                if (std::fabs(magnitude - 1.0) > MaximumGravityError())
+                {
+                    ResetWindow();
+                    return false;
+                }
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    windowSum[i] += v[i];
+                    windowSquares[i] += v[i] * v[i];
+                }
+                if (++windowCount < WindowLength)
+                {
+                    return false;
+                }
+
+                // total variance of the vector, so that a change of orientation is not still
+                double point[3];
+                double variance = 0.0;
+                for (int i = 0; i < 3; ++i)
+                {
+                    point[i] = windowSum[i] / WindowLength;
+                    variance += windowSquares[i] / WindowLength - point[i] * point[i];
+                }
+                ResetWindow();
+                if (variance > MaximumStationaryVariance())
+                {
+                    return false;
+                }
+
+                // only new orientations add information
+                double separation = 0.0;
+                for (int i = 0; i < 3; ++i)
+                {
+                    separation += (point[i] - lastPoint[i]) * (point[i] - lastPoint[i]);
+                }
+                if (separation < MinimumSeparation() * MinimumSeparation())
+                {
+                    return false;
+                }
+                for (int i = 0; i < 3; ++i)
+                {
+                    lastPoint[i] = point[i];
+                }
+
+                return AddPoint(point);
+            }
+
+        private:
+            static const int Unknowns = 6;
+            static const unsigned int MinimumPoints = 9;
+
+            // chosen for a phone-class sensor with ~0.01g noise
+            static double MaximumGravityError() { return 0.25; }
+            static double MaximumStationaryVariance() { return 0.0004; }
+            static double MinimumSeparation() { return 0.2; }
+            static double Forgetting() { return 0.98; }
+
+            bool AddPoint(const double (&point)[3])
+            {
+                double h[Unknowns] = {
+                    point[0] * point[0], point[1] * point[1], point[2] * point[2],
+                    point[0], point[1], point[2]};
+
+                for (int r = 0; r < Unknowns; ++r)
+                {
+                    for (int c = 0; c < Unknowns; ++c)
+                    {
+                        normal[r][c] = Forgetting() * normal[r][c] + h[r] * h[c];
+                    }
+                    rhs[r] = Forgetting() * rhs[r] + h[r];
+                }
+
+                std::lock_guard<std::mutex> guard(lock);
+                ++points;
+                if (points < MinimumPoints)
+                {
+                    return false;
+                }
+
+                double solution[Unknowns];
+                if (!Solve(solution))
+                {
+                    return false;
+                }
+
+                double a = solution[0], b = solution[1], c = solution[2];
+                if (a <= 0.0 || b <= 0.0 || c <= 0.0)
+                {
+                    return false;
+                }
+                double g = 1.0 +
+                    solution[3] * solution[3] / (4.0 * a) +
+                    solution[4] * solution[4] / (4.0 * b) +
+                    solution[5] * solution[5] / (4.0 * c);
+                if (g <= 0.0)
+                {
+                    return false;
+                }
+
+                CalibrationParameters fitted = {
+                    {-solution[3] / (2.0 * a), -solution[4] / (2.0 * b), -solution[5] / (2.0 * c)},
+                    {std::sqrt(a / g), std::sqrt(b / g), std::sqrt(c / g)}};
+                parameters = fitted;
+                return true;
+            }
+
+            /// <summary>
+            /// Gaussian elimination with partial pivoting on a copy of the normal equations.
+            /// Fails when the orientations seen so far do not constrain every axis.
+            /// </summary>
+            bool Solve(double (&solution)[Unknowns]) const
+            {
+                double m[Unknowns][Unknowns + 1];
+                for (int r = 0; r < Unknowns; ++r)
+                {
+                    for (int c = 0; c < Unknowns; ++c)
+                    {
+                        m[r][c] = normal[r][c];
+                    }
+                    m[r][Unknowns] = rhs[r];
+                }
+
+                for (int col = 0; col < Unknowns; ++col)
+                {
+                    int pivot = col;
+                    for (int r = col + 1; r < Unknowns; ++r)
+                    {
+                        if (std::fabs(m[r][col]) > std::fabs(m[pivot][col]))
+                        {
+                            pivot = r;
+                        }
+                    }
+                    if (std::fabs(m[pivot][col]) < 1e-9)
+                    {
+                        return false;
+                    }
+                    for (int c = 0; c <= Unknowns; ++c)
+                    {
+                        std::swap(m[col][c], m[pivot][c]);
+                    }
+                    for (int r = col + 1; r < Unknowns; ++r)
+                    {
+                        double factor = m[r][col] / m[col][col];
+                        for (int c = col; c <= Unknowns; ++c)
+                        {
+                            m[r][c] -= factor * m[col][c];
+                        }
+                    }
+                }
+
+                for (int r = Unknowns - 1; r >= 0; --r)
+                {
+                    double value = m[r][Unknowns];
+                    for (int c = r + 1; c < Unknowns; ++c)
+                    {
+                        value -= m[r][c] * solution[c];
+                    }
+                    solution[r] = value / m[r][r];
+                }
+                return true;
+            }
+
+            void ResetWindow()
+            {
+                windowSum[0] = windowSum[1] = windowSum[2] = 0.0;
+                windowSquares[0] = windowSquares[1] = windowSquares[2] = 0.0;
+                windowCount = 0;
+            }
+
+            void ResetFit()
+            {
+                ResetWindow();
+                for (int r = 0; r < Unknowns; ++r)
+                {
+                    for (int c = 0; c < Unknowns; ++c)
+                    {
+                        normal[r][c] = 0.0;
+                    }
+                    rhs[r] = 0.0;
+                }
+                lastPoint[0] = lastPoint[1] = lastPoint[2] = 0.0;
+                points = 0;
+            }
+
+            mutable std::mutex lock;
+            CalibrationParameters parameters;
+
+            // held by Update, which may be called from more than one thread
+            std::mutex fit;
+
+            // stationary detection, only touched by Update
+            double windowSum[3];
+            double windowSquares[3];
+            int windowCount;
+            double lastPoint[3];
+
+            // least-squares state, only touched by Update
+            double normal[Unknowns][Unknowns];
+            double rhs[Unknowns];
+            unsigned int points;
+        };
+    }
+}
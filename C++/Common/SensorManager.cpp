@@ -0,0 +1,57 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorManager.cpp
+// Implementation of the SensorManager class
+//
+
+#include "pch.h"
+#include "SensorManager.h"
+#include "DeferredAccelerometer.h"
+
+#include <mutex>
+
+using namespace SDKSample::Common;
+
+namespace
+{
+    std::mutex lock;
+    std::shared_ptr<SensorArbiter> accelerometerArbiter;
+    // apart from lock, which is held while the accelerometer is acquired
+    std::mutex workersLock;
+    std::shared_ptr<WorkerPool> workers;
+}
+
+std::shared_ptr<SensorArbiter> SensorManager::Accelerometer()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (accelerometerArbiter == nullptr)
+    {
+        auto accelerometer = DeferredAccelerometer::Get();
+        if (accelerometer == nullptr)
+        {
+            return nullptr;
+        }
+        accelerometerArbiter = std::make_shared<SensorArbiter>(accelerometer->MinimumReportInterval,
+            [accelerometer](unsigned int interval)
+            {
+                // 0 restores the default interval of the sensor
+                accelerometer->ReportInterval = interval;
+            });
+    }
+    return accelerometerArbiter;
+}
+
+std::shared_ptr<WorkerPool> SensorManager::Workers()
+{
+    std::lock_guard<std::mutex> guard(workersLock);
+    if (workers == nullptr)
+    {
+        workers = std::make_shared<WorkerPool>(WorkerPool::DefaultThreads());
+    }
+    return workers;
+}
@@ -0,0 +1,45 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorManager.h
+// Declaration of the SensorManager class
+//
+
+#pragma once
+
+#include "SensorArbiter.h"
+#include "ProcessingGraph.h"
+
+#include <memory>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Owns the process-wide SensorArbiter of the default accelerometer, so that scenarios
+        /// request report intervals from it instead of setting ReportInterval on the shared
+        /// device themselves, and the worker pool that the scenarios run their analytics on.
+        /// </summary>
+        class SensorManager
+        {
+        public:
+            /// <summary>
+            /// Returns the arbiter of the accelerometer report interval, or nullptr when there is
+            /// no accelerometer.  Acquires the accelerometer on first use.  Safe to call from any
+            /// thread.
+            /// </summary>
+            static std::shared_ptr<SensorArbiter> Accelerometer();
+
+            /// <summary>
+            /// Returns the worker pool shared by every scenario page, so that cached pages do
+            /// not each keep threads.  Created on first use.  Safe to call from any thread.
+            /// </summary>
+            static std::shared_ptr<WorkerPool> Workers();
+        };
+    }
+}
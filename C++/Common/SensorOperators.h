@@ -0,0 +1,431 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorOperators.h
+// Rx operators for streams of SensorSample
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "Resampler.h"
+#include "BroadcastHub.h"
+#include "BoundedQueue.h"
+#include "SensorArbiter.h"
+#include "IntervalTimer.h"
+#include "ProcessingGraph.h"
+#include "DebugOutput.h"
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Lifts a stateful step that may produce any number of values for each input into an
+        /// operator.  makeState is called once per subscription and step(state, value, emit)
+        /// is called for each value, on the thread that delivers it.
+        /// </summary>
+        template<class U, class T, class MakeState, class Step>
+        std::shared_ptr<rx::Observable<U>> Expand(
+            const std::shared_ptr<rx::Observable<T>>& source,
+            MakeState makeState,
+            Step step)
+        {
+            return rx::CreateObservable<U>(
+                [=](std::shared_ptr<rx::Observer<U>> observer) -> rx::Disposable
+                {
+                    auto state = std::make_shared<decltype(makeState())>(makeState());
+                    return rx::Subscribe(source,
+                        // on next
+                        [=](const T& value)
+                        {
+                            step(*state, value, [&](const U& result)
+                            {
+                                observer->OnNext(result);
+                            });
+                        },
+                        // on completed
+                        [=]()
+                        {
+                            observer->OnCompleted();
+                        },
+                        // on error
+                        [=](const std::exception_ptr& error)
+                        {
+                            observer->OnError(error);
+                        });
+                });
+        }
+
+        /// <summary>
+        /// Calls makeSource when a subscription starts and subscribes to what it returns, so a
+        /// source can depend on settings that are chosen after the graph is composed.
+        /// </summary>
+        template<class T, class MakeSource>
+        std::shared_ptr<rx::Observable<T>> Defer(MakeSource makeSource)
+        {
+            return rx::CreateObservable<T>(
+                [=](std::shared_ptr<rx::Observer<T>> observer) -> rx::Disposable
+                {
+                    return rx::Subscribe(makeSource(),
+                        // on next
+                        [=](const T& value)
+                        {
+                            observer->OnNext(value);
+                        },
+                        // on completed
+                        [=]()
+                        {
+                            observer->OnCompleted();
+                        },
+                        // on error
+                        [=](const std::exception_ptr& error)
+                        {
+                            observer->OnError(error);
+                        });
+                });
+        }
+
+        /// <summary>
+        /// Holds a consumer of the arbiter for as long as a subscription lasts and passes on only
+        /// the readings that are due for it.  arbiter() and interval() are read when a
+        /// subscription starts, so both can be chosen after the graph is composed.  Nothing is
+        /// reported when a subscription ends, which happens at each visibility change and on
+        /// whichever thread ends it; the pages report the arbiter when a scenario ends.
+        /// </summary>
+        template<class MakeArbiter, class Interval>
+        std::shared_ptr<rx::Observable<SensorSample>> Arbitrate(
+            const std::shared_ptr<rx::Observable<SensorSample>>& source,
+            MakeArbiter arbiter,
+            Interval interval)
+        {
+            return rx::CreateObservable<SensorSample>(
+                [=](std::shared_ptr<rx::Observer<SensorSample>> observer) -> rx::Disposable
+                {
+                    // without an arbiter every reading is passed on
+                    std::shared_ptr<SensorArbiter> shared = arbiter();
+                    SensorArbiter::Consumer consumer = shared != nullptr ? shared->Acquire(interval()) : 0;
+                    auto subscription = std::make_shared<rx::ComposableDisposable>();
+                    subscription->Add(rx::Subscribe(source,
+                        // on next
+                        [=](const SensorSample& sample)
+                        {
+                            if (shared == nullptr || shared->Deliver(consumer, sample.Timestamp))
+                            {
+                                observer->OnNext(sample);
+                            }
+                        },
+                        // on completed
+                        [=]()
+                        {
+                            observer->OnCompleted();
+                        },
+                        // on error
+                        [=](const std::exception_ptr& error)
+                        {
+                            observer->OnError(error);
+                        }));
+
+                    return rx::Disposable([=]()
+                    {
+                        subscription->Dispose();
+                        if (shared != nullptr)
+                        {
+                            shared->Release(consumer);
+                        }
+                    });
+                });
+        }
+
+        /// <summary>
+        /// Resamples the readings to an exact period.  period() is read when a subscription
+        /// starts, so it can follow a report interval that is chosen later.
+        /// </summary>
+        template<class Period>
+        std::shared_ptr<rx::Observable<SensorSample>> Resample(
+            const std::shared_ptr<rx::Observable<SensorSample>>& source,
+            Period period)
+        {
+            return Expand<SensorSample>(source,
+                [=]()
+                {
+                    return Resampler(period());
+                },
+                [](Resampler& resampler, const SensorSample& sample, const std::function<void(const SensorSample&)>& emit)
+                {
+                    resampler.Push(sample, emit);
+                });
+        }
+
+        /// <summary>
+        /// Shares one subscription to source through hub.  The first subscriber connects to
+        /// source and the last one to leave disconnects, like publish().ref_count(), but each
+        /// reading is published once as an immutable SensorBatch from the pool of the hub that
+        /// every subscriber reads in place.  When source completes or fails, every rx subscriber
+        /// is told and dropped from the hub, and the next subscriber connects afresh.
+        /// Consumers that do not need rx, and their scheduling, can subscribe to hub directly
+        /// while an rx subscriber keeps the connection open.  They are not told when source
+        /// ends and stay subscribed, so they receive the readings of the next connection too.
+        /// </summary>
+        inline std::shared_ptr<rx::Observable<SensorSample>> Broadcast(
+            const std::shared_ptr<rx::Observable<SensorSample>>& source,
+            const std::shared_ptr<BroadcastHub<SensorBatch>>& hub)
+        {
+            struct Connection
+            {
+                std::mutex lock;
+                size_t subscribers;
+                // counts connections, so that subscribers of one that ended leave it alone
+                unsigned long long generation;
+                std::shared_ptr<rx::ComposableDisposable> subscription;
+                // the hub subscriptions of the rx subscribers, which end with the connection
+                std::vector<BroadcastHub<SensorBatch>::Token> tokens;
+            };
+            auto connection = std::make_shared<Connection>();
+            connection->subscribers = 0;
+            connection->generation = 0;
+
+            return rx::CreateObservable<SensorSample>(
+                [=](std::shared_ptr<rx::Observer<SensorSample>> observer) -> rx::Disposable
+                {
+                    auto token = hub->Subscribe(
+                        [observer](const BroadcastHub<SensorBatch>::Block& batch)
+                        {
+                            for (size_t i = 0; i < batch->Count; ++i)
+                            {
+                                observer->OnNext(batch->Samples[i]);
+                            }
+                        },
+                        [observer](const std::exception_ptr& error)
+                        {
+                            if (error)
+                            {
+                                observer->OnError(error);
+                            }
+                            else
+                            {
+                                observer->OnCompleted();
+                            }
+                        });
+
+                    unsigned long long generation;
+                    std::shared_ptr<rx::ComposableDisposable> connect;
+                    {
+                        std::lock_guard<std::mutex> guard(connection->lock);
+                        generation = connection->generation;
+                        connection->tokens.push_back(token);
+                        if (connection->subscribers++ == 0)
+                        {
+                            connect = std::make_shared<rx::ComposableDisposable>();
+                            connection->subscription = connect;
+                        }
+                    }
+
+                    // outside the lock, in case source ends while it is subscribed to
+                    if (connect != nullptr)
+                    {
+                        // ends this connection once, on completion or error
+                        auto end = [hub, connection, generation](const std::exception_ptr& error)
+                        {
+                            std::shared_ptr<rx::ComposableDisposable> ended;
+                            std::vector<BroadcastHub<SensorBatch>::Token> tokens;
+                            {
+                                std::lock_guard<std::mutex> guard(connection->lock);
+                                if (connection->generation != generation)
+                                {
+                                    return;
+                                }
+                                ++connection->generation;
+                                connection->subscribers = 0;
+                                ended = std::move(connection->subscription);
+                                tokens.swap(connection->tokens);
+                            }
+                            // the direct subscribers of the hub stay for the next connection
+                            hub->Terminate(error, tokens);
+                            ended->Dispose();
+                        };
+
+                        connect->Add(rx::Subscribe(source,
+                            // on next
+                            [hub](const SensorSample& sample)
+                            {
+                                auto batch = hub->Allocate();
+                                batch->Count = 1;
+                                batch->Samples[0] = sample;
+                                hub->Publish(batch);
+                            },
+                            // on completed
+                            [end]()
+                            {
+                                end(std::exception_ptr());
+                            },
+                            // on error
+                            [end](const std::exception_ptr& error)
+                            {
+                                end(error);
+                            }));
+                    }
+
+                    return rx::Disposable([=]()
+                    {
+                        hub->Unsubscribe(token);
+
+                        std::lock_guard<std::mutex> guard(connection->lock);
+                        if (connection->generation != generation)
+                        {
+                            return;
+                        }
+                        auto& tokens = connection->tokens;
+                        tokens.erase(std::remove(tokens.begin(), tokens.end(), token), tokens.end());
+                        if (--connection->subscribers == 0)
+                        {
+                            connection->subscription->Dispose();
+                            connection->subscription.reset();
+                        }
+                    });
+                });
+        }
+
+        /// <summary>
+        /// A BoundedQueue scheduler that runs work on dispatcher, after the delay if there is one.
+        /// </summary>
+        inline BoundedQueue<SensorSample>::Scheduler DispatcherScheduler(Windows::UI::Core::CoreDispatcher^ dispatcher)
+        {
+            using namespace Windows::UI::Core;
+            using namespace Windows::System::Threading;
+
+            return [dispatcher](std::chrono::steady_clock::duration delay, std::function<void()> work)
+            {
+                auto handler = ref new DispatchedHandler([work]()
+                {
+                    work();
+                });
+                if (delay <= std::chrono::steady_clock::duration::zero())
+                {
+                    dispatcher->RunAsync(CoreDispatcherPriority::Normal, handler);
+                    return;
+                }
+                Windows::Foundation::TimeSpan dueTime;
+                dueTime.Duration = std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(delay).count();
+                ThreadPoolTimer::CreateTimer(ref new TimerElapsedHandler([dispatcher, handler](ThreadPoolTimer^)
+                {
+                    dispatcher->RunAsync(CoreDispatcherPriority::Normal, handler);
+                }), dueTime);
+            };
+        }
+
+        /// <summary>
+        /// A scheduler that runs work on pool, after the delay if there is one.  The delay is
+        /// waited out by a thread pool timer, so no worker is held until the work is due.
+        /// </summary>
+        inline IntervalTimer::Scheduler WorkerPoolScheduler(const std::shared_ptr<WorkerPool>& pool)
+        {
+            using namespace Windows::System::Threading;
+
+            return [pool](IntervalTimer::clock::duration delay, IntervalTimer::Work work)
+            {
+                if (delay <= IntervalTimer::clock::duration::zero())
+                {
+                    pool->Post(std::move(work));
+                    return;
+                }
+                Windows::Foundation::TimeSpan dueTime;
+                dueTime.Duration = std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(delay).count();
+                ThreadPoolTimer::CreateTimer(ref new TimerElapsedHandler([pool, work](ThreadPoolTimer^)
+                {
+                    pool->Post(work);
+                }), dueTime);
+            };
+        }
+
+        /// <summary>
+        /// Emits 0, 1, 2, ... every period on scheduler, e.g. DispatcherScheduler for a timer on
+        /// the ui thread, until the subscription ends.
+        /// </summary>
+        inline std::shared_ptr<rx::Observable<size_t>> Interval(
+            std::chrono::steady_clock::duration period,
+            IntervalTimer::Scheduler scheduler)
+        {
+            return rx::CreateObservable<size_t>(
+                [=](std::shared_ptr<rx::Observer<size_t>> observer) -> rx::Disposable
+                {
+                    auto timer = IntervalTimer::Start(scheduler, period, [observer](size_t tick)
+                    {
+                        observer->OnNext(tick);
+                    });
+
+                    return rx::Disposable([timer]()
+                    {
+                        timer->Cancel();
+                    });
+                });
+        }
+
+        /// <summary>
+        /// observe_on with a BoundedQueue between the source and the scheduler, so a stalled
+        /// consumer loses readings by policy instead of queueing them without bound.  Completion
+        /// and errors wait behind the queued values and close the queue.  The queue counters
+        /// are written to the DebugOutput as name when a subscription ends.
+        /// </summary>
+        template<class T>
+        std::shared_ptr<rx::Observable<T>> ObserveOnBounded(
+            const std::shared_ptr<rx::Observable<T>>& source,
+            OverflowPolicy policy,
+            size_t capacity,
+            std::chrono::steady_clock::duration interval,
+            typename BoundedQueue<T>::Scheduler scheduler,
+            const std::wstring& name)
+        {
+            return rx::CreateObservable<T>(
+                [=](std::shared_ptr<rx::Observer<T>> observer) -> rx::Disposable
+                {
+                    auto queue = std::make_shared<BoundedQueue<T>>(policy, capacity, interval, scheduler,
+                        [observer](const T& value)
+                        {
+                            observer->OnNext(value);
+                        });
+
+                    auto subscription = std::make_shared<rx::ComposableDisposable>();
+                    subscription->Add(rx::Subscribe(source,
+                        // on next
+                        [queue](const T& value)
+                        {
+                            queue->Push(value);
+                        },
+                        // on completed, after the queued values
+                        [queue, observer]()
+                        {
+                            queue->Finish([observer]()
+                            {
+                                observer->OnCompleted();
+                            });
+                        },
+                        // on error, after the queued values
+                        [queue, observer](const std::exception_ptr& error)
+                        {
+                            queue->Finish([observer, error]()
+                            {
+                                observer->OnError(error);
+                            });
+                        }));
+
+                    return rx::Disposable([=]()
+                    {
+                        subscription->Dispose();
+                        queue->Close();
+                        if (queue->Pushed() != 0)
+                        {
+                            DebugOutput([queue, name]()
+                            {
+                                return queue->Report(name);
+                            });
+                        }
+                    });
+                });
+        }
+    }
+}
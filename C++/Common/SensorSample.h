@@ -0,0 +1,38 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorSample.h
+// Declaration of the SensorSample struct
+//
+
+#pragma once
+
+#include <chrono>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// A plain copy of one accelerometer reading.  The scenarios copy the values out of
+        /// the AccelerometerReading^ as soon as it arrives so that everything downstream
+        /// works on values instead of WinRT objects.
+        /// </summary>
+        struct SensorSample
+        {
+            typedef std::chrono::steady_clock clock;
+
+            // sensor timestamp in 100ns units, as in DateTime::UniversalTime
+            long long Timestamp;
+            double X;
+            double Y;
+            double Z;
+            // when the sample entered the pipeline
+            clock::time_point Received;
+        };
+    }
+}
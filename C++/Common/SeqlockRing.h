@@ -0,0 +1,253 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SeqlockRing.h
+// Declaration of the SeqlockRingWriter and SeqlockRingReader classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Layout of a ring of readings in memory that is shared between processes: a header
+        /// followed by Capacity records.  Only lock-free atomics are stored, so the same bytes
+        /// can be mapped at different addresses by different processes, and a reader that races
+        /// the writer reads stale words rather than torn ones.
+        /// </summary>
+        struct SeqlockRing
+        {
+            static const uint32_t Magic = 0x52434341; // "ACCR"
+            static const uint32_t Version = 2;
+
+            struct Header
+            {
+                // set last, once the rest of the ring is formatted
+                std::atomic<uint32_t> Magic;
+                uint32_t Version;
+                uint32_t Capacity;
+                uint32_t RecordSize;
+                // number of records written so far, record n is at n % Capacity
+                std::atomic<uint64_t> Published;
+            };
+
+            /// <summary>
+            /// Five 64-bit words, 40 bytes.  The reading is stored as the bits of its fields.
+            /// </summary>
+            struct Record
+            {
+                // 2n + 1 while the writer is writing record n into the slot, 2n + 2 once it has
+                // written it, so the sequence also tells which record the slot holds
+                std::atomic<uint64_t> Sequence;
+                std::atomic<uint64_t> Timestamp;
+                std::atomic<uint64_t> X;
+                std::atomic<uint64_t> Y;
+                std::atomic<uint64_t> Z;
+            };
+
+            static size_t Bytes(uint32_t capacity)
+            {
+                return sizeof(Header) + capacity * sizeof(Record);
+            }
+
+            static uint64_t Bits(double value)
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+
+            static double Value(uint64_t bits)
+            {
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+        };
+
+        static_assert(sizeof(SeqlockRing::Record) == 40, "a SeqlockRing record is five words");
+
+        /// <summary>
+        /// The single writer of a SeqlockRing.  Each record has its own sequence number, which is
+        /// odd while the record is being written, so readers never wait for the writer and the
+        /// writer never waits for readers; a reader that falls more than Capacity records behind
+        /// loses the oldest ones.
+        /// </summary>
+        class SeqlockRingWriter
+        {
+        public:
+            /// <summary>
+            /// Continues the ring that memory already holds, e.g. from an earlier writer in the
+            /// same mapping, or formats it as an empty ring with as many records as fit.
+            /// </summary>
+            SeqlockRingWriter(void* memory, size_t bytes) :
+                header(static_cast<SeqlockRing::Header*>(memory)),
+                records(reinterpret_cast<SeqlockRing::Record*>(static_cast<SeqlockRing::Header*>(memory) + 1)),
+                next(0)
+            {
+                uint32_t capacity = static_cast<uint32_t>((bytes - sizeof(SeqlockRing::Header)) / sizeof(SeqlockRing::Record));
+                if (header->Magic.load(std::memory_order_acquire) == SeqlockRing::Magic &&
+                    header->Version == SeqlockRing::Version &&
+                    header->RecordSize == sizeof(SeqlockRing::Record) &&
+                    header->Capacity == capacity)
+                {
+                    next = header->Published.load(std::memory_order_relaxed);
+                    return;
+                }
+
+                header->Magic.store(0, std::memory_order_relaxed);
+                header->Capacity = capacity;
+                header->RecordSize = sizeof(SeqlockRing::Record);
+                header->Version = SeqlockRing::Version;
+                header->Published.store(0, std::memory_order_relaxed);
+                for (uint32_t i = 0; i < header->Capacity; ++i)
+                {
+                    records[i].Sequence.store(0, std::memory_order_relaxed);
+                }
+                // readers check the magic first
+                header->Magic.store(SeqlockRing::Magic, std::memory_order_release);
+            }
+
+            void Publish(const SensorSample& sample)
+            {
+                SeqlockRing::Record& record = records[next % header->Capacity];
+                record.Sequence.store(2 * next + 1, std::memory_order_relaxed);
+                // the odd sequence is visible before any of the new words
+                std::atomic_thread_fence(std::memory_order_release);
+
+                record.Timestamp.store(static_cast<uint64_t>(sample.Timestamp), std::memory_order_relaxed);
+                record.X.store(SeqlockRing::Bits(sample.X), std::memory_order_relaxed);
+                record.Y.store(SeqlockRing::Bits(sample.Y), std::memory_order_relaxed);
+                record.Z.store(SeqlockRing::Bits(sample.Z), std::memory_order_relaxed);
+
+                record.Sequence.store(2 * next + 2, std::memory_order_release);
+                header->Published.store(++next, std::memory_order_release);
+            }
+
+        private:
+            SeqlockRing::Header* header;
+            SeqlockRing::Record* records;
+            uint64_t next;
+        };
+
+        /// <summary>
+        /// One reader of a SeqlockRing, typically in another process with the memory mapped read
+        /// only.  Poll reads the records published since the last call straight out of the
+        /// shared memory, without system calls or locks, and counts the records that the writer
+        /// overwrote before they were read in Lost.
+        /// </summary>
+        class SeqlockRingReader
+        {
+        public:
+            /// <summary>
+            /// Starts at the newest record.  Valid is false when memory does not hold a ring.
+            /// </summary>
+            SeqlockRingReader(const void* memory, size_t bytes) :
+                header(static_cast<const SeqlockRing::Header*>(memory)),
+                records(reinterpret_cast<const SeqlockRing::Record*>(static_cast<const SeqlockRing::Header*>(memory) + 1)),
+                next(0),
+                lost(0)
+            {
+                valid = bytes >= sizeof(SeqlockRing::Header) &&
+                    header->Magic.load(std::memory_order_acquire) == SeqlockRing::Magic &&
+                    header->Version == SeqlockRing::Version &&
+                    header->RecordSize == sizeof(SeqlockRing::Record) &&
+                    header->Capacity != 0 &&
+                    SeqlockRing::Bytes(header->Capacity) <= bytes;
+                if (valid)
+                {
+                    next = header->Published.load(std::memory_order_acquire);
+                }
+            }
+
+            bool Valid() const
+            {
+                return valid;
+            }
+
+            unsigned long long Lost() const
+            {
+                return lost;
+            }
+
+            /// <summary>
+            /// Calls consume(const SensorSample&amp;) for each new record and returns how many
+            /// there were.  Received is set to the time of the call.
+            /// </summary>
+            template<class Consume>
+            size_t Poll(Consume consume)
+            {
+                if (!valid)
+                {
+                    return 0;
+                }
+                uint64_t published = header->Published.load(std::memory_order_acquire);
+                uint64_t capacity = header->Capacity;
+                if (published - next > capacity)
+                {
+                    lost += published - capacity - next;
+                    next = published - capacity;
+                }
+
+                size_t count = 0;
+                auto received = SensorSample::clock::now();
+                for (; next < published; ++next)
+                {
+                    SensorSample sample;
+                    if (!Read(records[next % capacity], next, sample))
+                    {
+                        // overwritten while we were reading, skip whatever the writer has lapped since
+                        ++lost;
+                        uint64_t latest = header->Published.load(std::memory_order_acquire);
+                        if (latest - next > capacity)
+                        {
+                            lost += latest - capacity - next - 1;
+                            next = latest - capacity - 1;
+                        }
+                        continue;
+                    }
+                    sample.Received = received;
+                    consume(sample);
+                    ++count;
+                }
+                return count;
+            }
+
+        private:
+            // false when the slot no longer holds record index
+            static bool Read(const SeqlockRing::Record& record, uint64_t index, SensorSample& sample)
+            {
+                uint64_t sequence = 2 * index + 2;
+                if (record.Sequence.load(std::memory_order_acquire) != sequence)
+                {
+                    return false;
+                }
+                sample.Timestamp = static_cast<long long>(record.Timestamp.load(std::memory_order_relaxed));
+                sample.X = SeqlockRing::Value(record.X.load(std::memory_order_relaxed));
+                sample.Y = SeqlockRing::Value(record.Y.load(std::memory_order_relaxed));
+                sample.Z = SeqlockRing::Value(record.Z.load(std::memory_order_relaxed));
+                // the words are read before the sequence is checked again
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return record.Sequence.load(std::memory_order_relaxed) == sequence;
+            }
+
+            const SeqlockRing::Header* header;
+            const SeqlockRing::Record* records;
+            bool valid;
+            uint64_t next;
+            unsigned long long lost;
+        };
+    }
+}
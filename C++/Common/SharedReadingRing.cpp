@@ -0,0 +1,51 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SharedReadingRing.cpp
+// Implementation of the SharedReadingRing class
+//
+
+#include "pch.h"
+#include "SharedReadingRing.h"
+
+using namespace SDKSample::Common;
+
+SharedReadingRing::SharedReadingRing(const wchar_t* name, uint32_t capacity) :
+    mapping(nullptr),
+    view(nullptr)
+{
+    size_t bytes = SeqlockRing::Bytes(capacity);
+    mapping = CreateFileMappingFromApp(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, bytes, name);
+    if (mapping == nullptr)
+    {
+        return;
+    }
+
+    view = MapViewOfFileFromApp(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, bytes);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return;
+    }
+
+    // a new mapping is zeroed, an existing one is continued
+    writer.reset(new SeqlockRingWriter(view, bytes));
+}
+
+SharedReadingRing::~SharedReadingRing()
+{
+    writer.reset();
+    if (view != nullptr)
+    {
+        UnmapViewOfFile(view);
+    }
+    if (mapping != nullptr)
+    {
+        CloseHandle(mapping);
+    }
+}
@@ -0,0 +1,63 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SharedReadingRing.h
+// Declaration of the SharedReadingRing class
+//
+
+#pragma once
+
+#include "SeqlockRing.h"
+
+#include <memory>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Publishes readings into a named shared memory SeqlockRing so that other processes
+        /// can follow the stream without opening the sensor themselves.  Readers open the
+        /// mapping read only and use SeqlockRingReader.  The mapping is created inside the app
+        /// container, so a reader outside the package opens it by its full
+        /// AppContainerNamedObjects path and needs to be granted access to it.
+        /// </summary>
+        class SharedReadingRing
+        {
+        public:
+            SharedReadingRing(const wchar_t* name, uint32_t capacity);
+            ~SharedReadingRing();
+
+            /// <summary>
+            /// False when the mapping could not be created; Publish does nothing then.
+            /// </summary>
+            bool Valid() const
+            {
+                return writer != nullptr;
+            }
+
+            /// <summary>
+            /// Called by one thread at a time.
+            /// </summary>
+            void Publish(const SensorSample& sample)
+            {
+                if (writer != nullptr)
+                {
+                    writer->Publish(sample);
+                }
+            }
+
+        private:
+            SharedReadingRing(const SharedReadingRing&);
+            SharedReadingRing& operator=(const SharedReadingRing&);
+
+            void* mapping;
+            void* view;
+            std::unique_ptr<SeqlockRingWriter> writer;
+        };
+    }
+}
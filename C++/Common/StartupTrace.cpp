@@ -0,0 +1,65 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// StartupTrace.cpp
+// Implementation of the StartupTrace class
+//
+
+#include "pch.h"
+#include "StartupTrace.h"
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef std::chrono::steady_clock clock;
+
+    struct Phase
+    {
+        const wchar_t* Name;
+        clock::time_point Time;
+    };
+
+    std::mutex lock;
+    Phase phases[StartupTrace::MaximumPhases];
+    size_t count = 0;
+
+    double Milliseconds(clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000.0;
+    }
+}
+
+void StartupTrace::Mark(const wchar_t* phase)
+{
+    auto now = clock::now();
+    std::lock_guard<std::mutex> guard(lock);
+    if (count < MaximumPhases)
+    {
+        phases[count].Name = phase;
+        phases[count].Time = now;
+        ++count;
+    }
+}
+
+std::wstring StartupTrace::Report()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    std::wostringstream out;
+    for (size_t i = 0; i < count; ++i)
+    {
+        out << L"Startup " << phases[i].Name
+            << L": " << Milliseconds(phases[i].Time - phases[0].Time) << L"ms"
+            << L" (+" << Milliseconds(phases[i].Time - phases[i != 0 ? i - 1 : 0].Time) << L"ms)"
+            << L"\n";
+    }
+    return out.str();
+}
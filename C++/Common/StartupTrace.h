@@ -0,0 +1,41 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// StartupTrace.h
+// Declaration of the StartupTrace class
+//
+
+#pragma once
+
+#include <string>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Timestamps of the phases of app startup, relative to the first phase that was marked.
+        /// Only the first MaximumPhases marks are kept, so marking stays cheap once the app is
+        /// running.  Safe to call from any thread.
+        /// </summary>
+        class StartupTrace
+        {
+        public:
+            static const size_t MaximumPhases = 32;
+
+            /// <summary>
+            /// phase is not copied, pass a string literal.
+            /// </summary>
+            static void Mark(const wchar_t* phase);
+
+            /// <summary>
+            /// One line per phase with the time since the first phase and since the previous one.
+            /// </summary>
+            static std::wstring Report();
+        };
+    }
+}
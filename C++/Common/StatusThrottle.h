@@ -0,0 +1,261 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// StatusThrottle.h
+// Declaration of the StatusThrottle class
+//
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Decides which status messages reach the screen, so that a failure reported on every
+        /// reading does not rewrite the status bar at the sensor rate.  Each class keeps one
+        /// waiting message: a message that repeats the one shown or the one waiting in its class
+        /// is coalesced, and a newer message of the class replaces the one waiting.  A message
+        /// of a class is shown no sooner than the interval of the class after the last one of
+        /// that class, so a throttled class does not hold back the others.  Messages can be
+        /// posted from any thread; they are taken by flushes on one thread, typically once per
+        /// frame on the ui thread, and Post and Take say when the next flush is due.  Times are
+        /// in 100ns units on any clock, so the throttle can run on virtual time.
+        /// </summary>
+        class StatusThrottle
+        {
+        public:
+            struct Status
+            {
+                unsigned int Class;
+                std::wstring Text;
+                // messages coalesced or replaced since the previous status was shown
+                unsigned long long Suppressed;
+            };
+
+            StatusThrottle(unsigned int classes, long long interval) :
+                classes(classes),
+                shown(false),
+                sequence(0),
+                flushScheduled(false),
+                flushAt(0),
+                posted(0),
+                displayed(0),
+                coalesced(0),
+                replaced(0),
+                suppressedSinceShown(0)
+            {
+                for (auto& state : this->classes)
+                {
+                    state.Interval = interval;
+                    state.EverShown = false;
+                    state.ShownAt = 0;
+                    state.Pending = false;
+                    state.Sequence = 0;
+                }
+            }
+
+            void SetInterval(unsigned int messageClass, long long interval)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                classes[messageClass].Interval = interval;
+            }
+
+            /// <summary>
+            /// Posts a message at now.  Returns true when a flush has to be scheduled after
+            /// delay, which is the case when no flush is scheduled yet, or only one that is due
+            /// later than this message.
+            /// </summary>
+            bool Post(long long now, unsigned int messageClass, const std::wstring& text, long long& delay)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ++posted;
+                delay = 0;
+                ClassState& state = classes[messageClass];
+                if (state.Pending)
+                {
+                    if (state.Waiting == text)
+                    {
+                        ++coalesced;
+                    }
+                    else
+                    {
+                        ++replaced;
+                        state.Waiting = text;
+                        state.Sequence = ++sequence;
+                    }
+                    ++suppressedSinceShown;
+                    return false;
+                }
+                if (shown && last.Class == messageClass && last.Text == text)
+                {
+                    ++coalesced;
+                    ++suppressedSinceShown;
+                    return false;
+                }
+                state.Pending = true;
+                state.Waiting = text;
+                state.Sequence = ++sequence;
+
+                long long due = DueAt(state, now);
+                if (flushScheduled && flushAt <= due)
+                {
+                    return false;
+                }
+                flushScheduled = true;
+                flushAt = due;
+                delay = due - now;
+                return true;
+            }
+
+            /// <summary>
+            /// Takes the newest waiting message whose class may be shown at now; older messages
+            /// of other classes that are due as well are dropped, since the status bar shows
+            /// only one.  Returns false when there is nothing to show yet.  retry is the delay
+            /// until the next flush has to run, or 0 when none has to be scheduled because no
+            /// message is waiting or a flush is already scheduled in time.
+            /// </summary>
+            bool Take(long long now, Status& status, long long& retry)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                retry = 0;
+                if (flushScheduled && flushAt <= now)
+                {
+                    flushScheduled = false;
+                }
+
+                ClassState* newest = nullptr;
+                for (auto& state : classes)
+                {
+                    if (state.Pending && DueAt(state, now) <= now && (newest == nullptr || state.Sequence > newest->Sequence))
+                    {
+                        newest = &state;
+                    }
+                }
+                if (newest != nullptr)
+                {
+                    for (auto& state : classes)
+                    {
+                        if (&state != newest && state.Pending && DueAt(state, now) <= now)
+                        {
+                            state.Pending = false;
+                            ++replaced;
+                            ++suppressedSinceShown;
+                        }
+                    }
+                    newest->Pending = false;
+                    newest->EverShown = true;
+                    newest->ShownAt = now;
+                    ++displayed;
+                    shown = true;
+                    last.Class = static_cast<unsigned int>(newest - &classes[0]);
+                    last.Text = newest->Waiting;
+                    status.Class = last.Class;
+                    status.Text = last.Text;
+                    status.Suppressed = suppressedSinceShown;
+                    suppressedSinceShown = 0;
+                }
+
+                // the flush for the waiting message that is due first
+                bool waiting = false;
+                long long next = 0;
+                for (auto& state : classes)
+                {
+                    if (state.Pending && (!waiting || DueAt(state, now) < next))
+                    {
+                        waiting = true;
+                        next = DueAt(state, now);
+                    }
+                }
+                if (waiting && (!flushScheduled || next < flushAt))
+                {
+                    flushScheduled = true;
+                    flushAt = next;
+                    retry = next - now;
+                }
+                return newest != nullptr;
+            }
+
+            unsigned long long Posted() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return posted;
+            }
+
+            unsigned long long Shown() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return displayed;
+            }
+
+            unsigned long long Suppressed() const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                return coalesced + replaced;
+            }
+
+            std::wstring Report(const std::wstring& name) const
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                std::wostringstream out;
+                out << name
+                    << L": posted=" << posted
+                    << L" shown=" << displayed
+                    << L" coalesced=" << coalesced
+                    << L" replaced=" << replaced
+                    << L"\n";
+                return out.str();
+            }
+
+        private:
+            StatusThrottle(const StatusThrottle&);
+            StatusThrottle& operator=(const StatusThrottle&);
+
+            struct ClassState
+            {
+                long long Interval;
+                bool EverShown;
+                long long ShownAt;
+                bool Pending;
+                std::wstring Waiting;
+                // orders the waiting messages of all classes by when they were posted
+                unsigned long long Sequence;
+            };
+
+            struct Message
+            {
+                unsigned int Class;
+                std::wstring Text;
+            };
+
+            // the first time at or after now that a message of the class may be shown
+            static long long DueAt(const ClassState& state, long long now)
+            {
+                return state.EverShown ? (std::max)(now, state.ShownAt + state.Interval) : now;
+            }
+
+            mutable std::mutex lock;
+            std::vector<ClassState> classes;
+            bool shown;
+            Message last;
+            unsigned long long sequence;
+            bool flushScheduled;
+            long long flushAt;
+            unsigned long long posted;
+            unsigned long long displayed;
+            unsigned long long coalesced;
+            unsigned long long replaced;
+            unsigned long long suppressedSinceShown;
+        };
+    }
+}
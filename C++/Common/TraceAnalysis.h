@@ -0,0 +1,354 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceAnalysis.h
+// Declaration of the TraceAnalyzer class
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "WindowedStatistics.h"
+#include "BurstAggregator.h"
+#include "ProcessingGraph.h"
+
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        struct TraceAnalysisOptions
+        {
+            // readings per sliding window
+            size_t Window;
+            // weight of the newest reading in the smoothed magnitude, as for ExponentialStatistics
+            double SmoothingWeight;
+            // a reading whose magnitude is this far from 1g is a shake
+            double ShakeThreshold;
+            // shakes less than this apart, in 100ns units, are one gesture
+            long long ShakeGap;
+            // the number of time ranges the trace is split into
+            size_t Partitions;
+        };
+
+        struct TraceAnalysis
+        {
+            Statistics X;
+            Statistics Y;
+            Statistics Z;
+            Statistics Magnitude;
+            // the loudest full window and the timestamp of its last reading
+            double PeakWindowRms;
+            long long PeakWindowEnd;
+            // the peak of the exponentially smoothed magnitude and when it was reached
+            double PeakSmoothedMagnitude;
+            long long PeakSmoothedAt;
+            std::vector<ShakeGesture> Gestures;
+        };
+
+        /// <summary>
+        /// Analyzes a recorded trace with the operators of the scenario pipelines, split by time
+        /// into Partitions ranges that are analyzed in parallel on a WorkerPool.  Each range
+        /// hands its stateful operators the state they would have had from the ranges before it:
+        /// - the sliding window replays the Window - 1 readings before the range, so each full
+        ///   window is the same as in a single pass;
+        /// - the smoothed magnitude replays readings before the range until the weight of the
+        ///   older ones falls below 1e-12, so it matches a single pass within 1e-12 of the range
+        ///   of the magnitude;
+        /// - shake gestures are cut at the range boundaries and the ones that are less than
+        ///   ShakeGap apart across a boundary are joined again when merging.
+        /// The ranges are merged in time order, so the result depends on the trace and
+        /// Partitions but not on the number of threads or their timing.
+        /// </summary>
+        class TraceAnalyzer
+        {
+        public:
+            explicit TraceAnalyzer(const TraceAnalysisOptions& options) : options(options)
+            {
+            }
+
+            /// <summary>
+            /// Analyzes count readings in timestamp order and waits for the result.  A reading is
+            /// anything with Timestamp, X, Y and Z, e.g. a SensorSample, or a TraceFile::Record
+            /// read in place from a mapped trace file.
+            /// </summary>
+            template<class Reading>
+            TraceAnalysis Run(const Reading* readings, size_t count, WorkerPool& pool) const
+            {
+                size_t partitions = options.Partitions != 0 ? options.Partitions : 1;
+                partitions = count != 0 && partitions > count ? count : partitions;
+                std::vector<Partition> results(partitions);
+
+                std::mutex lock;
+                std::condition_variable finished;
+                size_t remaining = partitions;
+                for (size_t p = 0; p < partitions; ++p)
+                {
+                    size_t begin = count / partitions * p + (p < count % partitions ? p : count % partitions);
+                    size_t end = begin + count / partitions + (p < count % partitions ? 1 : 0);
+                    Partition* result = &results[p];
+                    pool.Post([=, &lock, &finished, &remaining]()
+                    {
+                        Analyze(readings, begin, end, *result);
+                        std::lock_guard<std::mutex> guard(lock);
+                        if (--remaining == 0)
+                        {
+                            finished.notify_one();
+                        }
+                    });
+                }
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    finished.wait(guard, [&]()
+                    {
+                        return remaining == 0;
+                    });
+                }
+
+                return Merge(results);
+            }
+
+            static std::wstring Report(const std::wstring& name, const TraceAnalysis& analysis)
+            {
+                std::wostringstream out;
+                out << name
+                    << L": readings=" << analysis.Magnitude.Count
+                    << L" magnitude mean=" << analysis.Magnitude.Mean
+                    << L" rms=" << analysis.Magnitude.Rms
+                    << L" peak=" << analysis.Magnitude.Maximum
+                    << L" peak window rms=" << analysis.PeakWindowRms
+                    << L" peak smoothed=" << analysis.PeakSmoothedMagnitude
+                    << L" gestures=" << analysis.Gestures.size()
+                    << L"\n";
+                return out.str();
+            }
+
+        private:
+            /// <summary>
+            /// Count, mean, sum of squared differences, minimum and maximum, which merge exactly
+            /// in any grouping.
+            /// </summary>
+            struct Moments
+            {
+                size_t Count;
+                double Mean;
+                double M2;
+                double Minimum;
+                double Maximum;
+
+                Moments() : Count(0), Mean(0.0), M2(0.0), Minimum(0.0), Maximum(0.0)
+                {
+                }
+
+                void Add(double value)
+                {
+                    if (Count == 0)
+                    {
+                        Minimum = value;
+                        Maximum = value;
+                    }
+                    ++Count;
+                    double delta = value - Mean;
+                    Mean += delta / Count;
+                    M2 += delta * (value - Mean);
+                    Minimum = value < Minimum ? value : Minimum;
+                    Maximum = value > Maximum ? value : Maximum;
+                }
+
+                void Merge(const Moments& other)
+                {
+                    if (other.Count == 0)
+                    {
+                        return;
+                    }
+                    if (Count == 0)
+                    {
+                        *this = other;
+                        return;
+                    }
+                    double total = static_cast<double>(Count + other.Count);
+                    double delta = other.Mean - Mean;
+                    Mean += delta * other.Count / total;
+                    M2 += other.M2 + delta * delta * (static_cast<double>(Count) * other.Count / total);
+                    Count += other.Count;
+                    Minimum = other.Minimum < Minimum ? other.Minimum : Minimum;
+                    Maximum = other.Maximum > Maximum ? other.Maximum : Maximum;
+                }
+
+                Statistics Current() const
+                {
+                    Statistics statistics = {Count, Mean, 0.0, 0.0, Minimum, Maximum};
+                    if (Count != 0)
+                    {
+                        statistics.Variance = M2 / Count;
+                        statistics.Rms = std::sqrt(statistics.Variance + Mean * Mean);
+                    }
+                    return statistics;
+                }
+            };
+
+            struct Partition
+            {
+                Moments Axes[3];
+                Moments Magnitude;
+                bool HasWindow;
+                double PeakWindowRms;
+                long long PeakWindowEnd;
+                bool HasSmoothed;
+                double PeakSmoothedMagnitude;
+                long long PeakSmoothedAt;
+                std::vector<ShakeGesture> Gestures;
+            };
+
+            template<class Reading>
+            static double MagnitudeOf(const Reading& sample)
+            {
+                return std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+            }
+
+            template<class Reading>
+            void Analyze(const Reading* readings, size_t begin, size_t end, Partition& result) const
+            {
+                result.HasWindow = false;
+                result.PeakWindowRms = 0.0;
+                result.PeakWindowEnd = 0;
+                result.HasSmoothed = false;
+                result.PeakSmoothedMagnitude = 0.0;
+                result.PeakSmoothedAt = 0;
+
+                // replay what the stateful operators need from before the range
+                size_t window = options.Window != 0 ? options.Window : 1;
+                SlidingStatistics sliding(window);
+                size_t windowStart = begin >= window - 1 ? begin - (window - 1) : 0;
+                for (size_t i = windowStart; i < begin; ++i)
+                {
+                    sliding.Push(MagnitudeOf(readings[i]));
+                }
+
+                ExponentialStatistics smoothed(options.SmoothingWeight);
+                size_t warmup = begin;
+                if (options.SmoothingWeight > 0.0 && options.SmoothingWeight < 1.0)
+                {
+                    double needed = std::ceil(std::log(1e-12) / std::log(1.0 - options.SmoothingWeight));
+                    warmup = needed < static_cast<double>(begin) ? static_cast<size_t>(needed) : begin;
+                }
+                for (size_t i = begin - warmup; i < begin; ++i)
+                {
+                    smoothed.Push(MagnitudeOf(readings[i]));
+                }
+
+                BurstAggregator shakes(options.ShakeGap);
+                ShakeGesture gesture;
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const Reading& sample = readings[i];
+                    double magnitude = MagnitudeOf(sample);
+                    result.Axes[0].Add(sample.X);
+                    result.Axes[1].Add(sample.Y);
+                    result.Axes[2].Add(sample.Z);
+                    result.Magnitude.Add(magnitude);
+
+                    sliding.Push(magnitude);
+                    Statistics current = sliding.Current();
+                    if (current.Count == window && (!result.HasWindow || current.Rms > result.PeakWindowRms))
+                    {
+                        result.HasWindow = true;
+                        result.PeakWindowRms = current.Rms;
+                        result.PeakWindowEnd = sample.Timestamp;
+                    }
+
+                    smoothed.Push(magnitude);
+                    double mean = smoothed.Current().Mean;
+                    if (!result.HasSmoothed || mean > result.PeakSmoothedMagnitude)
+                    {
+                        result.HasSmoothed = true;
+                        result.PeakSmoothedMagnitude = mean;
+                        result.PeakSmoothedAt = sample.Timestamp;
+                    }
+
+                    if (std::fabs(magnitude - 1.0) > options.ShakeThreshold && shakes.Add(sample.Timestamp, magnitude, gesture))
+                    {
+                        gesture.Completed = ShakeGesture::clock::time_point();
+                        result.Gestures.push_back(gesture);
+                    }
+                }
+                // close the last gesture, the next range joins it again if it continues
+                if (end > begin && shakes.Flush(readings[end - 1].Timestamp + options.ShakeGap, gesture))
+                {
+                    gesture.Completed = ShakeGesture::clock::time_point();
+                    result.Gestures.push_back(gesture);
+                }
+            }
+
+            TraceAnalysis Merge(const std::vector<Partition>& partitions) const
+            {
+                Moments axes[3];
+                Moments magnitude;
+                TraceAnalysis analysis;
+                analysis.PeakWindowRms = 0.0;
+                analysis.PeakWindowEnd = 0;
+                analysis.PeakSmoothedMagnitude = 0.0;
+                analysis.PeakSmoothedAt = 0;
+                bool hasWindow = false;
+                bool hasSmoothed = false;
+
+                // in time order, with ties going to the earliest as in a single pass
+                for (auto& partition : partitions)
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        axes[i].Merge(partition.Axes[i]);
+                    }
+                    magnitude.Merge(partition.Magnitude);
+
+                    if (partition.HasWindow && (!hasWindow || partition.PeakWindowRms > analysis.PeakWindowRms))
+                    {
+                        hasWindow = true;
+                        analysis.PeakWindowRms = partition.PeakWindowRms;
+                        analysis.PeakWindowEnd = partition.PeakWindowEnd;
+                    }
+                    if (partition.HasSmoothed && (!hasSmoothed || partition.PeakSmoothedMagnitude > analysis.PeakSmoothedMagnitude))
+                    {
+                        hasSmoothed = true;
+                        analysis.PeakSmoothedMagnitude = partition.PeakSmoothedMagnitude;
+                        analysis.PeakSmoothedAt = partition.PeakSmoothedAt;
+                    }
+
+                    for (size_t g = 0; g < partition.Gestures.size(); ++g)
+                    {
+                        const ShakeGesture& next = partition.Gestures[g];
+                        if (g == 0 && !analysis.Gestures.empty() && next.Start - analysis.Gestures.back().End < options.ShakeGap)
+                        {
+                            // a gesture that was cut by the boundary
+                            ShakeGesture& joined = analysis.Gestures.back();
+                            joined.Events += next.Events;
+                            joined.End = next.End;
+                            joined.PeakIntensity = next.PeakIntensity > joined.PeakIntensity ? next.PeakIntensity : joined.PeakIntensity;
+                            continue;
+                        }
+                        analysis.Gestures.push_back(next);
+                    }
+                }
+
+                analysis.X = axes[0].Current();
+                analysis.Y = axes[1].Current();
+                analysis.Z = axes[2].Current();
+                analysis.Magnitude = magnitude.Current();
+                return analysis;
+            }
+
+            TraceAnalysisOptions options;
+        };
+    }
+}
@@ -0,0 +1,417 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceFile.h
+// Declaration of the trace file format and the TraceFileWriter and TraceFileReader classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+#include "TraceIndex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// A recorded trace, laid out so that it can be mapped and read in place:
+        /// - a TraceFileHeader of 64 bytes;
+        /// - Count TraceRecords of 32 bytes in timestamp order, in blocks of BlockReadings;
+        /// - at IndexOffset, a TraceFileBlock summary of each block, in block order.
+        /// Integers and doubles are stored little-endian, as on every platform the app runs on.
+        /// </summary>
+        namespace TraceFile
+        {
+            // "ACTR"
+            const uint32_t Magic = 0x52544341;
+            const uint32_t Version = 1;
+
+            struct Header
+            {
+                uint32_t Magic;
+                uint32_t Version;
+                uint32_t BlockReadings;
+                uint32_t Reserved;
+                uint64_t Count;
+                uint64_t Blocks;
+                uint64_t IndexOffset;
+                uint64_t Unused[3];
+            };
+
+            struct Record
+            {
+                int64_t Timestamp;
+                double X;
+                double Y;
+                double Z;
+            };
+
+            // BlockSummary with fixed-size fields
+            struct Block
+            {
+                int64_t First;
+                int64_t Last;
+                uint64_t Count;
+                double Minimum[3];
+                double Maximum[3];
+                double Sum[3];
+                double MaximumMagnitude;
+                double SumOfSquares;
+            };
+
+            static_assert(sizeof(Header) == 64, "the trace header is 64 bytes");
+            static_assert(sizeof(Record) == 32, "a trace record is 32 bytes");
+            static_assert(sizeof(Block) == 112, "a trace block summary is 112 bytes");
+
+            inline Block ToBlock(const BlockSummary& summary)
+            {
+                Block block;
+                block.First = summary.First;
+                block.Last = summary.Last;
+                block.Count = summary.Count;
+                for (int i = 0; i < 3; ++i)
+                {
+                    block.Minimum[i] = summary.Minimum[i];
+                    block.Maximum[i] = summary.Maximum[i];
+                    block.Sum[i] = summary.Sum[i];
+                }
+                block.MaximumMagnitude = summary.MaximumMagnitude;
+                block.SumOfSquares = summary.SumOfSquares;
+                return block;
+            }
+
+            inline BlockSummary ToSummary(const Block& block)
+            {
+                BlockSummary summary;
+                summary.First = block.First;
+                summary.Last = block.Last;
+                summary.Count = static_cast<size_t>(block.Count);
+                for (int i = 0; i < 3; ++i)
+                {
+                    summary.Minimum[i] = block.Minimum[i];
+                    summary.Maximum[i] = block.Maximum[i];
+                    summary.Sum[i] = block.Sum[i];
+                }
+                summary.MaximumMagnitude = block.MaximumMagnitude;
+                summary.SumOfSquares = block.SumOfSquares;
+                return summary;
+            }
+        }
+
+        /// <summary>
+        /// Records readings to a trace file as they arrive.  The summary of each block is built
+        /// while its readings are written, and the index is written after the readings by
+        /// Close, which completes the file.  Readings must arrive in timestamp order; Append
+        /// drops one that is older than the previous.
+        /// </summary>
+        class TraceFileWriter
+        {
+        public:
+            TraceFileWriter(const std::string& path, uint32_t blockReadings) :
+                file(path.c_str(), std::ios::binary | std::ios::trunc),
+                blockReadings(blockReadings != 0 ? blockReadings : 1),
+                count(0),
+                dropped(0)
+            {
+                current.Reset();
+                TraceFile::Header header = {};
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            }
+
+            ~TraceFileWriter()
+            {
+                Close();
+            }
+
+            /// <summary>
+            /// False when the file could not be created or written.
+            /// </summary>
+            bool Valid() const
+            {
+                return file.good();
+            }
+
+            bool Append(const SensorSample& sample)
+            {
+                if (count != 0 && sample.Timestamp < current.Last)
+                {
+                    ++dropped;
+                    return false;
+                }
+                TraceFile::Record record = {sample.Timestamp, sample.X, sample.Y, sample.Z};
+                file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                current.Add(sample);
+                ++count;
+                if (current.Count == blockReadings)
+                {
+                    blocks.push_back(TraceFile::ToBlock(current));
+                    BlockSummary last = current;
+                    current.Reset();
+                    // keeps the order check across the block boundary
+                    current.Last = last.Last;
+                }
+                return true;
+            }
+
+            unsigned long long Count() const
+            {
+                return count;
+            }
+
+            unsigned long long Dropped() const
+            {
+                return dropped;
+            }
+
+            /// <summary>
+            /// Writes the index and the header and closes the file.  Returns false when the file
+            /// is not complete.  Later calls do nothing.
+            /// </summary>
+            bool Close()
+            {
+                if (!file.is_open())
+                {
+                    return false;
+                }
+                if (current.Count != 0)
+                {
+                    blocks.push_back(TraceFile::ToBlock(current));
+                    current.Reset();
+                }
+                TraceFile::Header header = {};
+                header.Magic = TraceFile::Magic;
+                header.Version = TraceFile::Version;
+                header.BlockReadings = blockReadings;
+                header.Count = count;
+                header.Blocks = blocks.size();
+                header.IndexOffset = sizeof(TraceFile::Header) + count * sizeof(TraceFile::Record);
+                if (!blocks.empty())
+                {
+                    file.write(reinterpret_cast<const char*>(&blocks[0]), blocks.size() * sizeof(TraceFile::Block));
+                }
+                file.seekp(0);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                bool written = file.good();
+                file.close();
+                return written;
+            }
+
+        private:
+            TraceFileWriter(const TraceFileWriter&);
+            TraceFileWriter& operator=(const TraceFileWriter&);
+
+            std::ofstream file;
+            uint32_t blockReadings;
+            unsigned long long count;
+            unsigned long long dropped;
+            BlockSummary current;
+            std::vector<TraceFile::Block> blocks;
+        };
+
+        /// <summary>
+        /// Reads a trace file in memory that the caller mapped, e.g. with mmap or
+        /// MapViewOfFile, and must keep mapped for the life of the reader.  The block summaries
+        /// are loaded into a TraceIndex, so queries skip the blocks that their summaries answer
+        /// or rule out and touch only the pages of the blocks they have to read.
+        /// </summary>
+        class TraceFileReader
+        {
+        public:
+            TraceFileReader(const void* memory, size_t bytes) :
+                records(nullptr),
+                count(0),
+                blockReadings(0)
+            {
+                TraceFile::Header header;
+                if (bytes < sizeof(header))
+                {
+                    return;
+                }
+                std::memcpy(&header, memory, sizeof(header));
+                uint64_t recordBytes = header.Count * sizeof(TraceFile::Record);
+                if (header.Magic != TraceFile::Magic || header.Version != TraceFile::Version || header.BlockReadings == 0 ||
+                    header.Count > bytes / sizeof(TraceFile::Record) ||
+                    header.Blocks != (header.Count + header.BlockReadings - 1) / header.BlockReadings ||
+                    header.IndexOffset != sizeof(header) + recordBytes || header.IndexOffset > bytes ||
+                    header.Blocks > (bytes - header.IndexOffset) / sizeof(TraceFile::Block))
+                {
+                    return;
+                }
+                const char* base = static_cast<const char*>(memory);
+                const char* blocks = base + header.IndexOffset;
+                for (uint64_t i = 0; i < header.Blocks; ++i)
+                {
+                    TraceFile::Block block;
+                    std::memcpy(&block, blocks + i * sizeof(block), sizeof(block));
+                    index.Add(TraceFile::ToSummary(block));
+                }
+                records = reinterpret_cast<const TraceFile::Record*>(base + sizeof(header));
+                count = static_cast<size_t>(header.Count);
+                blockReadings = header.BlockReadings;
+            }
+
+            /// <summary>
+            /// False when the memory does not hold a complete trace file.
+            /// </summary>
+            bool Valid() const
+            {
+                return records != nullptr;
+            }
+
+            size_t Count() const
+            {
+                return count;
+            }
+
+            /// <summary>
+            /// The readings in place, in timestamp order.
+            /// </summary>
+            const TraceFile::Record* Readings() const
+            {
+                return records;
+            }
+
+            const TraceIndex& Index() const
+            {
+                return index;
+            }
+
+            /// <summary>
+            /// Calls visit(const SensorSample&amp;) for each reading of block number.
+            /// </summary>
+            template<class Visit>
+            void ReadBlock(unsigned long long number, Visit visit) const
+            {
+                size_t begin = static_cast<size_t>(number) * blockReadings;
+                size_t end = (std::min)(begin + blockReadings, count);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    visit(Sample(records[i]));
+                }
+            }
+
+            /// <summary>
+            /// Calls visit(const SensorSample&amp;) for each reading from begin to end inclusive, in
+            /// order, and returns how many there were.  Only the blocks that overlap the range
+            /// are read.
+            /// </summary>
+            template<class Visit>
+            size_t Query(long long begin, long long end, Visit visit) const
+            {
+                size_t visited = 0;
+                for (unsigned long long number = FirstBlockReaching(begin); number < index.EndBlock(); ++number)
+                {
+                    if (index.Block(number).First > end)
+                    {
+                        break;
+                    }
+                    ReadBlock(number, [&](const SensorSample& sample)
+                    {
+                        if (sample.Timestamp >= begin && sample.Timestamp <= end)
+                        {
+                            ++visited;
+                            visit(sample);
+                        }
+                    });
+                }
+                return visited;
+            }
+
+            /// <summary>
+            /// Finds the largest magnitude of the readings from begin to end inclusive.  Returns
+            /// false when there are none.
+            /// </summary>
+            bool MaximumMagnitude(long long begin, long long end, double& maximum) const
+            {
+                BlockRange read = {this, begin, end};
+                return index.MaximumMagnitude(begin, end, read, maximum);
+            }
+
+            /// <summary>
+            /// Calls visit(const BlockSummary&amp;) for each block whose RMS magnitude is above rms,
+            /// in order, and returns how many there were.  Reads no readings.
+            /// </summary>
+            template<class Visit>
+            size_t BlocksAbove(double rms, Visit visit) const
+            {
+                return index.BlocksAbove(rms, [&](unsigned long long, const BlockSummary& summary)
+                {
+                    visit(summary);
+                });
+            }
+
+        private:
+            // reads the part of a block from Begin to End, for the index, without a std::function
+            // call for each reading
+            struct BlockRange
+            {
+                const TraceFileReader* Reader;
+                long long Begin;
+                long long End;
+
+                template<class Visit>
+                void operator()(unsigned long long number, Visit visit) const
+                {
+                    const TraceFile::Record* first = Reader->records + static_cast<size_t>(number) * Reader->blockReadings;
+                    const TraceFile::Record* last = Reader->records + (std::min)((static_cast<size_t>(number) + 1) * Reader->blockReadings, Reader->count);
+                    long long begin = Begin;
+                    first = std::lower_bound(first, last, begin, [](const TraceFile::Record& record, long long timestamp)
+                    {
+                        return record.Timestamp < timestamp;
+                    });
+                    for (; first != last && first->Timestamp <= End; ++first)
+                    {
+                        visit(Sample(*first));
+                    }
+                }
+            };
+
+            static SensorSample Sample(const TraceFile::Record& record)
+            {
+                SensorSample sample;
+                sample.Timestamp = record.Timestamp;
+                sample.X = record.X;
+                sample.Y = record.Y;
+                sample.Z = record.Z;
+                sample.Received = SensorSample::clock::time_point();
+                return sample;
+            }
+
+            unsigned long long FirstBlockReaching(long long begin) const
+            {
+                unsigned long long low = 0;
+                unsigned long long high = index.EndBlock();
+                while (low < high)
+                {
+                    unsigned long long middle = low + (high - low) / 2;
+                    if (index.Block(middle).Last < begin)
+                    {
+                        low = middle + 1;
+                    }
+                    else
+                    {
+                        high = middle;
+                    }
+                }
+                return low;
+            }
+
+            const TraceFile::Record* records;
+            size_t count;
+            size_t blockReadings;
+            TraceIndex index;
+        };
+    }
+}
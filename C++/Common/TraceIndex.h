@@ -0,0 +1,324 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceIndex.h
+// Declaration of the BlockSummary and TraceIndex classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Summary of a block of readings: the time span, the range and sum of each axis, and
+        /// the peak and sum of squares of the magnitude.  Summaries merge, so a summary of
+        /// summaries describes all their readings.
+        /// </summary>
+        struct BlockSummary
+        {
+            long long First;
+            long long Last;
+            size_t Count;
+            double Minimum[3];
+            double Maximum[3];
+            double Sum[3];
+            double MaximumMagnitude;
+            double SumOfSquares;
+
+            void Reset()
+            {
+                First = 0;
+                Last = 0;
+                Count = 0;
+                for (int i = 0; i < 3; ++i)
+                {
+                    Minimum[i] = 0.0;
+                    Maximum[i] = 0.0;
+                    Sum[i] = 0.0;
+                }
+                MaximumMagnitude = 0.0;
+                SumOfSquares = 0.0;
+            }
+
+            void Add(const SensorSample& sample)
+            {
+                double axes[3] = {sample.X, sample.Y, sample.Z};
+                double squares = sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z;
+                double magnitude = std::sqrt(squares);
+                if (Count++ == 0)
+                {
+                    First = sample.Timestamp;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        Minimum[i] = axes[i];
+                        Maximum[i] = axes[i];
+                    }
+                    MaximumMagnitude = magnitude;
+                }
+                Last = sample.Timestamp;
+                for (int i = 0; i < 3; ++i)
+                {
+                    Minimum[i] = axes[i] < Minimum[i] ? axes[i] : Minimum[i];
+                    Maximum[i] = axes[i] > Maximum[i] ? axes[i] : Maximum[i];
+                    Sum[i] += axes[i];
+                }
+                MaximumMagnitude = magnitude > MaximumMagnitude ? magnitude : MaximumMagnitude;
+                SumOfSquares += squares;
+            }
+
+            void Merge(const BlockSummary& other)
+            {
+                if (other.Count == 0)
+                {
+                    return;
+                }
+                if (Count == 0)
+                {
+                    *this = other;
+                    return;
+                }
+                First = other.First < First ? other.First : First;
+                Last = other.Last > Last ? other.Last : Last;
+                Count += other.Count;
+                for (int i = 0; i < 3; ++i)
+                {
+                    Minimum[i] = other.Minimum[i] < Minimum[i] ? other.Minimum[i] : Minimum[i];
+                    Maximum[i] = other.Maximum[i] > Maximum[i] ? other.Maximum[i] : Maximum[i];
+                    Sum[i] += other.Sum[i];
+                }
+                MaximumMagnitude = other.MaximumMagnitude > MaximumMagnitude ? other.MaximumMagnitude : MaximumMagnitude;
+                SumOfSquares += other.SumOfSquares;
+            }
+
+            /// <summary>
+            /// The mean of the squared magnitude, whose root is the RMS magnitude.
+            /// </summary>
+            double MeanSquare() const
+            {
+                return Count != 0 ? SumOfSquares / Count : 0.0;
+            }
+        };
+
+        /// <summary>
+        /// Summaries of consecutive, time ordered blocks of a trace, with a second level that
+        /// summarizes each run of BlocksPerSuperblock blocks, so that a query over a long trace
+        /// skips whole superblocks and then whole blocks on their summaries, and only reads the
+        /// readings of the blocks it cannot answer from a summary.  Blocks are numbered in the
+        /// order they are added; the oldest can be dropped as a trace is trimmed.  Reading is
+        /// left to the caller, through read(number, visit), so a block can come from memory or
+        /// from a mapped file.
+        /// </summary>
+        class TraceIndex
+        {
+        public:
+            static const size_t BlocksPerSuperblock = 64;
+
+            TraceIndex() : first(0)
+            {
+            }
+
+            unsigned long long FirstBlock() const
+            {
+                return first;
+            }
+
+            unsigned long long EndBlock() const
+            {
+                return first + blocks.size();
+            }
+
+            const BlockSummary& Block(unsigned long long number) const
+            {
+                return blocks[static_cast<size_t>(number - first)];
+            }
+
+            /// <summary>
+            /// Adds the summary of block EndBlock().
+            /// </summary>
+            void Add(const BlockSummary& summary)
+            {
+                if (EndBlock() % BlocksPerSuperblock == 0)
+                {
+                    Superblock superblock;
+                    superblock.Summary.Reset();
+                    superblock.MaximumMeanSquare = 0.0;
+                    superblocks.push_back(superblock);
+                }
+                blocks.push_back(summary);
+                Include(superblocks.back(), summary);
+            }
+
+            /// <summary>
+            /// Drops block FirstBlock().
+            /// </summary>
+            void DropFront()
+            {
+                blocks.pop_front();
+                ++first;
+                if (first % BlocksPerSuperblock == 0)
+                {
+                    superblocks.pop_front();
+                    return;
+                }
+
+                // summarize what is left of the first superblock again
+                Superblock& superblock = superblocks.front();
+                superblock.Summary.Reset();
+                superblock.MaximumMeanSquare = 0.0;
+                size_t remaining = BlocksPerSuperblock - static_cast<size_t>(first % BlocksPerSuperblock);
+                for (size_t i = 0; i < remaining && i < blocks.size(); ++i)
+                {
+                    Include(superblock, blocks[i]);
+                }
+            }
+
+            /// <summary>
+            /// Finds the largest magnitude of the readings from begin to end inclusive.  Returns
+            /// false when there are none.  read(number, visit) has to call
+            /// visit(const SensorSample&amp;) for the readings of a block; it is only called for
+            /// blocks that are partly in the range and may still hold the maximum.
+            /// </summary>
+            template<class Read>
+            bool MaximumMagnitude(long long begin, long long end, Read read, double& maximum) const
+            {
+                bool found = false;
+                double best = 0.0;
+                for (size_t s = FirstSuperblockReaching(begin); s < superblocks.size(); ++s)
+                {
+                    const BlockSummary& summary = superblocks[s].Summary;
+                    if (summary.First > end)
+                    {
+                        break;
+                    }
+                    if (summary.Count == 0 || (found && summary.MaximumMagnitude <= best))
+                    {
+                        continue;
+                    }
+                    if (begin <= summary.First && summary.Last <= end)
+                    {
+                        best = summary.MaximumMagnitude;
+                        found = true;
+                        continue;
+                    }
+
+                    unsigned long long number = (std::max)(SuperblockStart(s), first);
+                    unsigned long long last = (std::min)(SuperblockStart(s + 1), EndBlock());
+                    for (; number < last; ++number)
+                    {
+                        const BlockSummary& block = Block(number);
+                        if (block.Last < begin || block.First > end || (found && block.MaximumMagnitude <= best))
+                        {
+                            continue;
+                        }
+                        if (begin <= block.First && block.Last <= end)
+                        {
+                            best = block.MaximumMagnitude;
+                            found = true;
+                            continue;
+                        }
+                        read(number, [&](const SensorSample& sample)
+                        {
+                            if (sample.Timestamp < begin || sample.Timestamp > end)
+                            {
+                                return;
+                            }
+                            double magnitude = std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+                            if (!found || magnitude > best)
+                            {
+                                best = magnitude;
+                                found = true;
+                            }
+                        });
+                    }
+                }
+                maximum = best;
+                return found;
+            }
+
+            /// <summary>
+            /// Calls visit(number, const BlockSummary&amp;) for each block whose RMS magnitude is
+            /// above rms, in order, and returns how many there were.  Needs no reads.
+            /// </summary>
+            template<class Visit>
+            size_t BlocksAbove(double rms, Visit visit) const
+            {
+                double meanSquare = rms * rms;
+                size_t count = 0;
+                for (size_t s = 0; s < superblocks.size(); ++s)
+                {
+                    if (superblocks[s].MaximumMeanSquare <= meanSquare)
+                    {
+                        continue;
+                    }
+                    unsigned long long last = (std::min)(SuperblockStart(s + 1), EndBlock());
+                    for (unsigned long long number = (std::max)(SuperblockStart(s), first); number < last; ++number)
+                    {
+                        const BlockSummary& block = Block(number);
+                        if (block.MeanSquare() > meanSquare)
+                        {
+                            visit(number, block);
+                            ++count;
+                        }
+                    }
+                }
+                return count;
+            }
+
+        private:
+            struct Superblock
+            {
+                BlockSummary Summary;
+                // the largest mean square of its blocks, to find blocks by RMS
+                double MaximumMeanSquare;
+            };
+
+            static void Include(Superblock& superblock, const BlockSummary& block)
+            {
+                superblock.Summary.Merge(block);
+                double meanSquare = block.MeanSquare();
+                superblock.MaximumMeanSquare = meanSquare > superblock.MaximumMeanSquare ? meanSquare : superblock.MaximumMeanSquare;
+            }
+
+            // the number of the first block that superblock s covers, which may be dropped
+            unsigned long long SuperblockStart(size_t s) const
+            {
+                return (first / BlocksPerSuperblock + s) * BlocksPerSuperblock;
+            }
+
+            size_t FirstSuperblockReaching(long long begin) const
+            {
+                size_t low = 0;
+                size_t high = superblocks.size();
+                while (low < high)
+                {
+                    size_t middle = low + (high - low) / 2;
+                    if (superblocks[middle].Summary.Last < begin)
+                    {
+                        low = middle + 1;
+                    }
+                    else
+                    {
+                        high = middle;
+                    }
+                }
+                return low;
+            }
+
+            unsigned long long first;
+            std::deque<BlockSummary> blocks;
+            std::deque<Superblock> superblocks;
+        };
+    }
+}
@@ -0,0 +1,202 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// VirtualTimeScheduler.h
+// Declaration of the VirtualTimeScheduler class
+//
+
+#pragma once
+
+#include "PipelineMetrics.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <utility>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Runs timers, dispatcher work and async functions against a virtual clock.  Time only
+        /// moves when AdvanceTo or AdvanceBy is called, so a long sensor session can be replayed
+        /// in as long as it takes to run the work.  Work items that are due at the same time run
+        /// in the order they were scheduled.  The real time spent in each work item is recorded
+        /// so that the cost of the operators can be measured without timer jitter.
+        /// Not thread-safe; schedule and advance from one thread.
+        /// </summary>
+        class VirtualTimeScheduler
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+            typedef clock::time_point time_point;
+            typedef clock::duration duration;
+            typedef std::function<void()> Work;
+            typedef unsigned long long Id;
+
+            VirtualTimeScheduler() : now(), nextId(0), running(false), runningId(0), runningCancelled(false)
+            {
+            }
+
+            time_point Now() const
+            {
+                return now;
+            }
+
+            /// <summary>
+            /// Runs work when the virtual clock reaches due.  Work that is due in the past runs
+            /// on the next advance.
+            /// </summary>
+            Id Schedule(time_point due, Work work)
+            {
+                auto id = nextId++;
+                queue.insert(std::make_pair(std::make_pair(due, id), Item(std::move(work), duration::zero())));
+                return id;
+            }
+
+            Id Schedule(duration dueTime, Work work)
+            {
+                return Schedule(now + dueTime, std::move(work));
+            }
+
+            /// <summary>
+            /// Equivalent of posting to the dispatcher; runs after the work already due now.
+            /// </summary>
+            Id Post(Work work)
+            {
+                return Schedule(now, std::move(work));
+            }
+
+            /// <summary>
+            /// Runs work every period, starting one period from now, until it is cancelled.
+            /// </summary>
+            Id SchedulePeriodic(duration period, Work work)
+            {
+                auto id = nextId++;
+                queue.insert(std::make_pair(std::make_pair(now + period, id), Item(std::move(work), period)));
+                return id;
+            }
+
+            /// <summary>
+            /// A scheduler for BoundedQueue, IntervalTimer and the operators that take one, so
+            /// they run on this virtual clock instead of a dispatcher.
+            /// </summary>
+            std::function<void(duration, Work)> Scheduler()
+            {
+                return [this](duration dueTime, Work work)
+                {
+                    Schedule(dueTime, std::move(work));
+                };
+            }
+
+            void Cancel(Id id)
+            {
+                if (running && id == runningId)
+                {
+                    runningCancelled = true;
+                    return;
+                }
+                for (auto it = queue.begin(); it != queue.end(); ++it)
+                {
+                    if (it->first.second == id)
+                    {
+                        queue.erase(it);
+                        return;
+                    }
+                }
+            }
+
+            bool Empty() const
+            {
+                return queue.empty();
+            }
+
+            /// <summary>
+            /// Runs all the work that is due up to and including time, in due order, and then
+            /// leaves the clock at time.
+            /// </summary>
+            void AdvanceTo(time_point time)
+            {
+                while (!queue.empty() && queue.begin()->first.first <= time)
+                {
+                    auto next = queue.begin();
+                    auto due = next->first.first;
+                    auto id = next->first.second;
+                    auto item = std::move(next->second);
+                    queue.erase(next);
+
+                    if (due > now)
+                    {
+                        now = due;
+                    }
+                    running = true;
+                    runningId = id;
+                    runningCancelled = false;
+
+                    auto start = clock::now();
+                    item.Action();
+                    workCost.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start));
+
+                    running = false;
+                    if (item.Period != duration::zero() && !runningCancelled)
+                    {
+                        queue.insert(std::make_pair(std::make_pair(due + item.Period, id), std::move(item)));
+                    }
+                }
+                if (time > now)
+                {
+                    now = time;
+                }
+            }
+
+            void AdvanceBy(duration time)
+            {
+                AdvanceTo(now + time);
+            }
+
+            /// <summary>
+            /// Runs until no one-shot work is left.  Periodic work must be cancelled first or
+            /// this never returns.
+            /// </summary>
+            void RunAll()
+            {
+                while (!queue.empty())
+                {
+                    AdvanceTo(queue.begin()->first.first);
+                }
+            }
+
+            /// <summary>
+            /// The real time spent running each work item.
+            /// </summary>
+            const LatencyHistogram& WorkCost() const
+            {
+                return workCost;
+            }
+
+        private:
+            struct Item
+            {
+                Item(Work action, duration period) : Action(std::move(action)), Period(period)
+                {
+                }
+
+                Work Action;
+                duration Period;
+            };
+
+            time_point now;
+            Id nextId;
+            bool running;
+            Id runningId;
+            bool runningCancelled;
+            std::map<std::pair<time_point, Id>, Item> queue;
+            LatencyHistogram workCost;
+        };
+    }
+}
@@ -0,0 +1,376 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// WindowedStatistics.h
+// Declaration of the SlidingExtremes, SlidingStatistics, ExponentialStatistics and SensorStatistics classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Common
+    {
+        /// <summary>
+        /// Summary of one channel.  Variance is the population variance.
+        /// </summary>
+        struct Statistics
+        {
+            size_t Count;
+            double Mean;
+            double Variance;
+            double Rms;
+            double Minimum;
+            double Maximum;
+
+            double Peak() const
+            {
+                return std::fabs(Minimum) > std::fabs(Maximum) ? std::fabs(Minimum) : std::fabs(Maximum);
+            }
+        };
+
+        /// <summary>
+        /// The minimum and maximum of the last window values, from monotonic deques that hold
+        /// only the values that can still become the extreme, in O(1) amortized time per value.
+        /// All storage is allocated by the constructor.  window is at least 1.
+        /// </summary>
+        template<class T>
+        class SlidingExtremes
+        {
+        public:
+            explicit SlidingExtremes(size_t window) :
+                window(window),
+                minimums(window),
+                maximums(window),
+                next(0)
+            {
+            }
+
+            void Reset()
+            {
+                minimums.Clear();
+                maximums.Clear();
+                next = 0;
+            }
+
+            void Push(T value)
+            {
+                // values older than the window leave the front, dominated values leave the back
+                while (!minimums.Empty() && minimums.Front().Index + window <= next)
+                {
+                    minimums.PopFront();
+                }
+                while (!minimums.Empty() && minimums.Back().Value >= value)
+                {
+                    minimums.PopBack();
+                }
+                minimums.PushBack(next, value);
+
+                while (!maximums.Empty() && maximums.Front().Index + window <= next)
+                {
+                    maximums.PopFront();
+                }
+                while (!maximums.Empty() && maximums.Back().Value <= value)
+                {
+                    maximums.PopBack();
+                }
+                maximums.PushBack(next, value);
+
+                ++next;
+            }
+
+            /// <summary>
+            /// Only valid once a value was pushed.
+            /// </summary>
+            T Minimum() const
+            {
+                return minimums.Front().Value;
+            }
+
+            T Maximum() const
+            {
+                return maximums.Front().Value;
+            }
+
+        private:
+            /// <summary>
+            /// Fixed capacity ring used as a deque.
+            /// </summary>
+            class Deque
+            {
+            public:
+                struct Entry
+                {
+                    unsigned long long Index;
+                    T Value;
+                };
+
+                explicit Deque(size_t capacity) : entries(capacity), head(0), size(0)
+                {
+                }
+
+                void Clear()
+                {
+                    head = 0;
+                    size = 0;
+                }
+
+                bool Empty() const
+                {
+                    return size == 0;
+                }
+
+                const Entry& Front() const
+                {
+                    return entries[head];
+                }
+
+                const Entry& Back() const
+                {
+                    return entries[(head + size - 1) % entries.size()];
+                }
+
+                void PopFront()
+                {
+                    head = (head + 1) % entries.size();
+                    --size;
+                }
+
+                void PopBack()
+                {
+                    --size;
+                }
+
+                void PushBack(unsigned long long index, T value)
+                {
+                    Entry& entry = entries[(head + size) % entries.size()];
+                    entry.Index = index;
+                    entry.Value = value;
+                    ++size;
+                }
+
+            private:
+                std::vector<Entry> entries;
+                size_t head;
+                size_t size;
+            };
+
+            size_t window;
+            Deque minimums;
+            Deque maximums;
+            unsigned long long next;
+        };
+
+        /// <summary>
+        /// Mean, variance, RMS, minimum and maximum over the last Window values, updated in O(1)
+        /// amortized time per value.  The moments are updated with Welford's method, adding the
+        /// new value and removing the one that falls out of the window in a single step.  The
+        /// minimum and maximum come from monotonic deques that hold only the values that can
+        /// still become the extreme.  All storage is allocated by the constructor.
+        /// </summary>
+        class SlidingStatistics
+        {
+        public:
+            /// <summary>
+            /// window is the number of values summarized, at least 1.
+            /// </summary>
+            explicit SlidingStatistics(size_t window) :
+                window(window),
+                values(window),
+                extremes(window)
+            {
+                if (window == 0)
+                {
+                    throw std::invalid_argument("SlidingStatistics: the window is empty");
+                }
+                Reset();
+            }
+
+            void Reset()
+            {
+                count = 0;
+                next = 0;
+                mean = 0.0;
+                m2 = 0.0;
+                extremes.Reset();
+            }
+
+            size_t Window() const
+            {
+                return window;
+            }
+
+            void Push(double value)
+            {
+                if (count < window)
+                {
+                    ++count;
+                    double delta = value - mean;
+                    mean += delta / count;
+                    m2 += delta * (value - mean);
+                }
+                else
+                {
+                    double old = values[next % window];
+                    double oldMean = mean;
+                    mean += (value - old) / window;
+                    m2 += (value - old) * (value - mean + old - oldMean);
+                    if (m2 < 0.0)
+                    {
+                        // rounding
+                        m2 = 0.0;
+                    }
+                }
+                values[next % window] = value;
+                extremes.Push(value);
+                ++next;
+            }
+
+            Statistics Current() const
+            {
+                Statistics statistics = {count, mean, 0.0, 0.0, 0.0, 0.0};
+                if (count != 0)
+                {
+                    statistics.Variance = m2 / count;
+                    statistics.Rms = std::sqrt(statistics.Variance + mean * mean);
+                    statistics.Minimum = extremes.Minimum();
+                    statistics.Maximum = extremes.Maximum();
+                }
+                return statistics;
+            }
+
+        private:
+            size_t window;
+            std::vector<double> values;
+            size_t count;
+            unsigned long long next;
+            double mean;
+            double m2;
+            SlidingExtremes<double> extremes;
+        };
+
+        /// <summary>
+        /// Exponentially weighted mean and variance, with minimum and maximum decaying toward the
+        /// mean at the same rate.  weight is the weight of the newest value, e.g. 2 / (N + 1) to
+        /// behave roughly like a window of N values.
+        /// </summary>
+        class ExponentialStatistics
+        {
+        public:
+            explicit ExponentialStatistics(double weight) : weight(weight)
+            {
+                Reset();
+            }
+
+            void Reset()
+            {
+                count = 0;
+                mean = 0.0;
+                variance = 0.0;
+                minimum = 0.0;
+                maximum = 0.0;
+            }
+
+            void Push(double value)
+            {
+                if (count++ == 0)
+                {
+                    mean = value;
+                    minimum = value;
+                    maximum = value;
+                    return;
+                }
+                double delta = value - mean;
+                double increment = weight * delta;
+                mean += increment;
+                variance = (1.0 - weight) * (variance + delta * increment);
+                minimum = value < minimum ? value : minimum + weight * (mean - minimum);
+                maximum = value > maximum ? value : maximum + weight * (mean - maximum);
+            }
+
+            Statistics Current() const
+            {
+                Statistics statistics = {count, mean, variance, std::sqrt(variance + mean * mean), minimum, maximum};
+                return statistics;
+            }
+
+        private:
+            double weight;
+            size_t count;
+            double mean;
+            double variance;
+            double minimum;
+            double maximum;
+        };
+
+        /// <summary>
+        /// Runs one Channel (SlidingStatistics or ExponentialStatistics) over each axis and over
+        /// the magnitude of the readings.
+        /// </summary>
+        template<class Channel>
+        class SensorStatistics
+        {
+        public:
+            template<class Parameter>
+            explicit SensorStatistics(Parameter parameter) :
+                x(parameter),
+                y(parameter),
+                z(parameter),
+                magnitude(parameter)
+            {
+            }
+
+            void Reset()
+            {
+                x.Reset();
+                y.Reset();
+                z.Reset();
+                magnitude.Reset();
+            }
+
+            void Push(const SensorSample& sample)
+            {
+                x.Push(sample.X);
+                y.Push(sample.Y);
+                z.Push(sample.Z);
+                magnitude.Push(std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z));
+            }
+
+            Statistics X() const
+            {
+                return x.Current();
+            }
+
+            Statistics Y() const
+            {
+                return y.Current();
+            }
+
+            Statistics Z() const
+            {
+                return z.Current();
+            }
+
+            Statistics Magnitude() const
+            {
+                return magnitude.Current();
+            }
+
+        private:
+            Channel x;
+            Channel y;
+            Channel z;
+            Channel magnitude;
+        };
+    }
+}
@@ -11,12 +11,27 @@
 #include "pch.h"
 #include "MainPage.xaml.h"
 #include "Constants.h"
+#include "Scenario1.xaml.h"
+#include "Scenario2.xaml.h"
+#include "Scenario3.xaml.h"
 
 using namespace SDKSample;
+using namespace Windows::UI::Xaml::Interop;
 
-Platform::Array<Scenario>^ MainPage::scenariosInner = ref new Platform::Array<Scenario>  
+namespace
 {
-    { "Accelerometer data events", "SDKSample.AccelerometerCPP.Scenario1" }, 
-    { "Accelerometer shake events", "SDKSample.AccelerometerCPP.Scenario2" },
-    { "Poll accelerometer readings", "SDKSample.AccelerometerCPP.Scenario3" }
-}; 
+    template<class Page>
+    TypeName PageTypeName()
+    {
+        return Page::typeid;
+    }
+}
+
+const Scenario MainPage::scenarios[] =
+{
+    { L"Accelerometer data events", L"SDKSample.AccelerometerCPP.Scenario1", &PageTypeName<AccelerometerCPP::Scenario1> },
+    { L"Accelerometer shake events", L"SDKSample.AccelerometerCPP.Scenario2", &PageTypeName<AccelerometerCPP::Scenario2> },
+    { L"Poll accelerometer readings", L"SDKSample.AccelerometerCPP.Scenario3", &PageTypeName<AccelerometerCPP::Scenario3> }
+};
+
+const unsigned int MainPage::scenarioCount = sizeof(MainPage::scenarios) / sizeof(MainPage::scenarios[0]); 
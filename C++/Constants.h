@@ -14,10 +14,17 @@
 
 namespace SDKSample
 {
-    public value struct Scenario
+    /// <summary>
+    /// One entry of the scenario table.  The table is constant data, initialized before any code
+    /// runs, and PageTypeName returns the TypeName of the page class from its typeid instead of
+    /// building it from ClassName.  Frame::Navigate still creates the page from the type
+    /// metadata; only the name lookup is saved.
+    /// </summary>
+    struct Scenario
     {
-        Platform::String^ Title;
-        Platform::String^ ClassName;
+        const wchar_t* Title;
+        const wchar_t* ClassName;
+        Windows::UI::Xaml::Interop::TypeName (*PageTypeName)();
     };
 
     partial ref class MainPage
@@ -31,15 +38,19 @@ namespace SDKSample
             }
         }
 
-        static property Platform::Array<Scenario>^ scenarios 
+        // how many scenario pages are kept alive, with their sensors and subscriptions, to
+        // switch back to
+        static property unsigned int SCENARIO_CACHE_SIZE
         {
-            Platform::Array<Scenario>^ get() 
-            { 
-                return scenariosInner; 
+            unsigned int get()
+            {
+                return 3;
             }
         }
-    private:
-        static Platform::Array<Scenario>^ scenariosInner;
+
+    internal:
+        static const Scenario scenarios[];
+        static const unsigned int scenarioCount;
     };
 
 
@@ -12,6 +12,9 @@
 #include "pch.h"
 #include "MainPage.xaml.h"
 #include "App.xaml.h"
+#include "Common\StartupTrace.h"
+#include "Common\DeferredAccelerometer.h"
+#include "Common\DebugOutput.h"
 
 #include <collection.h>
 
@@ -28,12 +31,25 @@ using namespace Windows::UI::ViewManagement;
 
 MainPage^ MainPage::Current = nullptr;
 
+namespace
+{
+    // the steady clock in the 100ns units of StatusThrottle
+    long long StatusTicks()
+    {
+        return std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
 MainPage::~MainPage()
 {
     cd.Dispose();
 }
 
-MainPage::MainPage()
+MainPage::MainPage() :
+    scenarioCache(SCENARIO_CACHE_SIZE),
+    // each class of status message at most every quarter second
+    status(2, 2500000)
 {
     InitializeComponent();
 
@@ -57,6 +73,17 @@ MainPage::MainPage()
         }
     );
 
+    auto loaded = rxrt::FromEventPattern<RoutedEventHandler, RoutedEventArgs>(
+        [this](RoutedEventHandler^ h)
+        {
+            return this->Loaded += h;
+        },
+        [this](Windows::Foundation::EventRegistrationToken t)
+        {
+            this->Loaded -= t;
+        }
+    );
+
     auto selectionChanged = rxrt::FromEventPattern<SelectionChangedEventHandler, MainPage, SelectionChangedEventArgs>(
         [this](SelectionChangedEventHandler^ h)
         {
@@ -72,11 +99,30 @@ MainPage::MainPage()
         .subscribe(
             [this](const rxrt::EventPattern<Platform::Object^, SizeChangedEventArgs^>&){
                 /// We need to handle SizeChanged so that we can make the sample layout property
-                /// in the various layouts.
-                this->InvalidateSize();
-                MainPageSizeChangedEventArgs^ args = ref new MainPageSizeChangedEventArgs();
-                args->Width = this->ActualWidth;
-                this->MainPageResized(this, args);
+                /// in the various layouts.  A drag raises many size events, so they are coalesced
+                /// into one update that runs after the pending input and rendering work.
+                if (this->layout.Schedule())
+                {
+                    this->Dispatcher->RunAsync(Windows::UI::Core::CoreDispatcherPriority::Low,
+                        ref new Windows::UI::Core::DispatchedHandler([this]()
+                        {
+                            this->UpdateLayoutForSize();
+                        }));
+                }
+            })
+    );
+
+    cd.Add(rx::from(loaded)
+        .subscribe(
+            [this](const rxrt::EventPattern<Platform::Object^, RoutedEventArgs^>&){
+                /// Once the first frame is up and the ui thread is idle, get the sensor ready in the
+                /// background so that enabling a scenario does not wait for it.
+                this->Dispatcher->RunIdleAsync(ref new Windows::UI::Core::IdleDispatchedHandler(
+                    [](Windows::UI::Core::IdleDispatchedHandlerArgs^)
+                    {
+                        Common::StartupTrace::Mark(L"first frame idle");
+                        Common::DeferredAccelerometer::Prefetch();
+                    }));
             })
     );
 
@@ -87,16 +133,48 @@ MainPage::MainPage()
                 {
                     this->NotifyUser("", NotifyType::StatusMessage);
 
-                    this->LoadScenario((safe_cast<ListBoxItem^>(this->Scenarios->SelectedItem))->Name);
+                    this->LoadScenario(static_cast<unsigned int>(this->Scenarios->SelectedIndex));
                     this->InvalidateSize();
                 }
             })
     );
 
     MainPage::Current = this;
+
+    Common::StartupTrace::Mark(L"main page constructed");
 }
 
 void MainPage::InvalidateSize()
+{
+    ResizeInputSection();
+    InvalidateLayout();
+}
+
+/// <summary>
+/// Applies the latest size after a burst of size events.  The input section is resized and
+/// MainPageResized is raised only if the width changed, and the rows, columns and visual
+/// states are only changed if the width crossed into another layout.
+/// </summary>
+void MainPage::UpdateLayoutForSize()
+{
+    auto changes = layout.Update(this->ActualWidth);
+    if (changes.Width)
+    {
+        ResizeInputSection();
+    }
+    if (changes.Bucket)
+    {
+        InvalidateLayout();
+    }
+    if (changes.Width)
+    {
+        MainPageSizeChangedEventArgs^ args = ref new MainPageSizeChangedEventArgs();
+        args->Width = this->ActualWidth;
+        this->MainPageResized(this, args);
+    }
+}
+
+void MainPage::ResizeInputSection()
 {
     // Get the window width
     double windowWidth = this->ActualWidth;
@@ -131,7 +209,6 @@ void MainPage::InvalidateSize()
                 InputSection->Width = (windowWidth - (layoutRootMarginLeft + layoutRootMarginRight));
         }
     }
-    InvalidateLayout();
 }
 
 void MainPage::InvalidateLayout()
@@ -164,6 +241,8 @@ void MainPage::InvalidateLayout()
     // by the scenario's input and output sections is fired.
     VisualStateManager::GoToState(InputSection, "Input" + LayoutAwarePage::DetermineVisualState(this->ActualWidth), false);
     VisualStateManager::GoToState(OutputSection, "Output" + LayoutAwarePage::DetermineVisualState(this->ActualWidth), false);
+
+    layout.Applied(this->ActualWidth);
 }
 
 void MainPage::PopulateScenarios()
@@ -171,37 +250,57 @@ void MainPage::PopulateScenarios()
     ScenarioList = ref new Platform::Collections::Vector<Object^>();
 
     // Populate the ListBox with the list of scenarios as defined in Constants.cpp.
-    for (unsigned int i = 0; i < scenarios->Length; ++i)
+    for (unsigned int i = 0; i < scenarioCount; ++i)
     {
-        Scenario s = scenarios[i];
+        const Scenario& s = scenarios[i];
         ListBoxItem^ item = ref new ListBoxItem();
-        item->Name = s.ClassName;
-        item->Content = (i + 1).ToString() + ") " + s.Title;
+        item->Name = ref new String(s.ClassName);
+        item->Content = (i + 1).ToString() + ") " + ref new String(s.Title);
         ScenarioList->Append(item);
     }
 
     // Bind the ListBox to the scenario list.
     Scenarios->ItemsSource = ScenarioList;
     Scenarios->ScrollIntoView(Scenarios->SelectedItem);
+
+    Common::StartupTrace::Mark(L"scenarios populated");
 }
 
 /// <summary>
 /// This method is responsible for loading the individual input and output sections for each scenario.  This 
 /// is based on navigating a hidden Frame to the ScenarioX.xaml page and then extracting out the input
-/// and output sections into the respective UserControl on the main page.
+/// and output sections into the respective UserControl on the main page.  The most recently used pages
+/// are kept in the Frame's cache, so switching back to one of them reattaches its sections instead of
+/// constructing the page, its commands and its subscriptions again.
 /// </summary>
-/// <param name="scenarioName"></param>
-void MainPage::LoadScenario(String^ scenarioName)
+/// <param name="index">The index of the scenario in the scenario table.</param>
+void MainPage::LoadScenario(unsigned int index)
 {
+    auto started = std::chrono::steady_clock::now();
+    const Scenario& scenario = scenarios[index];
 
-    // Load the ScenarioX.xaml file into the Frame.
-    TypeName scenarioType = {scenarioName, TypeKind::Custom};
-    HiddenFrame->Navigate(scenarioType, this);
+    // Load the ScenarioX.xaml file into the Frame.  A page in the cache is navigated to again,
+    // so that it sees OnNavigatedTo and resumes its input.
+    HiddenFrame->Navigate(scenario.PageTypeName(), this);
 
     // Get the top element, the Page, so we can look up the elements
     // that represent the input and output sections of the ScenarioX file.
     Page^ hiddenPage = safe_cast<Page^>(HiddenFrame->Content);
 
+    auto cached = scenarioCache.Find(index);
+    if (cached != nullptr && cached->Page == hiddenPage)
+    {
+        // The sections were plucked out of this page when it was first loaded.
+        InputSection->Content = cached->Input;
+        OutputSection->Content = cached->Output;
+
+        ScenarioLoaded(this, nullptr);
+        ReportScenarioSwitch(scenario.ClassName, true, started);
+        return;
+    }
+
+    String^ scenarioName = ref new String(scenario.ClassName);
+
     // Get each element.
     UIElement^ input = safe_cast<UIElement^>(hiddenPage->FindName("Input"));
     UIElement^ output = safe_cast<UIElement^>(hiddenPage->FindName("Output"));
@@ -227,21 +326,40 @@ void MainPage::LoadScenario(String^ scenarioName)
 
     if (panel != nullptr)
     {
-        unsigned int index = 0;
+        unsigned int childIndex = 0;
         UIElementCollection^ collection = panel->Children;
 
         // Get rid of the content that is currently in the intput and output sections.
-        collection->IndexOf(input, &index);
-        collection->RemoveAt(index);
+        if (collection->IndexOf(input, &childIndex))
+        {
+            collection->RemoveAt(childIndex);
+        }
 
-        collection->IndexOf(output, &index);
-        collection->RemoveAt(index);
+        if (collection->IndexOf(output, &childIndex))
+        {
+            collection->RemoveAt(childIndex);
+        }
 
         // Populate the input and output sections with the newly loaded content.
         InputSection->Content = input;
         OutputSection->Content = output;
 
+        // Keep the page in the Frame until it falls out of the cache.  A stale entry for this
+        // scenario, whose page the Frame no longer returns, is released like an evicted one.
+        if (cached != nullptr)
+        {
+            cached->Page->NavigationCacheMode = NavigationCacheMode::Disabled;
+        }
+        hiddenPage->NavigationCacheMode = NavigationCacheMode::Required;
+        CachedScenario entry = {hiddenPage, input, output};
+        scenarioCache.Insert(index, entry, [](unsigned int, CachedScenario& evicted)
+        {
+            evicted.Page->NavigationCacheMode = NavigationCacheMode::Disabled;
+        });
+
         ScenarioLoaded(this, nullptr);
+        ReportScenarioSwitch(scenario.ClassName, false, started);
+        Common::StartupTrace::Mark(L"scenario constructed");
     }
     else
     {
@@ -251,7 +369,92 @@ void MainPage::LoadScenario(String^ scenarioName)
     }
 }
 
+/// <summary>
+/// Writes the time it took to switch to a scenario, and the percentiles of all switches so far, to the
+/// debugger output.
+/// </summary>
+void MainPage::ReportScenarioSwitch(const wchar_t* scenarioName, bool cached, std::chrono::steady_clock::time_point started)
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+    (cached ? cachedSwitches : freshSwitches).Record(elapsed);
+
+    Common::DebugOutput([&]()
+    {
+        std::wostringstream out;
+        out << L"LoadScenario " << scenarioName << (cached ? L" cached " : L" constructed ")
+            << elapsed.count() / 1000000.0 << L"ms"
+            << L" (cached p50=" << cachedSwitches.Percentile(0.50).count() / 1000000.0 << L"ms"
+            << L" n=" << cachedSwitches.Count()
+            << L", constructed p50=" << freshSwitches.Percentile(0.50).count() / 1000000.0 << L"ms"
+            << L" n=" << freshSwitches.Count() << L")\n";
+        return out.str();
+    });
+}
+
+/// <summary>
+/// Shows a message in the status bar.  Can be called from any thread: the message is shown
+/// with the next frame, repeats of the message shown are dropped and each type of message is
+/// shown at most every quarter second, the latest one of the type winning.
+/// </summary>
 void MainPage::NotifyUser(String^ strMessage, NotifyType type)
+{
+    long long delay;
+    if (status.Post(StatusTicks(), static_cast<unsigned int>(type), std::wstring(strMessage->Data(), strMessage->Length()), delay))
+    {
+        ScheduleStatus(delay);
+    }
+}
+
+/// <summary>
+/// Flushes the status message after the pending input and rendering work, or after delay in
+/// 100ns units.
+/// </summary>
+void MainPage::ScheduleStatus(long long delay)
+{
+    auto dispatcher = this->Dispatcher;
+    auto handler = ref new Windows::UI::Core::DispatchedHandler([this]()
+    {
+        this->FlushStatus();
+    });
+    if (delay <= 0)
+    {
+        dispatcher->RunAsync(Windows::UI::Core::CoreDispatcherPriority::Low, handler);
+        return;
+    }
+    TimeSpan dueTime;
+    dueTime.Duration = delay;
+    Windows::System::Threading::ThreadPoolTimer::CreateTimer(
+        ref new Windows::System::Threading::TimerElapsedHandler([dispatcher, handler](Windows::System::Threading::ThreadPoolTimer^)
+        {
+            dispatcher->RunAsync(Windows::UI::Core::CoreDispatcherPriority::Low, handler);
+        }), dueTime);
+}
+
+void MainPage::FlushStatus()
+{
+    Common::StatusThrottle::Status shown;
+    long long retry;
+    bool taken = status.Take(StatusTicks(), shown, retry);
+    if (retry != 0)
+    {
+        // the next message waiting in a throttled class
+        ScheduleStatus(retry);
+    }
+    if (!taken)
+    {
+        return;
+    }
+    if (shown.Suppressed != 0)
+    {
+        Common::DebugOutput([this]()
+        {
+            return status.Report(L"Status messages");
+        });
+    }
+    ShowStatus(ref new String(shown.Text.c_str(), static_cast<unsigned int>(shown.Text.size())), static_cast<NotifyType>(shown.Class));
+}
+
+void MainPage::ShowStatus(String^ strMessage, NotifyType type)
 {
     switch (type)
     {
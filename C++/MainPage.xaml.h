@@ -15,6 +15,10 @@
 #include "MainPage.g.h"
 #include "Common\LayoutAwarePage.h" // Required by generated header
 #include "Constants.h"
+#include "Common\LruCache.h"
+#include "Common\LayoutTracker.h"
+#include "Common\PipelineMetrics.h"
+#include "Common\StatusThrottle.h"
 
 namespace SDKSample
 {
@@ -58,17 +62,37 @@ namespace SDKSample
     internal:
 
         void NotifyUser(Platform::String^ strMessage, NotifyType type);
-        void LoadScenario(Platform::String^ scenarioName);
+        void LoadScenario(unsigned int index);
         event Windows::Foundation::EventHandler<Platform::Object^>^ ScenarioLoaded;
         event Windows::Foundation::EventHandler<MainPageSizeChangedEventArgs^>^ MainPageResized;
 
     private:
+        // a scenario page that stays alive in the hidden frame, with the sections plucked out of it
+        struct CachedScenario
+        {
+            Windows::UI::Xaml::Controls::Page^ Page;
+            Windows::UI::Xaml::UIElement^ Input;
+            Windows::UI::Xaml::UIElement^ Output;
+        };
+
         void PopulateScenarios();
         void InvalidateSize();
         void InvalidateLayout();
+        void ResizeInputSection();
+        void UpdateLayoutForSize();
+        void ReportScenarioSwitch(const wchar_t* scenarioName, bool cached, std::chrono::steady_clock::time_point started);
+        void ScheduleStatus(long long delay);
+        void FlushStatus();
+        void ShowStatus(Platform::String^ strMessage, NotifyType type);
 
 		rx::ComposableDisposable cd;
 
+        Common::LayoutTracker layout;
+        Common::LruCache<unsigned int, CachedScenario> scenarioCache;
+        Common::LatencyHistogram cachedSwitches;
+        Common::LatencyHistogram freshSwitches;
+        Common::StatusThrottle status;
+
         Platform::Collections::Vector<Object^>^ ScenarioList;
         Windows::UI::Xaml::Controls::Frame^ HiddenFrame;
         void Footer_Click(Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e);
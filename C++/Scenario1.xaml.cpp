@@ -15,8 +15,20 @@
 
 #include "pch.h"
 #include "Scenario1.xaml.h"
+#include "Common\DeferredAccelerometer.h"
+#include "Common\SensorManager.h"
+#include "Common\SensorSample.h"
+#include "Common\PipelineMetrics.h"
+#include "Common\CancellableWork.h"
+#include "Common\SensorCalibration.h"
+#include "Common\CalibrationStore.h"
+#include "Common\SensorOperators.h"
+#include "Common\ScenarioPipelines.h"
+#include "Common\SharedReadingRing.h"
+#include "Common\DebugOutput.h"
 
 using namespace SDKSample::AccelerometerCPP;
+using namespace SDKSample::Common;
 
 using namespace Windows::UI::Xaml;
 using namespace Windows::UI::Xaml::Controls;
@@ -28,6 +40,7 @@ using namespace Platform;
 
 Scenario1::Scenario1() : 
     rootPage(MainPage::Current), 
+    accelerometerChecked(false),
     navigated(std::make_shared < rx::BehaviorSubject < bool >> (true)),
     desiredReportInterval(0)
 {
@@ -37,6 +50,8 @@ Scenario1::Scenario1() :
     auto enabled = std::make_shared<rx::BehaviorSubject<bool>>(false);
     // start out not-working
     auto working = std::make_shared<rx::BehaviorSubject<bool>>(false);
+    // disable only waits for itself, so that it can cancel the warm-up
+    auto disabling = std::make_shared<rx::BehaviorSubject<bool>>(false);
 
     // use !enabled and !working to control canExecute
     enable = std::make_shared < rxrt::ReactiveCommand < RoutedEventPattern> >(observable(from(enabled)
@@ -44,12 +59,12 @@ Scenario1::Scenario1() :
         {
             return !e && !w; 
         }, working)));
-    // use enabled and !working to control canExecute
+    // use enabled and !disabling to control canExecute
     disable = std::make_shared < rxrt::ReactiveCommand < RoutedEventPattern> >(observable(from(enabled)
-        .combine_latest([](bool e, bool w)
+        .combine_latest([](bool e, bool d)
         {
-            return e && !w; 
-        }, working)));
+            return e && !d; 
+        }, disabling)));
 
     // when enable or disable is executing mark as working (both commands should be disabled)
     observable(from(enable->IsExecuting())
@@ -59,11 +74,20 @@ Scenario1::Scenario1() :
         }, disable->IsExecuting()))
         ->Subscribe(observer(working));
 
+    disable->IsExecuting()->Subscribe(observer(disabling));
+
+    // the history can be inspected at any time except while enable or disable is executing
+    inspect = std::make_shared < rxrt::ReactiveCommand < RoutedEventPattern> >(observable(from(working)
+        .select([](bool w)
+        {
+            return !w;
+        })));
+
     // when enable is executed mark the scenario enabled, when disable is executed mark the scenario disabled
     observable(from(observable(enable))
         .select([this](RoutedEventPattern)
         {
-            return this->accelerometer != nullptr; 
+            return this->AcquireAccelerometer(); 
         })
         .merge(observable(from(observable(disable))
             .select([](RoutedEventPattern)
@@ -72,8 +96,36 @@ Scenario1::Scenario1() :
             }))))
         ->Subscribe(observer(enabled)); // this is a subscription to the enable and disable ReactiveCommands
 
+    // the steps of the graph below, which the benchmarks and tests run without rx: calibration
+    // from the one saved by an earlier visit or session, the history, the activity windows
+    // classified on the worker pool that every page shares, and the rolling statistics.  The
+    // activity windows hold the page weakly, so a page that is released does not wait for its
+    // last windows.
+    auto dispatcher = Dispatcher;
+    WeakReference weakThis(this);
+    auto pipeline = std::make_shared<Scenario1Pipeline>(SensorManager::Workers(),
+        [weakThis]() -> long long
+        {
+            // on a worker thread, when a run starts
+            auto page = weakThis.Resolve<Scenario1>();
+            return page != nullptr ? static_cast<long long>(page->desiredReportInterval) * 10000 : 0;
+        },
+        [weakThis, dispatcher](const Activity& activity)
+        {
+            dispatcher->RunAsync(CoreDispatcherPriority::Normal, ref new DispatchedHandler([weakThis, activity]()
+            {
+                // on the ui thread
+                auto page = weakThis.Resolve<Scenario1>();
+                if (page != nullptr)
+                {
+                    page->ScenarioOutput_Activity->Text = ref new String(ActivityName(activity));
+                }
+            }));
+        },
+        CalibrationStore::Load());
+
     typedef TypedEventHandler<Accelerometer^, AccelerometerReadingChangedEventArgs^> AccelerometerReadingChangedTypedEventHandler;
-    auto readingChanged = from(rxrt::FromEventPattern<AccelerometerReadingChangedTypedEventHandler>(
+    auto sensorReadings = from(rxrt::FromEventPattern<AccelerometerReadingChangedTypedEventHandler>(
         [this](AccelerometerReadingChangedTypedEventHandler^ h)
         {
             return this->accelerometer->ReadingChanged += h;
@@ -82,13 +134,94 @@ Scenario1::Scenario1() :
         {
             this->accelerometer->ReadingChanged -= t;
         }))
-        .select([](rxrt::EventPattern<Accelerometer^, AccelerometerReadingChangedEventArgs^> e)
+        .select([](rxrt::EventPattern<Accelerometer^, AccelerometerReadingChangedEventArgs^> e) -> SensorSample
         {
             // on sensor thread
-            return e.EventArgs()->Reading;
+            // charge everything allocated on the sensor thread to the sensor stage
+            AllocationCounter::Enter(AllocationStage::Sensor);
+
+            auto reading = e.EventArgs()->Reading;
+            SensorSample sample = {
+                reading->Timestamp.UniversalTime,
+                reading->AccelerationX,
+                reading->AccelerationY,
+                reading->AccelerationZ,
+                SensorSample::clock::now()};
+            return sample;
         })
-        // push readings to ui thread
-        .observe_on_dispatcher()
+        .select([pipeline](SensorSample sample)
+        {
+            // on sensor thread
+            // refine the calibration while the device is still and correct every reading
+            return pipeline->Calibrate(sample);
+        });
+
+    // the sensor may run faster for another scenario, only pass on the readings due at our interval
+    auto arbitratedReadings = Arbitrate(observable(sensorReadings),
+        []()
+        {
+            return SensorManager::Accelerometer();
+        },
+        [this]()
+        {
+            return this->desiredReportInterval;
+        });
+
+    // every consumer of the calibrated readings shares one immutable batch per reading
+    auto hub = std::make_shared<BroadcastHub<SensorBatch>>();
+    auto sharedReadings = Broadcast(arbitratedReadings, hub);
+
+    // other processes on the device follow the same readings through shared memory, and the
+    // history keeps the last five minutes of them
+    auto readingRing = std::make_shared<SharedReadingRing>(L"Local\\AccelerometerReadings", 4096);
+    pipeline->Subscribe(*hub, readingRing->Valid() ? readingRing : nullptr);
+    auto history = pipeline->History();
+
+    // summarize the history on demand: the readings kept, their size and the peak of the last minute
+    from(observable(inspect))
+        .subscribe([this, history](RoutedEventPattern)
+        {
+            // on the ui thread
+            long long oldest;
+            long long newest;
+            if (!history->Span(oldest, newest))
+            {
+                this->ScenarioOutput_History->Text = "No data";
+                return;
+            }
+            std::wostringstream out;
+            out << history->Samples() << L" readings over " << (newest - oldest) / 10000000 << L" s in "
+                << (history->Bytes() + 1023) / 1024 << L" KB";
+            double peak;
+            if (history->MaximumMagnitude(newest - 60LL * 10000000, newest, peak))
+            {
+                out << L", peak " << peak << L" g in the last minute";
+            }
+            std::wstring text = out.str();
+            this->ScenarioOutput_History->Text = ref new String(text.c_str(), static_cast<unsigned int>(text.size()));
+        });
+
+    // resample to exactly the report interval, which is chosen when the sensor is found
+    auto uniformReadings = Resample(sharedReadings, [this]()
+    {
+        return static_cast<long long>(this->desiredReportInterval) * 10000;
+    });
+
+    // classify the activity of each window of 64 readings, about a second, on the worker pool:
+    // the windows are cut in order by one stage and classified in parallel by the next, and the
+    // ui thread only shows the results, in order
+    auto analyzedReadings = from(uniformReadings)
+        .select([pipeline](SensorSample sample)
+        {
+            // on sensor thread
+            pipeline->Analyze(sample);
+            return sample;
+        });
+
+    // push readings to ui thread, holding no more than a quarter second of them if it stalls
+    auto readingChanged = from(ObserveOnBounded(observable(analyzedReadings),
+            OverflowPolicy::DropOldest, 16, std::chrono::steady_clock::duration::zero(),
+            DispatcherScheduler(Dispatcher), L"Scenario1 ui queue"))
         .publish()
         .ref_count();
 
@@ -141,66 +274,169 @@ Scenario1::Scenario1() :
                 return !n; 
             }));
 
-    from(enable->RegisterAsyncFunction(
-        [](RoutedEventPattern)
+    // the sensor warm-up, which seeds the calibration, is cancelled when the scenario ends
+    auto warmup = std::make_shared<CancellableWork>();
+
+    from(observable(enable))
+        .subscribe([this, weakThis, dispatcher, warmup, pipeline](RoutedEventPattern)
         {
-            // background thread
-            // enable and disable commands will be disabled until this is finished
+            // on the ui thread, after the accelerometer is acquired
+            pipeline->Restart();
+            auto accelerometer = this->accelerometer;
+            if (accelerometer == nullptr)
+            {
+                return;
+            }
 
-            std::this_thread::sleep_for(std::chrono::seconds(2));
+            // each step of the warm-up polls once on the worker pool that every page shares,
+            // and no thread is held between polls or once disable cancels it
+            warmup->Queued();
+            auto interval = std::chrono::milliseconds((std::max<uint32>)(this->desiredReportInterval, 16));
+            Scenario1Pipeline::Warmup(pipeline, warmup, WorkerPoolScheduler(SensorManager::Workers()), interval,
+                [accelerometer](SensorSample& sample) -> bool
+                {
+                    // on a worker thread
+                    auto reading = accelerometer->GetCurrentReading();
+                    if (reading == nullptr)
+                    {
+                        return false;
+                    }
+                    SensorSample polled = {
+                        reading->Timestamp.UniversalTime,
+                        reading->AccelerationX,
+                        reading->AccelerationY,
+                        reading->AccelerationZ,
+                        SensorSample::clock::now()};
+                    sample = polled;
+                    return true;
+                },
+                [weakThis, dispatcher](bool seeded)
+                {
+                    // on a worker thread
+                    if (seeded)
+                    {
+                        return;
+                    }
+                    dispatcher->RunAsync(CoreDispatcherPriority::Normal, ref new DispatchedHandler([weakThis]()
+                    {
+                        // on the ui thread
+                        auto page = weakThis.Resolve<Scenario1>();
+                        if (page != nullptr)
+                        {
+                            page->rootPage->NotifyUser("Accelerometer warm-up was cancelled", NotifyType::StatusMessage);
+                        }
+                    }));
+                });
+        });
 
-            return true;
-        })) // this is a subscription to the enable ReactiveCommand
-        // back on the ui thread
-        .subscribe([this](bool) // takes whatever was returned above
+    // compose the enabled and visible graphs once, so that enable and visibility changes
+    // only subscribe to them instead of building new operator chains each time
+    auto inputWhileVisible = observable(from(readingChanged)
+        .take_until(invisible));
+
+    auto inputWhileEnabled = observable(from(visible)
+        .select_many([=](bool)
         {
-            // update the ui
-        });
+            // enable sensor input 
+            return rx::from(inputWhileVisible);
+        })
+        .take_until(endScenario)); // this is a subscription to the disable ReactiveCommand
 
     // enable the scenario when enable is executed
     from(observable(enable))
         .where([this](RoutedEventPattern)
         {
-            return this->accelerometer != nullptr;
+            return this->AcquireAccelerometer();
         })
         .select_many([=](RoutedEventPattern)
         {
-            return from(visible)
-                .select_many([=](bool)
-                {
-                    // enable sensor input 
-                    return rx::from(readingChanged)
-                        .take_until(invisible);
-                })
-                .take_until(endScenario); // this is a subscription to the disable ReactiveCommand
+            return rx::from(inputWhileEnabled);
         })
-        .subscribe([this](AccelerometerReading^ reading)
+        .subscribe([this, pipeline](SensorSample sample)
         {
             // on the ui thread
-            this->ScenarioOutput_X->Text = reading->AccelerationX.ToString();
-            this->ScenarioOutput_Y->Text = reading->AccelerationY.ToString();
-            this->ScenarioOutput_Z->Text = reading->AccelerationZ.ToString();
+            AllocationScope scope(AllocationStage::Ui);
+
+            this->ScenarioOutput_X->Text = sample.X.ToString();
+            this->ScenarioOutput_Y->Text = sample.Y.ToString();
+            this->ScenarioOutput_Z->Text = sample.Z.ToString();
+
+            // the rolling statistics of the magnitude over the last 64 readings, about a second
+            auto magnitude = pipeline->Show(sample);
+            this->ScenarioOutput_Rms->Text = magnitude.Rms.ToString();
+            this->ScenarioOutput_Peak->Text = magnitude.Peak().ToString();
+
+            // measures the time from the sensor thread to the ui update
+            pipeline->Shown(sample);
+        });
+
+    // cancel the warm-up, classify the last windows, clear the statistics, save the calibration and report the pipeline metrics each time the scenario ends
+    endScenario
+        .subscribe([pipeline, warmup, history](bool)
+        {
+            warmup->Cancel();
+            pipeline->End();
+            CalibrationStore::Save(pipeline->Calibration());
+
+            DebugOutput([warmup, history]()
+            {
+                std::wostringstream out;
+                out << warmup->Report(L"Scenario1 warm-up") << history->Report(L"Scenario1 history");
+
+                // answered from the chunk summaries, decoding at most the chunk still being filled
+                double peak;
+                if (history->MaximumMagnitude((std::numeric_limits<long long>::min)(), (std::numeric_limits<long long>::max)(), peak))
+                {
+                    out << L"Scenario1 history: peak magnitude=" << peak
+                        << L" chunks above 1.5g rms=" << history->ChunksAbove(1.5, [](const BlockSummary&) {})
+                        << L"\n";
+                }
+                return out.str();
+            });
+
+            if (pipeline->Metrics().Samples() != 0)
+            {
+                DebugOutput([pipeline]()
+                {
+                    auto arbiter = SensorManager::Accelerometer();
+                    return pipeline->Metrics().Report(L"Scenario1 readings") +
+                        (arbiter != nullptr ? arbiter->Report(L"Scenario1 accelerometer") : std::wstring());
+                });
+                pipeline->Metrics().Reset();
+            }
         });
 
     rxrt::BindCommand(ScenarioEnableButton, enable);
 
     rxrt::BindCommand(ScenarioDisableButton, disable);
 
-    accelerometer = Accelerometer::GetDefault();
-    if (accelerometer != nullptr)
-    {
-        // Select a report interval that is both suitable for the purposes of the app and supported by the sensor.
-        // This value will be used later to activate the sensor.
-        uint32 minReportInterval = accelerometer->MinimumReportInterval;
-        desiredReportInterval = minReportInterval > 16 ? minReportInterval : 16;
+    rxrt::BindCommand(ScenarioInspectButton, inspect);
+}
 
-        // Establish the report interval
-        accelerometer->ReportInterval = desiredReportInterval;
-    }
-    else
+/// <summary>
+/// Acquires the accelerometer the first time the scenario is enabled, so that constructing the page
+/// does not wait for the sensor.  Returns false when there is no accelerometer.
+/// </summary>
+bool Scenario1::AcquireAccelerometer()
+{
+    if (!accelerometerChecked)
     {
-        rootPage->NotifyUser("No accelerometer found", NotifyType::ErrorMessage);
+        accelerometerChecked = true;
+        accelerometer = DeferredAccelerometer::Get();
+        if (accelerometer != nullptr)
+        {
+            // Select a report interval that is both suitable for the purposes of the app and supported by the sensor.
+            // This value will be requested from the sensor manager when the sensor is activated, which
+            // runs the sensor at the shortest interval requested by any scenario.
+            uint32 minReportInterval = accelerometer->MinimumReportInterval;
+            desiredReportInterval = minReportInterval > 16 ? minReportInterval : 16;
+        }
+        else
+        {
+            rootPage->NotifyUser("No accelerometer found", NotifyType::ErrorMessage);
+        }
     }
+    return accelerometer != nullptr;
 }
 
 /// <summary>
@@ -15,8 +15,14 @@
 
 #include "pch.h"
 #include "Scenario2.xaml.h"
+#include "Common\DeferredAccelerometer.h"
+#include "Common\PipelineMetrics.h"
+#include "Common\SensorOperators.h"
+#include "Common\ScenarioPipelines.h"
+#include "Common\DebugOutput.h"
 
 using namespace SDKSample::AccelerometerCPP;
+using namespace SDKSample::Common;
 
 using namespace Windows::UI::Xaml;
 using namespace Windows::UI::Xaml::Controls;
@@ -28,8 +34,9 @@ using namespace Platform;
 
 Scenario2::Scenario2() : 
     rootPage(MainPage::Current), 
+    accelerometerChecked(false),
     navigated(std::make_shared < rx::BehaviorSubject < bool >> (true)),
-    shakeCounter(0)
+    gestureCount(0)
 {
     InitializeComponent();
 
@@ -53,13 +60,17 @@ Scenario2::Scenario2() :
     // when enable is executed mark the scenario enabled, when disable is executed mark the scenario disabled
     observable(from(observable(enable))
         .select([this](RoutedEventPattern){
-            return this->accelerometer != nullptr; })
+            return this->AcquireAccelerometer(); })
         .merge(observable(from(observable(disable)).select([](RoutedEventPattern){
             return false; }))))
         ->Subscribe(observer(enabled));
 
+    // shakes less than half a second apart are one gesture
+    const long long shakeGap = 5000000;
+    auto pipeline = std::make_shared<Scenario2Pipeline>(shakeGap);
+
     typedef TypedEventHandler<Accelerometer^, AccelerometerShakenEventArgs^> AccelerometerShakenTypedEventHandler;
-    auto shaken = from(rxrt::FromEventPattern<AccelerometerShakenTypedEventHandler>(
+    auto shakes = observable(from(rxrt::FromEventPattern<AccelerometerShakenTypedEventHandler>(
         [this](AccelerometerShakenTypedEventHandler^ h)
         {
             return this->accelerometer->Shaken += h;
@@ -71,10 +82,62 @@ Scenario2::Scenario2() :
         .select([this](rxrt::EventPattern<Accelerometer^, AccelerometerShakenEventArgs^> e)
         {
             // on the sensor thread
-            return ++this->shakeCounter;
+            // charge everything allocated on the sensor thread to the sensor stage
+            AllocationCounter::Enter(AllocationStage::Sensor);
+
+            // the intensity is the magnitude of the acceleration when the shake is reported
+            double intensity = 0.0;
+            auto reading = this->accelerometer->GetCurrentReading();
+            if (reading != nullptr)
+            {
+                intensity = Scenario2Pipeline::Intensity(reading->AccelerationX, reading->AccelerationY, reading->AccelerationZ);
+            }
+            return std::make_pair(e.EventArgs()->Timestamp.UniversalTime, intensity);
+        }));
+
+    // a gesture is closed by the first shake after the gap, on the sensor thread ...
+    auto closedByShake = from(Expand<ShakeGesture>(shakes,
+        [pipeline]()
+        {
+            return pipeline;
+        },
+        [](std::shared_ptr<Scenario2Pipeline>& state, const std::pair<long long, double>& shake, const std::function<void(const ShakeGesture&)>& emit)
+        {
+            ShakeGesture completed;
+            if (state->Shake(shake.first, shake.second, completed))
+            {
+                emit(completed);
+            }
+        }))
+        // push only whole gestures to ui thread
+        .observe_on_dispatcher();
+
+    // ... or by a ui thread timer once the gap has passed without one
+    auto closedByTimer = from(rxrt::DispatcherInterval(std::chrono::milliseconds(shakeGap / 10000)))
+        .select([pipeline](size_t)
+        {
+            // the shake timestamps are system time in 100ns units since 1601, as is a FILETIME
+            FILETIME now;
+            GetSystemTimeAsFileTime(&now);
+            ULARGE_INTEGER ticks;
+            ticks.LowPart = now.dwLowDateTime;
+            ticks.HighPart = now.dwHighDateTime;
+
+            ShakeGesture completed;
+            bool closed = pipeline->Flush(static_cast<long long>(ticks.QuadPart), completed);
+            return std::make_pair(closed, completed);
+        })
+        .where([](std::pair<bool, ShakeGesture> flushed)
+        {
+            return flushed.first;
         })
-        // push shaken to ui thread
-        .observe_on_dispatcher()
+        .select([](std::pair<bool, ShakeGesture> flushed)
+        {
+            return flushed.second;
+        });
+
+    auto shaken = closedByShake
+        .merge(observable(closedByTimer))
         .publish()
         .ref_count();
 
@@ -127,39 +190,81 @@ Scenario2::Scenario2() :
                 return !n;
             }));
 
+    // compose the enabled and visible graphs once, so that enable and visibility changes
+    // only subscribe to them instead of building new operator chains each time
+    auto inputWhileVisible = observable(from(shaken)
+        .take_until(invisible));
+
+    auto inputWhileEnabled = observable(from(visible)
+        .select_many([=](bool)
+        {
+            // enable sensor input 
+            return rx::from(inputWhileVisible);
+        })
+        .take_until(endScenario));
+
     // enable the scenario when enable is executed
     from(observable(enable))
         // stay on the ui thread
         .where([this](RoutedEventPattern)
         {
-            return this->accelerometer != nullptr;
+            return this->AcquireAccelerometer();
         })
         .select_many([=](RoutedEventPattern)
         {
-            return from(visible)
-                .select_many([=](bool)
-                {
-                    // enable sensor input 
-                    return rx::from(shaken)
-                        .take_until(invisible);
-                })
-                .take_until(endScenario);
+            return rx::from(inputWhileEnabled);
         })
-        .subscribe([this](uint16 value)
+        .subscribe([this, pipeline](ShakeGesture gesture)
         {
-            // on the ui thread
-            this->ScenarioOutputText->Text = value.ToString();
+            // on the ui thread, once per gesture
+            AllocationScope scope(AllocationStage::Ui);
+
+            this->ScenarioOutputText->Text = (++this->gestureCount).ToString();
+            this->ScenarioOutput_Events->Text = gesture.Events.ToString();
+            this->ScenarioOutput_Duration->Text = (gesture.Duration() / 10000).ToString();
+            this->ScenarioOutput_Peak->Text = gesture.PeakIntensity.ToString();
+
+            // measures the time from the sensor thread to the ui update
+            pipeline->Shown(gesture);
+        });
+
+    // drop a gesture in progress and report the pipeline metrics each time the scenario ends
+    endScenario
+        .subscribe([pipeline](bool)
+        {
+            pipeline->End();
+
+            if (pipeline->Metrics().Samples() != 0)
+            {
+                DebugOutput([pipeline]()
+                {
+                    return pipeline->Metrics().Report(L"Scenario2 shakes");
+                });
+                pipeline->Metrics().Reset();
+            }
         });
 
     rxrt::BindCommand(ScenarioEnableButton, enable);
 
     rxrt::BindCommand(ScenarioDisableButton, disable);
+}
 
-    accelerometer = Accelerometer::GetDefault();
-    if (accelerometer == nullptr)
+/// <summary>
+/// Acquires the accelerometer the first time the scenario is enabled, so that constructing the page
+/// does not wait for the sensor.  Returns false when there is no accelerometer.
+/// </summary>
+bool Scenario2::AcquireAccelerometer()
+{
+    if (!accelerometerChecked)
     {
-        rootPage->NotifyUser("No accelerometer found", NotifyType::ErrorMessage);
+        accelerometerChecked = true;
+        accelerometer = DeferredAccelerometer::Get();
+        if (accelerometer == nullptr)
+        {
+            rootPage->NotifyUser("No accelerometer found", NotifyType::ErrorMessage);
+        }
     }
+    return accelerometer != nullptr;
 }
 
 /// <summary>
@@ -18,6 +18,7 @@
 #include "pch.h"
 #include "Scenario2.g.h"
 #include "MainPage.xaml.h"
+#include "Common\PipelineMetrics.h"
 
 namespace SDKSample
 {
@@ -39,13 +40,18 @@ namespace SDKSample
         private:
             typedef rxrt::EventPattern<Object^, Windows::UI::Xaml::RoutedEventArgs^> RoutedEventPattern;
 
+            bool AcquireAccelerometer();
+
             MainPage^ rootPage;
             Windows::UI::Core::CoreDispatcher^ dispatcher;
+            // acquired when the scenario is first enabled
             Windows::Devices::Sensors::Accelerometer^ accelerometer;
+            bool accelerometerChecked;
             std::shared_ptr<rx::BehaviorSubject<bool>> navigated;
             rxrt::ReactiveCommand<RoutedEventPattern>::shared enable;
             rxrt::ReactiveCommand<RoutedEventPattern>::shared disable;
-            uint16 shakeCounter;
+            // only used on the ui thread
+            uint32 gestureCount;
         };
     }
 }
@@ -15,8 +15,17 @@
 
 #include "pch.h"
 #include "Scenario3.xaml.h"
+#include "Common\DeferredAccelerometer.h"
+#include "Common\SensorManager.h"
+#include "Common\SensorSample.h"
+#include "Common\PipelineMetrics.h"
+#include "Common\CalibrationStore.h"
+#include "Common\SensorOperators.h"
+#include "Common\ScenarioPipelines.h"
+#include "Common\DebugOutput.h"
 
 using namespace SDKSample::AccelerometerCPP;
+using namespace SDKSample::Common;
 
 using namespace Windows::UI::Xaml;
 using namespace Windows::UI::Xaml::Controls;
@@ -28,6 +37,7 @@ using namespace Platform;
 
 Scenario3::Scenario3() : 
     rootPage(MainPage::Current), 
+    accelerometerChecked(false),
     navigated(std::make_shared < rx::BehaviorSubject < bool >> (true)),
     desiredReportInterval(0)
 {
@@ -53,12 +63,23 @@ Scenario3::Scenario3() :
     // when enable is executed mark the scenario enabled, when disable is executed mark the scenario disabled
     observable(from(observable(enable))
         .select([this](RoutedEventPattern){
-            return this->accelerometer != nullptr; })
+            return this->AcquireAccelerometer(); })
         .merge(observable(from(observable(disable)).select([](RoutedEventPattern){
             return false; }))))
         ->Subscribe(observer(enabled));
 
-    auto currentReading = from(rxrt::DispatcherInterval(std::chrono::milliseconds(desiredReportInterval)))
+    // correct the polled readings with the calibration fitted in Scenario1
+    auto pipeline = std::make_shared<Scenario3Pipeline>(CalibrationStore::Load());
+
+    // the poll timer is created when polling starts, once the report interval is known, and
+    // ticks on the ui thread
+    auto dispatcher = Dispatcher;
+    auto polls = Defer<size_t>([this, dispatcher]()
+    {
+        return Interval(std::chrono::milliseconds(this->desiredReportInterval), DispatcherScheduler(dispatcher));
+    });
+
+    auto polledReadings = from(polls)
         .select([this](size_t)
         {
             return this->accelerometer->GetCurrentReading();
@@ -67,6 +88,27 @@ Scenario3::Scenario3() :
         {
             return r != nullptr;
         })
+        .select([pipeline](AccelerometerReading^ reading) -> SensorSample
+        {
+            SensorSample sample = {
+                reading->Timestamp.UniversalTime,
+                reading->AccelerationX,
+                reading->AccelerationY,
+                reading->AccelerationZ,
+                SensorSample::clock::now()};
+            return pipeline->Calibrate(sample);
+        });
+
+    // hold the sensor at our interval while polling, and skip a reading that was already shown
+    auto currentReading = from(Arbitrate(observable(polledReadings),
+        []()
+        {
+            return SensorManager::Accelerometer();
+        },
+        [this]()
+        {
+            return this->desiredReportInterval;
+        }))
         .publish()
         .ref_count();
 
@@ -119,51 +161,88 @@ Scenario3::Scenario3() :
             return !n;
         }));
 
+    // compose the enabled and visible graphs once, so that enable and visibility changes
+    // only subscribe to them instead of building new operator chains each time
+    auto inputWhileVisible = observable(from(currentReading)
+        .take_until(invisible));
+
+    auto inputWhileEnabled = observable(from(visible)
+        .select_many([=](bool)
+        {
+            // enable sensor input 
+            return rx::from(inputWhileVisible);
+        })
+        .take_until(endScenario));
+
     // enable the scenario when enable is executed
     from(observable(enable))
         // stay on the ui thread
         .where([this](RoutedEventPattern)
         {
-            return this->accelerometer != nullptr;
+            return this->AcquireAccelerometer();
         })
         .select_many([=](RoutedEventPattern)
         {
-            return from(visible)
-                .select_many([=](bool)
-                {
-                    // enable sensor input 
-                    return rx::from(currentReading)
-                        .take_until(invisible);
-                })
-                .take_until(endScenario);
+            return rx::from(inputWhileEnabled);
         })
-        .subscribe([this](AccelerometerReading^ reading)
+        .subscribe([this, pipeline](SensorSample sample)
         {
             // on the ui thread
-            this->ScenarioOutput_X->Text = reading->AccelerationX.ToString();
-            this->ScenarioOutput_Y->Text = reading->AccelerationY.ToString();
-            this->ScenarioOutput_Z->Text = reading->AccelerationZ.ToString();
+            AllocationScope scope(AllocationStage::Ui);
+
+            this->ScenarioOutput_X->Text = sample.X.ToString();
+            this->ScenarioOutput_Y->Text = sample.Y.ToString();
+            this->ScenarioOutput_Z->Text = sample.Z.ToString();
+
+            // measures the time from the poll to the ui update
+            pipeline->Shown(sample);
+        });
+
+    // report the pipeline metrics each time the scenario ends
+    endScenario
+        .subscribe([pipeline](bool)
+        {
+            if (pipeline->Metrics().Samples() != 0)
+            {
+                DebugOutput([pipeline]()
+                {
+                    auto arbiter = SensorManager::Accelerometer();
+                    return pipeline->Metrics().Report(L"Scenario3 readings") +
+                        (arbiter != nullptr ? arbiter->Report(L"Scenario3 accelerometer") : std::wstring());
+                });
+                pipeline->Metrics().Reset();
+            }
         });
 
     rxrt::BindCommand(ScenarioEnableButton, enable);
 
     rxrt::BindCommand(ScenarioDisableButton, disable);
+}
 
-    accelerometer = Accelerometer::GetDefault();
-    if (accelerometer != nullptr)
-    {
-        // Select a report interval that is both suitable for the purposes of the app and supported by the sensor.
-        // This value will be used later to activate the sensor.
-        uint32 minReportInterval = accelerometer->MinimumReportInterval;
-        desiredReportInterval = minReportInterval > 16 ? minReportInterval : 16;
-
-        // Establish the report interval
-        accelerometer->ReportInterval = desiredReportInterval;
-    }
-    else
+/// <summary>
+/// Acquires the accelerometer the first time the scenario is enabled, so that constructing the page
+/// does not wait for the sensor.  Returns false when there is no accelerometer.
+/// </summary>
+bool Scenario3::AcquireAccelerometer()
+{
+    if (!accelerometerChecked)
     {
-        rootPage->NotifyUser("No accelerometer found", NotifyType::ErrorMessage);
+        accelerometerChecked = true;
+        accelerometer = DeferredAccelerometer::Get();
+        if (accelerometer != nullptr)
+        {
+            // Select a report interval that is both suitable for the purposes of the app and supported by the sensor.
+            // This value will be requested from the sensor manager when polling starts, which
+            // runs the sensor at the shortest interval requested by any scenario.
+            uint32 minReportInterval = accelerometer->MinimumReportInterval;
+            desiredReportInterval = minReportInterval > 16 ? minReportInterval : 16;
+        }
+        else
+        {
+            rootPage->NotifyUser("No accelerometer found", NotifyType::ErrorMessage);
+        }
     }
+    return accelerometer != nullptr;
 }
 
 /// <summary>
@@ -39,9 +39,13 @@ namespace SDKSample
         private:
             typedef rxrt::EventPattern<Object^, Windows::UI::Xaml::RoutedEventArgs^> RoutedEventPattern;
 
+            bool AcquireAccelerometer();
+
             MainPage^ rootPage;
             Windows::UI::Core::CoreDispatcher^ dispatcher;
+            // acquired when the scenario is first enabled
             Windows::Devices::Sensors::Accelerometer^ accelerometer;
+            bool accelerometerChecked;
             std::shared_ptr<rx::BehaviorSubject<bool>> navigated;
             rxrt::ReactiveCommand<RoutedEventPattern>::shared enable;
             rxrt::ReactiveCommand<RoutedEventPattern>::shared disable;
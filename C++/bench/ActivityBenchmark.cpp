@@ -0,0 +1,110 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ActivityBenchmark.cpp
+// Windows classified per second by ActivityClassifier, on the bundled traces
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "CsvTrace.h"
+
+#include "ActivityClassifier.h"
+
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const size_t Window = 64;
+
+    void Report(const wchar_t* name, size_t windows, const Stopwatch& time, const AllocationDelta& allocations)
+    {
+        std::wcout << name << L": windows=" << windows
+            << L" windows/s=" << windows / time.Seconds()
+            << L" ns/window=" << time.Nanoseconds() / static_cast<double>(windows)
+            << allocations.PerSample(windows, L"window") << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+
+    // the traces back to back, with the timestamps made continuous
+    const char* names[] = {"still", "walking", "vibrating", "transit"};
+    std::vector<SensorSample> readings;
+    for (auto name : names)
+    {
+        auto trace = ReadCsvTrace(options.Traces + "/" + name + ".csv");
+        trace.resize(trace.size() / Window * Window);
+        readings.insert(readings.end(), trace.begin(), trace.end());
+    }
+    long long period = readings[1].Timestamp - readings[0].Timestamp;
+    for (size_t i = 0; i < readings.size(); ++i)
+    {
+        readings[i].Timestamp = static_cast<long long>(i) * period;
+    }
+    size_t passes = options.Count(2000);
+
+    {
+        // one classifier fed the stream, as a single consumer would
+        ActivityClassifier classifier(Window, period);
+        size_t windows = 0;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& sample : readings)
+            {
+                windows += classifier.Push(sample) ? 1 : 0;
+            }
+        }
+        Consume(static_cast<int>(classifier.Current()));
+        Report(L"reused classifier", windows, time, allocations);
+    }
+    {
+        // one classifier per worker handed whole windows, as the classify stage of Scenario1 does
+        ActivityClassifier classifier(Window, period);
+        size_t windows = 0;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (size_t begin = 0; begin < readings.size(); begin += Window)
+            {
+                Consume(static_cast<int>(classifier.Classify(&readings[begin], Window)));
+                ++windows;
+            }
+        }
+        Report(L"Classify per window", windows, time, allocations);
+    }
+    {
+        // a classifier made for each window
+        size_t windows = 0;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (size_t begin = 0; begin < readings.size(); begin += Window)
+            {
+                ActivityClassifier classifier(Window, period);
+                for (size_t i = begin; i < begin + Window; ++i)
+                {
+                    classifier.Push(readings[i]);
+                }
+                Consume(static_cast<int>(classifier.Current()));
+                ++windows;
+            }
+        }
+        Report(L"classifier per window", windows, time, allocations);
+    }
+    return 0;
+}
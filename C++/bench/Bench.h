@@ -0,0 +1,164 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// Bench.h
+// Command line options, timing and allocation accounting for the benchmarks
+//
+
+#pragma once
+
+#include "AllocationCounter.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <iostream>
+#include <string>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        /// <summary>
+        /// The options every benchmark takes: --quick for a short run that only shows that the
+        /// benchmark works, as ctest does, --scale N to multiply the amount of work and
+        /// --traces DIRECTORY for where the bundled traces are.
+        /// </summary>
+        struct Options
+        {
+            bool Quick;
+            double Scale;
+            std::string Traces;
+
+            static Options Parse(int argc, char** argv)
+            {
+                Options options = {false, 1.0, "traces"};
+                for (int i = 1; i < argc; ++i)
+                {
+                    if (std::strcmp(argv[i], "--quick") == 0)
+                    {
+                        options.Quick = true;
+                    }
+                    else if (std::strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+                    {
+                        options.Scale = std::atof(argv[++i]);
+                    }
+                    else if (std::strcmp(argv[i], "--traces") == 0 && i + 1 < argc)
+                    {
+                        options.Traces = argv[++i];
+                    }
+                }
+                return options;
+            }
+
+            /// <summary>
+            /// count scaled, and cut to a tenth for a quick run.
+            /// </summary>
+            size_t Count(size_t count) const
+            {
+                double scaled = static_cast<double>(count) * Scale * (Quick ? 0.1 : 1.0);
+                return scaled >= 1.0 ? static_cast<size_t>(scaled) : 1;
+            }
+        };
+
+        class Stopwatch
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+
+            Stopwatch() : started(clock::now())
+            {
+            }
+
+            void Restart()
+            {
+                started = clock::now();
+            }
+
+            double Seconds() const
+            {
+                return std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - started).count();
+            }
+
+            double Nanoseconds() const
+            {
+                return Seconds() * 1e9;
+            }
+
+        private:
+            clock::time_point started;
+        };
+
+        /// <summary>
+        /// Allocations made since construction, per AllocationStage.
+        /// </summary>
+        class AllocationDelta
+        {
+        public:
+            AllocationDelta() : start(Common::AllocationCounter::Snapshot())
+            {
+            }
+
+            void Restart()
+            {
+                start = Common::AllocationCounter::Snapshot();
+            }
+
+            unsigned long long Total() const
+            {
+                return Common::AllocationCounter::Snapshot().Total() - start.Total();
+            }
+
+            unsigned long long Stage(Common::AllocationStage stage) const
+            {
+                auto index = static_cast<int>(stage);
+                return Common::AllocationCounter::Snapshot().Counts[index] - start.Counts[index];
+            }
+
+            /// <summary>
+            /// " allocs/sample=T (other=O sensor=S ui=U)" for count samples, or count of another unit.
+            /// </summary>
+            std::wstring PerSample(unsigned long long count, const wchar_t* unit = L"sample") const
+            {
+                // one snapshot, before formatting allocates
+                auto now = Common::AllocationCounter::Snapshot();
+                double samples = count != 0 ? static_cast<double>(count) : 1.0;
+                std::wstring text = L" allocs/" + std::wstring(unit) + L"=" + Format(static_cast<double>(now.Total() - start.Total()) / samples) + L" (";
+                for (int i = 0; i < static_cast<int>(Common::AllocationStage::Count); ++i)
+                {
+                    auto stage = static_cast<Common::AllocationStage>(i);
+                    text += (i != 0 ? L" " : L"");
+                    text += Common::AllocationCounter::StageName(stage);
+                    text += L"=" + Format(static_cast<double>(now.Counts[i] - start.Counts[i]) / samples);
+                }
+                return text + L")";
+            }
+
+        private:
+            static std::wstring Format(double value)
+            {
+                wchar_t text[32];
+                std::swprintf(text, sizeof(text) / sizeof(text[0]), L"%.2f", value);
+                return text;
+            }
+
+            Common::AllocationSnapshot start;
+        };
+
+        /// <summary>
+        /// Keeps the optimizer from dropping a computation whose result is not used.
+        /// </summary>
+        template<class T>
+        void Consume(const T& value)
+        {
+            static volatile T sink;
+            sink = value;
+            static_cast<void>(sink);
+        }
+    }
+}
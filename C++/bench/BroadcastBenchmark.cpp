@@ -0,0 +1,133 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BroadcastBenchmark.cpp
+// Fan-out of a reading to 1 to 32 subscribers through BroadcastHub and through a locked subject
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "SyntheticSensor.h"
+
+#include "BroadcastHub.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // what publish().ref_count() does: a locked list of observers, each handed its own copy
+    class LockedSubject
+    {
+    public:
+        void Subscribe(std::function<void(SensorSample)> observer)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            observers.push_back(std::move(observer));
+        }
+
+        void OnNext(const SensorSample& sample)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (auto& observer : observers)
+            {
+                observer(sample);
+            }
+        }
+
+    private:
+        std::mutex lock;
+        std::vector<std::function<void(SensorSample)>> observers;
+    };
+
+    void Report(const wchar_t* name, size_t subscribers, size_t readings, const Stopwatch& time, const AllocationDelta& allocations)
+    {
+        double nanoseconds = time.Nanoseconds();
+        std::wcout << name << L": subscribers=" << subscribers
+            << L" ns/reading=" << nanoseconds / readings
+            << L" ns/delivery=" << nanoseconds / (readings * subscribers)
+            << allocations.PerSample(readings, L"reading") << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(1000000);
+
+    SyntheticAccelerometer source(100.0, 4);
+    std::vector<SensorSample> readings;
+    for (size_t i = 0; i < 4096; ++i)
+    {
+        readings.push_back(source.Next());
+    }
+
+    const size_t subscriberCounts[] = {1, 2, 4, 8, 16, 32};
+    for (auto subscribers : subscriberCounts)
+    {
+        // each subscriber reads the reading, as the recorder, statistics and ui do
+        std::vector<double> sums(subscribers, 0.0);
+
+        BroadcastHub<SensorBatch> hub;
+        for (size_t s = 0; s < subscribers; ++s)
+        {
+            double* sum = &sums[s];
+            hub.Subscribe([sum](const BroadcastHub<SensorBatch>::Block& batch)
+            {
+                for (size_t i = 0; i < batch->Count; ++i)
+                {
+                    *sum += batch->Samples[i].X;
+                }
+            });
+        }
+        hub.Publish(hub.Allocate());
+        {
+            AllocationDelta allocations;
+            Stopwatch time;
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto batch = hub.Allocate();
+                batch->Count = 1;
+                batch->Samples[0] = readings[i % readings.size()];
+                hub.Publish(batch);
+            }
+            Report(L"hub", subscribers, count, time, allocations);
+        }
+
+        LockedSubject subject;
+        for (size_t s = 0; s < subscribers; ++s)
+        {
+            double* sum = &sums[s];
+            subject.Subscribe([sum](SensorSample sample)
+            {
+                *sum += sample.X;
+            });
+        }
+        {
+            AllocationDelta allocations;
+            Stopwatch time;
+            for (size_t i = 0; i < count; ++i)
+            {
+                subject.OnNext(readings[i % readings.size()]);
+            }
+            Report(L"locked subject", subscribers, count, time, allocations);
+        }
+
+        double total = 0.0;
+        for (auto sum : sums)
+        {
+            total += sum;
+        }
+        Consume(total);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CalibrationBenchmark.cpp
+// The cost of SensorCalibration::Update and Apply per reading
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "SyntheticSensor.h"
+
+#include "SensorCalibration.h"
+
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    void Report(const wchar_t* name, size_t count, const Stopwatch& time, const AllocationDelta& allocations)
+    {
+        std::wcout << name << L": readings=" << count
+            << L" ns/reading=" << time.Nanoseconds() / static_cast<double>(count)
+            << allocations.PerSample(count, L"reading") << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(1000000);
+
+    // a device that sways, as in the hand, and one lying still, where every window is fitted
+    SyntheticAccelerometer moving(100.0, 1);
+    SyntheticAccelerometer still(100.0, 2);
+    still.Sway = 0.0;
+    still.Noise = 0.005;
+    std::vector<SensorSample> movingReadings;
+    std::vector<SensorSample> stillReadings;
+    for (size_t i = 0; i < count; ++i)
+    {
+        movingReadings.push_back(moving.Next());
+        stillReadings.push_back(still.Next());
+    }
+
+    {
+        SensorCalibration calibration;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (auto& sample : movingReadings)
+        {
+            calibration.Update(sample);
+        }
+        Report(L"Update, moving", count, time, allocations);
+    }
+    {
+        SensorCalibration calibration;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (auto& sample : stillReadings)
+        {
+            calibration.Update(sample);
+        }
+        Report(L"Update, still", count, time, allocations);
+        std::wcout << L"  stationary periods fitted=" << calibration.Points() << L"\n";
+    }
+    {
+        SensorCalibration calibration;
+        AllocationDelta allocations;
+        Stopwatch time;
+        double sum = 0.0;
+        for (auto& sample : movingReadings)
+        {
+            sum += calibration.Apply(sample).X;
+        }
+        Consume(sum);
+        Report(L"Apply", count, time, allocations);
+    }
+    return 0;
+}
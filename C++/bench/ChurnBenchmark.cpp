@@ -0,0 +1,98 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ChurnBenchmark.cpp
+// Subscribes and unsubscribes the per-subscription state of the scenario operators
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "DispatcherThread.h"
+
+#include "SensorArbiter.h"
+#include "BroadcastHub.h"
+#include "BoundedQueue.h"
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    void Report(const wchar_t* name, size_t cycles, const Stopwatch& time, const AllocationDelta& allocations)
+    {
+        std::wcout << name << L": cycles=" << cycles
+            << L" ns/cycle=" << time.Nanoseconds() / static_cast<double>(cycles)
+            << allocations.PerSample(cycles, L"cycle") << L"\n";
+    }
+}
+
+// Each enable or visibility change of a page subscribes Arbitrate, Broadcast and
+// ObserveOnBounded, which acquire a consumer from the arbiter, add a subscriber to the hub and
+// make a bounded queue, and release them again on unsubscribe.  The rx observers and
+// disposables around them are allocated inside rxcpp and are not measured here; the page
+// graphs are composed once so that churn adds nothing else.
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t cycles = options.Count(100000);
+
+    DispatcherThread ui;
+    SensorArbiter arbiter(1, [](unsigned int) {});
+    BroadcastHub<SensorBatch> hub;
+    // the other pages' subscriptions stay in place while one page churns
+    auto keep = arbiter.Acquire(16);
+    hub.Subscribe([](const BroadcastHub<SensorBatch>::Block&) {});
+
+    {
+        Stopwatch time;
+        AllocationDelta allocations;
+        for (size_t i = 0; i < cycles; ++i)
+        {
+            arbiter.Release(arbiter.Acquire(16));
+        }
+        Report(L"arbiter", cycles, time, allocations);
+    }
+    {
+        Stopwatch time;
+        AllocationDelta allocations;
+        for (size_t i = 0; i < cycles; ++i)
+        {
+            hub.Unsubscribe(hub.Subscribe([](const BroadcastHub<SensorBatch>::Block&) {}));
+        }
+        Report(L"hub", cycles, time, allocations);
+    }
+    {
+        Stopwatch time;
+        AllocationDelta allocations;
+        for (size_t i = 0; i < cycles; ++i)
+        {
+            auto queue = std::make_shared<BoundedQueue<SensorSample>>(OverflowPolicy::DropOldest, 16,
+                BoundedQueue<SensorSample>::clock::duration::zero(), ui.Scheduler(), [](const SensorSample&) {});
+            queue->Close();
+        }
+        Report(L"bounded queue", cycles, time, allocations);
+    }
+    {
+        Stopwatch time;
+        AllocationDelta allocations;
+        for (size_t i = 0; i < cycles; ++i)
+        {
+            auto consumer = arbiter.Acquire(16);
+            auto token = hub.Subscribe([](const BroadcastHub<SensorBatch>::Block&) {});
+            auto queue = std::make_shared<BoundedQueue<SensorSample>>(OverflowPolicy::DropOldest, 16,
+                BoundedQueue<SensorSample>::clock::duration::zero(), ui.Scheduler(), [](const SensorSample&) {});
+            queue->Close();
+            hub.Unsubscribe(token);
+            arbiter.Release(consumer);
+        }
+        Report(L"page activation", cycles, time, allocations);
+    }
+
+    arbiter.Release(keep);
+    return 0;
+}
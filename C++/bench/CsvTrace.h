@@ -0,0 +1,57 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CsvTrace.h
+// Reads the bundled traces in bench/traces
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        /// <summary>
+        /// Reads a trace of "timestamp,x,y,z" lines, with the timestamp in 100ns units and the
+        /// axes in g.  Lines that start with # are comments.  Throws std::runtime_error when the
+        /// file cannot be read or a line is not a reading.
+        /// </summary>
+        inline std::vector<Common::SensorSample> ReadCsvTrace(const std::string& path)
+        {
+            std::ifstream file(path.c_str());
+            if (!file)
+            {
+                throw std::runtime_error("cannot open " + path);
+            }
+            std::vector<Common::SensorSample> readings;
+            std::string line;
+            while (std::getline(file, line))
+            {
+                if (line.empty() || line[0] == '#')
+                {
+                    continue;
+                }
+                Common::SensorSample sample;
+                if (std::sscanf(line.c_str(), "%lld,%lf,%lf,%lf", &sample.Timestamp, &sample.X, &sample.Y, &sample.Z) != 4)
+                {
+                    throw std::runtime_error("not a reading in " + path + ": " + line);
+                }
+                sample.Received = Common::SensorSample::clock::now();
+                readings.push_back(sample);
+            }
+            return readings;
+        }
+    }
+}
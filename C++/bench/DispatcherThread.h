@@ -0,0 +1,150 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// DispatcherThread.h
+// Declaration of the DispatcherThread class
+//
+
+#pragma once
+
+#include "AllocationCounter.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        /// <summary>
+        /// Stands in for the ui thread of the app: one thread that runs posted work in order and
+        /// delayed work when it is due, like CoreDispatcher::RunAsync and a ThreadPoolTimer that
+        /// posts to it.  Allocations on the thread are charged to AllocationStage::Ui.
+        /// </summary>
+        class DispatcherThread
+        {
+        public:
+            typedef std::chrono::steady_clock clock;
+            typedef std::function<void()> Work;
+
+            DispatcherThread() : stopping(false), running(false), nextId(0)
+            {
+                thread = std::thread([this]()
+                {
+                    Run();
+                });
+            }
+
+            ~DispatcherThread()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    stopping = true;
+                }
+                changed.notify_all();
+                thread.join();
+            }
+
+            void Post(Work work)
+            {
+                Schedule(clock::duration::zero(), std::move(work));
+            }
+
+            void Schedule(clock::duration delay, Work work)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    queue.insert(std::make_pair(std::make_pair(clock::now() + delay, nextId++), std::move(work)));
+                }
+                changed.notify_all();
+            }
+
+            /// <summary>
+            /// A scheduler for BoundedQueue and ObserveOnBounded that runs on this thread.
+            /// </summary>
+            std::function<void(clock::duration, Work)> Scheduler()
+            {
+                return [this](clock::duration delay, Work work)
+                {
+                    Schedule(delay, std::move(work));
+                };
+            }
+
+            /// <summary>
+            /// Waits until no work is due and none is running, e.g. to read results that the
+            /// thread produced.  Work scheduled in the future is not waited for.
+            /// </summary>
+            void Idle()
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [this]()
+                {
+                    return !running && (queue.empty() || queue.begin()->first.first > clock::now());
+                });
+            }
+
+            /// <summary>
+            /// Drops the work that is scheduled in the future.
+            /// </summary>
+            void CancelDelayed()
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                auto now = clock::now();
+                for (auto it = queue.begin(); it != queue.end();)
+                {
+                    it = it->first.first > now ? queue.erase(it) : std::next(it);
+                }
+            }
+
+        private:
+            DispatcherThread(const DispatcherThread&);
+            DispatcherThread& operator=(const DispatcherThread&);
+
+            void Run()
+            {
+                Common::AllocationCounter::Enter(Common::AllocationStage::Ui);
+                std::unique_lock<std::mutex> guard(lock);
+                while (!stopping)
+                {
+                    if (queue.empty())
+                    {
+                        changed.wait(guard);
+                        continue;
+                    }
+                    auto due = queue.begin()->first.first;
+                    if (due > clock::now())
+                    {
+                        changed.wait_until(guard, due);
+                        continue;
+                    }
+                    Work work = std::move(queue.begin()->second);
+                    queue.erase(queue.begin());
+                    running = true;
+                    guard.unlock();
+                    work();
+                    work = nullptr;
+                    guard.lock();
+                    running = false;
+                    changed.notify_all();
+                }
+            }
+
+            std::mutex lock;
+            std::condition_variable changed;
+            std::map<std::pair<clock::time_point, unsigned long long>, Work> queue;
+            bool stopping;
+            bool running;
+            unsigned long long nextId;
+            std::thread thread;
+        };
+    }
+}
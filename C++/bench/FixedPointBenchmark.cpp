@@ -0,0 +1,95 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// FixedPointBenchmark.cpp
+// The per-reading cost of the statistics behind Scenario1 on the double path and on the
+// fixed-point path of the ARM builds, and how far apart their results are
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "SyntheticSensor.h"
+
+#include "FixedPoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // pushes each reading and reads the magnitude, as Scenario1 does for every reading shown
+    template<class ReadingStatistics>
+    double Run(ReadingStatistics& statistics, const std::vector<SensorSample>& samples, size_t count, std::vector<Statistics>& results)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            statistics.Push(samples[i % samples.size()]);
+            auto magnitude = statistics.Magnitude();
+            sum += magnitude.Rms;
+            if (i < results.size())
+            {
+                results[i] = magnitude;
+            }
+        }
+        return sum;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(4000000);
+
+    // a device shaken now and then, so the extremes move
+    SyntheticAccelerometer sensor(60.0, 47);
+    sensor.Sway = 1.0;
+    std::vector<SensorSample> samples(1 << 16);
+    for (auto& sample : samples)
+    {
+        sample = sensor.Next();
+    }
+
+    const size_t windows[] = {64, 1024};
+    for (auto window : windows)
+    {
+        std::vector<Statistics> doubleResults(samples.size());
+        std::vector<Statistics> fixedResults(samples.size());
+
+        SensorStatistics<SlidingStatistics> doubles(window);
+        AllocationDelta doubleAllocations;
+        Stopwatch time;
+        Consume(Run(doubles, samples, count, doubleResults));
+        double doubleTime = time.Nanoseconds() / count;
+
+        FixedSensorStatistics fixed(window);
+        AllocationDelta fixedAllocations;
+        time.Restart();
+        Consume(Run(fixed, samples, count, fixedResults));
+        double fixedTime = time.Nanoseconds() / count;
+
+        double worst = 0.0;
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            worst = (std::max)(worst, (std::max)(std::fabs(fixedResults[i].Mean - doubleResults[i].Mean),
+                (std::max)(std::fabs(fixedResults[i].Minimum - doubleResults[i].Minimum),
+                    std::fabs(fixedResults[i].Maximum - doubleResults[i].Maximum))));
+        }
+
+        std::wcout << L"window=" << window
+            << L" double ns/reading=" << doubleTime
+            << L" fixed ns/reading=" << fixedTime
+            << L" max magnitude error g=" << worst
+            << fixedAllocations.PerSample(count, L"reading") << L"\n";
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// HistoryBenchmark.cpp
+// The size of a reading in the CompressedHistory that Scenario1 keeps, how fast readings are
+// appended and how fast a range of them is scanned, for sensors with more and less jitter
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "SyntheticSensor.h"
+
+#include "CompressedHistory.h"
+
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Second = 10000000;
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(3000000);
+
+    // jitter as a fraction of the period: none, and 0.3ms and 1ms at 100 Hz
+    const double jitters[] = {0.0, 0.03, 0.1};
+    for (auto jitter : jitters)
+    {
+        SyntheticAccelerometer sensor(100.0, 48);
+        sensor.Jitter = jitter;
+        std::vector<SensorSample> readings(count);
+        for (auto& reading : readings)
+        {
+            reading = sensor.Next();
+        }
+
+        // no retention, so every reading stays
+        CompressedHistory history(1000LL * 24 * 3600 * Second, 512);
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (auto& reading : readings)
+        {
+            history.Append(reading);
+        }
+        double appendSeconds = time.Seconds();
+
+        // a tenth of the readings, from the middle
+        long long begin = readings[count / 2].Timestamp;
+        long long end = readings[count / 2 + count / 10].Timestamp;
+        double sum = 0.0;
+        time.Restart();
+        size_t scanned = history.Query(begin, end, [&](const SensorSample& sample)
+        {
+            sum += sample.X;
+        });
+        double scanSeconds = time.Seconds();
+        Consume(sum);
+
+        std::wcout << L"jitter=" << jitter * 100.0 << L"%"
+            << L" bytes/reading=" << static_cast<double>(history.Bytes()) / count
+            << L" (raw " << sizeof(long long) + 3 * sizeof(double) << L")"
+            << L" appends/s=" << count / appendSeconds
+            << L" scanned/s=" << scanned / scanSeconds
+            << allocations.PerSample(count, L"reading") << L"\n";
+    }
+    return 0;
+}
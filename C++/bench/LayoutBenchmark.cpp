@@ -0,0 +1,104 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// LayoutBenchmark.cpp
+// The layout work of a window drag when every size event relays out the main page, as it
+// used to, and when LayoutTracker coalesces the events into one update per frame.  It counts
+// the updates, input resizes and relayouts each way asks for and times the bookkeeping; the
+// XAML layout passes themselves cannot run here, so their cost is not in ns/event.
+//
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "LayoutTracker.h"
+
+#include <cmath>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // the work each event or update asks for
+    struct Work
+    {
+        size_t Updates;
+        size_t Resizes;
+        size_t Relayouts;
+    };
+
+    // the window width t seconds into a drag between 500 and 1366 pixels and back, once a
+    // second
+    double Width(double t)
+    {
+        const double pi = 3.14159265358979323846;
+        return 933.0 - 433.0 * std::cos(2.0 * pi * t);
+    }
+
+    void Report(const wchar_t* name, size_t events, const Work& work, const Stopwatch& time)
+    {
+        std::wcout << name << L": size events=" << events
+            << L" updates=" << work.Updates
+            << L" input resizes=" << work.Resizes
+            << L" relayouts=" << work.Relayouts
+            << L" ns/event=" << time.Nanoseconds() / static_cast<double>(events) << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    // size events at 500 a second, as a fast drag raises them, and frames at 60 a second
+    size_t events = options.Count(600000);
+    const double eventInterval = 1.0 / 500.0;
+    const double frameInterval = 1.0 / 60.0;
+
+    {
+        // each event resizes the input section and relays out the page
+        Work work = {0, 0, 0};
+        Stopwatch time;
+        for (size_t i = 0; i < events; ++i)
+        {
+            Consume(Width(i * eventInterval));
+            ++work.Updates;
+            ++work.Resizes;
+            ++work.Relayouts;
+        }
+        Report(L"every event", events, work, time);
+    }
+    {
+        // events schedule an update, which runs at the next frame with the latest width
+        LayoutTracker tracker;
+        Work work = {0, 0, 0};
+        double nextFrame = frameInterval;
+        double width = 0.0;
+        bool scheduled = false;
+        Stopwatch time;
+        for (size_t i = 0; i < events; ++i)
+        {
+            double t = i * eventInterval;
+            if (scheduled && t >= nextFrame)
+            {
+                auto changes = tracker.Update(width);
+                ++work.Updates;
+                work.Resizes += changes.Width ? 1 : 0;
+                work.Relayouts += changes.Bucket ? 1 : 0;
+                scheduled = false;
+            }
+            while (nextFrame <= t)
+            {
+                nextFrame += frameInterval;
+            }
+            width = Width(t);
+            scheduled = tracker.Schedule() || scheduled;
+        }
+        Report(L"coalesced per frame", events, work, time);
+    }
+    return 0;
+}
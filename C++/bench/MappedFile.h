@@ -0,0 +1,99 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// MappedFile.h
+// Declaration of the MappedFile class, which maps a file read only with POSIX mmap
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        /// <summary>
+        /// A file mapped read only for as long as the object lives, so a TraceFileReader can read
+        /// a recorded trace in place and the kernel pages in only what a query touches.
+        /// </summary>
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string& path) : memory(nullptr), bytes(0)
+            {
+                int file = open(path.c_str(), O_RDONLY);
+                struct stat status;
+                if (file < 0)
+                {
+                    return;
+                }
+                if (fstat(file, &status) == 0 && status.st_size > 0)
+                {
+                    void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+                    if (mapped != MAP_FAILED)
+                    {
+                        memory = mapped;
+                        bytes = static_cast<size_t>(status.st_size);
+                    }
+                }
+                close(file);
+            }
+
+            ~MappedFile()
+            {
+                if (memory != nullptr)
+                {
+                    munmap(memory, bytes);
+                }
+            }
+
+            /// <summary>
+            /// False when the file could not be opened or mapped, or is empty.
+            /// </summary>
+            bool Valid() const
+            {
+                return memory != nullptr;
+            }
+
+            const void* Data() const
+            {
+                return memory;
+            }
+
+            size_t Size() const
+            {
+                return bytes;
+            }
+
+            /// <summary>
+            /// Asks the kernel to drop the mapped pages from this process, so the next read of
+            /// each one faults it in again, as the first read after mapping does.
+            /// </summary>
+            void Evict()
+            {
+                if (memory != nullptr)
+                {
+                    madvise(memory, bytes, MADV_DONTNEED);
+                }
+            }
+
+        private:
+            MappedFile(const MappedFile&);
+            MappedFile& operator=(const MappedFile&);
+
+            void* memory;
+            size_t bytes;
+        };
+    }
+}
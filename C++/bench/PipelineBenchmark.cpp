@@ -0,0 +1,156 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// PipelineBenchmark.cpp
+// Runs the three scenario graphs on synthetic accelerometers at 100 Hz to 10 kHz.  The graphs
+// run the steps of the pages from ScenarioPipelines.h; the rx operators between them are
+// replaced by the classes they wrap, so rx and the Windows Runtime are not measured.
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "ScenarioGraphs.h"
+#include "SyntheticSensor.h"
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // readings are delivered at the rate of the source, or as fast as they can be made when unpaced
+    template<class Deliver>
+    void RunSource(SyntheticAccelerometer& source, size_t count, bool paced, Deliver deliver)
+    {
+        AllocationScope scope(AllocationStage::Sensor);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (paced)
+            {
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(static_cast<long long>(i * 1e9 / source.Rate())));
+            }
+            deliver(source.Next());
+        }
+    }
+
+    std::wstring Name(const wchar_t* scenario, double rate, bool paced)
+    {
+        std::wostringstream name;
+        name << scenario << L" " << rate << L" Hz" << (paced ? L"" : L" unpaced");
+        return name.str();
+    }
+
+    double Microseconds(std::chrono::nanoseconds duration)
+    {
+        return static_cast<double>(duration.count()) / 1000.0;
+    }
+
+    // allocations are per reading from the source, whether or not it was shown
+    void Print(const std::wstring& name, size_t readings, unsigned long long dropped, const AllocationDelta& allocations, const PipelineMetrics& metrics)
+    {
+        auto& latency = metrics.Latency();
+        std::wcout << name
+            << L": readings=" << readings
+            << L" shown=" << metrics.Samples()
+            << L" dropped=" << dropped
+            << L" throughput=" << metrics.Throughput() << L"/s"
+            << L" p50=" << Microseconds(latency.Percentile(0.50)) << L"us"
+            << L" p99=" << Microseconds(latency.Percentile(0.99)) << L"us"
+            << L" p999=" << Microseconds(latency.Percentile(0.999)) << L"us"
+            << allocations.PerSample(readings) << L"\n";
+    }
+
+    void Scenario1(const Options& options, double rate, bool paced, std::shared_ptr<WorkerPool> pool)
+    {
+        SyntheticAccelerometer source(rate, 1);
+        size_t count = options.Count(static_cast<size_t>(rate));
+        DispatcherThread ui;
+        Scenario1Graph graph(source.Period(), ui, pool);
+        graph.ResetMetrics();
+
+        AllocationDelta allocations;
+        RunSource(source, count, paced, [&](const SensorSample& sample)
+        {
+            graph.OnReading(sample);
+        });
+        ui.Idle();
+        Print(Name(L"Scenario1", rate, paced), count, graph.Dropped(), allocations, graph.Metrics());
+    }
+
+    void Scenario2(const Options& options, double rate, bool paced)
+    {
+        // bursts of 10 shakes with a second between gestures, the gap of the page is half a second
+        SyntheticShakes shakes(rate, 10, 1.0, 2);
+        size_t count = options.Count(static_cast<size_t>(rate));
+        DispatcherThread ui;
+        Scenario2Graph graph(5000000, ui);
+        graph.ResetMetrics();
+
+        AllocationDelta allocations;
+        {
+            AllocationScope scope(AllocationStage::Sensor);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (paced)
+                {
+                    std::this_thread::sleep_until(start + std::chrono::nanoseconds(static_cast<long long>(i * 1e9 / rate)));
+                }
+                auto shake = shakes.Next();
+                graph.OnShake(shake.Timestamp, shake.Intensity);
+            }
+            graph.Flush();
+        }
+        ui.Idle();
+        Print(Name(L"Scenario2", rate, paced), count, 0, allocations, graph.Metrics());
+    }
+
+    void Scenario3(const Options& options, double rate)
+    {
+        SyntheticAccelerometer source(rate, 3);
+        size_t count = options.Count(static_cast<size_t>(rate));
+        DispatcherThread ui;
+        Scenario3Graph graph(source.Period(), ui.Scheduler());
+
+        AllocationDelta allocations;
+        graph.Start();
+        RunSource(source, count, true, [&](const SensorSample& sample)
+        {
+            graph.OnReading(sample);
+        });
+        graph.Stop();
+        ui.Idle();
+        Print(Name(L"Scenario3", rate, true), count, 0, allocations, graph.Metrics());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    auto pool = std::make_shared<WorkerPool>(WorkerPool::DefaultThreads());
+
+    std::wcout << L"allocation counting " << (AllocationCounter::Enabled() ? L"on" : L"off")
+        << L", " << std::thread::hardware_concurrency() << L" cores, " << pool->Threads() << L" workers\n";
+
+    const double rates[] = {100.0, 1000.0, 10000.0};
+    for (double rate : rates)
+    {
+        Scenario1(options, rate, true, pool);
+        Scenario2(options, rate, true);
+        Scenario3(options, rate);
+    }
+
+    // the most the graphs take before the ui thread falls behind and readings are dropped
+    Scenario1(options, 100000.0, false, pool);
+    Scenario2(options, 100000.0, false);
+    return 0;
+}
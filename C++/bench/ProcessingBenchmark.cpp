@@ -0,0 +1,196 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ProcessingBenchmark.cpp
+// Windows per second through a ProcessingStage that runs an FFT and the activity classifier,
+// for pools of one thread and up
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "SyntheticSensor.h"
+
+#include "ActivityClassifier.h"
+#include "BlockPool.h"
+#include "ProcessingGraph.h"
+
+#include <atomic>
+#include <complex>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef std::shared_ptr<const ReadingWindow> Window;
+
+    const size_t Points = ReadingWindow::Capacity;
+
+    // the per-worker state of the step: a classifier and the FFT buffer
+    struct Worker
+    {
+        Worker(long long period) : Classifier(Points, period), Spectrum(Points)
+        {
+        }
+
+        ActivityClassifier Classifier;
+        std::vector<std::complex<double>> Spectrum;
+    };
+
+    // an in-place radix-2 FFT, the heavier kind of feature a classifier might add
+    void Transform(std::vector<std::complex<double>>& values)
+    {
+        const double pi = 3.14159265358979323846;
+        size_t n = values.size();
+        for (size_t i = 1, j = 0; i < n; ++i)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                std::swap(values[i], values[j]);
+            }
+        }
+        for (size_t length = 2; length <= n; length <<= 1)
+        {
+            std::complex<double> step = std::polar(1.0, -2.0 * pi / length);
+            for (size_t begin = 0; begin < n; begin += length)
+            {
+                std::complex<double> twiddle(1.0, 0.0);
+                for (size_t k = 0; k < length / 2; ++k)
+                {
+                    auto even = values[begin + k];
+                    auto odd = values[begin + k + length / 2] * twiddle;
+                    values[begin + k] = even + odd;
+                    values[begin + k + length / 2] = even - odd;
+                    twiddle *= step;
+                }
+            }
+        }
+    }
+
+    // the strongest frequency bin of the magnitude of the window, and its activity
+    struct Result
+    {
+        size_t Peak;
+        Activity Class;
+    };
+
+    Result Analyze(Worker& worker, const ReadingWindow& window)
+    {
+        for (size_t i = 0; i < Points; ++i)
+        {
+            auto& sample = window.Samples[i % window.Count];
+            worker.Spectrum[i] = std::complex<double>(std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z), 0.0);
+        }
+        Transform(worker.Spectrum);
+        Result result = {1, Activity::Unknown};
+        for (size_t i = 2; i < Points / 2; ++i)
+        {
+            if (std::norm(worker.Spectrum[i]) > std::norm(worker.Spectrum[result.Peak]))
+            {
+                result.Peak = i;
+            }
+        }
+        worker.Classifier.SetPeriod(window.Period);
+        result.Class = worker.Classifier.Classify(window.Samples, window.Count);
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t windows = options.Count(20000);
+
+    // the windows, filled once and handed out again as the graph releases them
+    SyntheticAccelerometer sensor(100.0, 5);
+    std::vector<SensorSample> readings(Points);
+    for (auto& sample : readings)
+    {
+        sample = sensor.Next();
+    }
+    long long period = readings[1].Timestamp - readings[0].Timestamp;
+    auto blocks = std::make_shared<BlockPool>();
+
+    size_t cores = std::thread::hardware_concurrency();
+    size_t most = (std::max)(cores != 0 ? cores : 1, static_cast<size_t>(4));
+    double single = 0.0;
+    for (size_t threads = 1; threads <= most; threads *= 2)
+    {
+        auto pool = std::make_shared<WorkerPool>(threads);
+        auto workers = std::make_shared<std::vector<std::unique_ptr<Worker>>>(threads + 1);
+        std::atomic<size_t> done(0);
+        std::atomic<size_t> peaks(0);
+        auto stage = std::make_shared<ProcessingStage<Window, Result>>(pool, threads,
+            [pool, workers, period](const Window& window, const std::function<void(const Result&)>& emit)
+            {
+                auto& worker = (*workers)[pool->Worker()];
+                if (worker == nullptr)
+                {
+                    worker.reset(new Worker(period));
+                }
+                emit(Analyze(*worker, *window));
+            },
+            [&](const Result& result)
+            {
+                peaks += result.Peak;
+                ++done;
+            });
+
+        // windows arrive as a stream, so only a few are in flight at once
+        size_t inFlight = 4 * threads;
+        auto run = [&](size_t count)
+        {
+            size_t first = done;
+            size_t target = first + count;
+            for (size_t i = 0; i < count; ++i)
+            {
+                while (first + i - done >= inFlight)
+                {
+                    std::this_thread::yield();
+                }
+                auto window = MakePooled<ReadingWindow>(blocks);
+                window->Period = period;
+                window->Count = Points;
+                std::copy(readings.begin(), readings.end(), window->Samples);
+                stage->Push(window);
+            }
+            while (done < target)
+            {
+                std::this_thread::yield();
+            }
+        };
+
+        // warm the queues, the slots, the pool of windows and the worker state
+        run(windows / 10 + 1);
+        AllocationDelta allocations;
+        Stopwatch time;
+        run(windows);
+        double seconds = time.Seconds();
+        single = threads == 1 ? seconds : single;
+        Consume(static_cast<double>(peaks));
+        std::wcout << L"threads=" << threads << L": windows=" << windows
+            << L" windows/s=" << windows / seconds
+            << L" speedup=" << single / seconds
+            << L" us/window=" << time.Nanoseconds() / 1000.0 / static_cast<double>(windows)
+            << allocations.PerSample(windows * Points, L"reading") << L"\n";
+        stage->Close();
+    }
+    if (cores < most)
+    {
+        std::wcout << L"  only " << cores << L" cores, so the larger pools share them\n";
+    }
+    return 0;
+}
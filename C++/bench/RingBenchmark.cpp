@@ -0,0 +1,190 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// RingBenchmark.cpp
+// SeqlockRingWriter throughput and the latency of RingReader processes following the ring
+// through POSIX shared memory, for one reader and more
+//
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "SeqlockRing.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // RingReader, which is built next to this benchmark
+    std::string ReaderPath()
+    {
+        std::vector<char> path(4096);
+        ssize_t length = readlink("/proc/self/exe", path.data(), path.size() - 1);
+        std::string self(path.data(), length > 0 ? static_cast<size_t>(length) : 0);
+        size_t slash = self.rfind('/');
+        return (slash != std::string::npos ? self.substr(0, slash + 1) : std::string("./")) + "RingReader";
+    }
+
+    long long Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // starts readers processes that follow name for count records, and waits until each has
+    // mapped the ring; returns their ids, or none if one could not be started
+    std::vector<pid_t> StartReaders(const std::string& name, size_t readers, unsigned long long count)
+    {
+        int ready[2];
+        std::vector<pid_t> started;
+        if (pipe(ready) != 0)
+        {
+            return started;
+        }
+        std::string path = ReaderPath();
+        std::string records = std::to_string(count);
+        std::string fd = std::to_string(ready[1]);
+        for (size_t i = 0; i < readers; ++i)
+        {
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_addclose(&actions, ready[0]);
+            char* arguments[] = {&path[0], const_cast<char*>(name.c_str()), &records[0], &fd[0], nullptr};
+            pid_t pid;
+            if (posix_spawn(&pid, path.c_str(), &actions, nullptr, arguments, environ) == 0)
+            {
+                started.push_back(pid);
+            }
+            posix_spawn_file_actions_destroy(&actions);
+        }
+        close(ready[1]);
+
+        // a reader that fails closes its end of the pipe without writing
+        size_t attached = 0;
+        char byte;
+        while (attached < started.size() && read(ready[0], &byte, 1) == 1)
+        {
+            ++attached;
+        }
+        close(ready[0]);
+        if (attached < readers)
+        {
+            for (auto pid : started)
+            {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+            started.clear();
+        }
+        return started;
+    }
+
+    // waits for the readers, and returns false if one failed or saw a torn record
+    bool WaitForReaders(const std::vector<pid_t>& readers)
+    {
+        bool passed = true;
+        for (auto pid : readers)
+        {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            passed = passed && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+        return passed;
+    }
+
+    // count records as fast as the writer goes, or one every pace nanoseconds
+    bool Run(const wchar_t* name, const std::string& ring, void* memory, size_t bytes, size_t readers, size_t count, long long pace)
+    {
+        // a fresh ring for each run, so that readers start from record 0
+        std::memset(memory, 0, sizeof(SeqlockRing::Header));
+        SeqlockRingWriter writer(memory, bytes);
+        auto processes = StartReaders(ring, readers, count);
+        if (processes.empty())
+        {
+            std::wcout << name << L": could not start the readers\n";
+            return false;
+        }
+
+        Stopwatch time;
+        long long next = Now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (pace != 0)
+            {
+                next += pace;
+                while (Now() < next)
+                {
+                }
+            }
+            SensorSample sample;
+            sample.Timestamp = Now();
+            sample.X = static_cast<double>(i);
+            sample.Y = -sample.X;
+            sample.Z = sample.X / 2.0;
+            writer.Publish(sample);
+        }
+        double seconds = time.Seconds();
+        bool passed = WaitForReaders(processes);
+        std::wcout << name << L" readers=" << readers << L": records=" << count
+            << L" writes/s=" << count / seconds
+            << L" ns/write=" << seconds * 1e9 / count << std::endl;
+        return passed;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(2000000);
+
+    // a ring of 4096 records, as Scenario1 publishes
+    std::string ring = "/accelerometer-bench-" + std::to_string(getpid());
+    size_t bytes = SeqlockRing::Bytes(4096);
+    int file = shm_open(ring.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (file < 0 || ftruncate(file, static_cast<off_t>(bytes)) != 0)
+    {
+        std::wcout << L"cannot create the shared memory\n";
+        return 1;
+    }
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(ring.c_str());
+        std::wcout << L"cannot map the shared memory\n";
+        return 1;
+    }
+
+    // each run prints the line of each reader and then its own
+    std::wcout << L"record bytes=" << sizeof(SeqlockRing::Record) << std::endl;
+    bool passed = true;
+    for (size_t readers = 1; readers <= 4; readers *= 2)
+    {
+        // throughput, where slow readers lose records, and latency at 20000 records a second,
+        // far more than any accelerometer reports
+        passed = Run(L"flat out", ring, memory, bytes, readers, count, 0) && passed;
+        passed = Run(L"paced", ring, memory, bytes, readers, count / 100 + 1, 50000) && passed;
+    }
+
+    munmap(memory, bytes);
+    shm_unlink(ring.c_str());
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// RingReader.cpp
+// A process that follows a SeqlockRing in POSIX shared memory, as a logger would follow the
+// ring that Scenario1 publishes, and reports what it received
+//
+//   RingReader NAME [COUNT [READY_FD]]
+//
+// maps the shared memory object NAME read only and reads COUNT records, or reports once a
+// second until it is stopped when COUNT is 0.  A byte is written to READY_FD once the ring is
+// mapped.  RingBenchmark writes records whose timestamp is the steady clock in nanoseconds
+// and whose axes are the record number, n, -n and n / 2, so the latency of each record is
+// measured and a torn record shows up; records of other writers are only counted.
+//
+
+#include "pch.h"
+
+#include "SeqlockRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace SDKSample;
+using namespace SDKSample::Common;
+
+namespace
+{
+    double Percentile(std::vector<long long>& values, double fraction)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(fraction * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index] / 1000.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::wcerr << L"usage: RingReader NAME [COUNT [READY_FD]]\n";
+        return 2;
+    }
+    unsigned long long count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    int ready = argc > 3 ? std::atoi(argv[3]) : -1;
+
+    int file = shm_open(argv[1], O_RDONLY, 0);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) != 0)
+    {
+        std::wcerr << L"RingReader: cannot open " << argv[1] << L"\n";
+        return 2;
+    }
+    size_t bytes = static_cast<size_t>(status.st_size);
+    void* memory = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (memory == MAP_FAILED)
+    {
+        std::wcerr << L"RingReader: cannot map " << argv[1] << L"\n";
+        return 2;
+    }
+    SeqlockRingReader reader(memory, bytes);
+    if (!reader.Valid())
+    {
+        std::wcerr << L"RingReader: " << argv[1] << L" does not hold a ring\n";
+        return 2;
+    }
+    if (ready >= 0)
+    {
+        char byte = 1;
+        if (write(ready, &byte, 1) != 1)
+        {
+            return 2;
+        }
+        close(ready);
+    }
+
+    std::vector<long long> latencies;
+    latencies.reserve(static_cast<size_t>(count));
+    unsigned long long received = 0;
+    unsigned long long torn = 0;
+    auto started = std::chrono::steady_clock::now();
+    auto reported = started;
+    while (count == 0 || received + reader.Lost() < count)
+    {
+        size_t polled = reader.Poll([&](const SensorSample& sample)
+        {
+            ++received;
+            if (count == 0)
+            {
+                return;
+            }
+            auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(sample.Received.time_since_epoch()).count();
+            latencies.push_back(now - sample.Timestamp);
+            torn += (sample.Y != -sample.X || sample.Z != sample.X / 2.0) ? 1 : 0;
+        });
+        if (polled == 0)
+        {
+            sched_yield();
+        }
+        if (count == 0 && std::chrono::steady_clock::now() - reported >= std::chrono::seconds(1))
+        {
+            reported = std::chrono::steady_clock::now();
+            std::wcout << argv[1] << L": received=" << received << L" lost=" << reader.Lost() << std::endl;
+        }
+    }
+
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - started).count();
+    std::wcout << L"  reader " << getpid() << L": received=" << received
+        << L" lost=" << reader.Lost()
+        << L" torn=" << torn
+        << L" reads/s=" << received / seconds
+        << L" latency us p50=" << Percentile(latencies, 0.5)
+        << L" p99=" << Percentile(latencies, 0.99)
+        << L" max=" << Percentile(latencies, 1.0) << std::endl;
+    munmap(memory, bytes);
+    return torn == 0 ? 0 : 1;
+}
@@ -0,0 +1,356 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ScenarioGraphs.h
+// Declaration of the Scenario1Graph, Scenario2Graph and Scenario3Graph classes
+//
+
+#pragma once
+
+#include "Bench.h"
+#include "DispatcherThread.h"
+
+#include "ScenarioPipelines.h"
+#include "SensorArbiter.h"
+#include "BoundedQueue.h"
+#include "Resampler.h"
+#include "SeqlockRing.h"
+#include "IntervalTimer.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        /// <summary>
+        /// The report interval in milliseconds for a period in 100ns units.  Sources faster than
+        /// 1 kHz ask for no interval, so the arbiter passes every reading on as it would for the
+        /// fastest interval the sensor supports.
+        /// </summary>
+        inline unsigned int ReportInterval(long long period)
+        {
+            return static_cast<unsigned int>(period / 10000);
+        }
+
+        /// <summary>
+        /// The Scenario1 page without rx or the Windows Runtime: the steps of Scenario1Pipeline,
+        /// which the page runs, joined by the classes that its rx operators wrap.  Readings are
+        /// calibrated and arbitrated with the SensorArbiter of Arbitrate on the sensor thread,
+        /// published through the BroadcastHub of Broadcast to the sinks the pipeline subscribes
+        /// and to the Resampler of Resample, analyzed, and handed to the ui thread through the
+        /// BoundedQueue of ObserveOnBounded.  The shared memory ring is a SeqlockRingWriter over
+        /// private memory.  Not run are the rx subscriptions and closures around the steps, the
+        /// event args and AccelerometerReading of each reading, the dispatcher work items and
+        /// the Strings the page shows.
+        /// </summary>
+        class Scenario1Graph
+        {
+        public:
+            /// <summary>
+            /// period is the report interval in 100ns units.
+            /// </summary>
+            Scenario1Graph(long long period, DispatcherThread& ui, std::shared_ptr<Common::WorkerPool> pool) :
+                ui(ui),
+                pipeline(pool,
+                    [period]()
+                    {
+                        return period;
+                    },
+                    [this](const Common::Activity&)
+                    {
+                        this->ui.Post([this]()
+                        {
+                            ++activities;
+                        });
+                    },
+                    Common::CalibrationParameters::Identity()),
+                arbiter(std::make_shared<Common::SensorArbiter>(1, [](unsigned int) {})),
+                hub(std::make_shared<Common::BroadcastHub<Common::SensorBatch>>()),
+                ringMemory(Common::SeqlockRing::Bytes(4096)),
+                ring(std::make_shared<Common::SeqlockRingWriter>(&ringMemory[0], ringMemory.size())),
+                resampler(period),
+                activities(0)
+            {
+                consumer = arbiter->Acquire(ReportInterval(period));
+
+                pipeline.Subscribe(*hub, ring);
+                hub->Subscribe([this](const Common::BroadcastHub<Common::SensorBatch>::Block& batch)
+                {
+                    for (size_t i = 0; i < batch->Count; ++i)
+                    {
+                        resampler.Push(batch->Samples[i], [this](const Common::SensorSample& sample)
+                        {
+                            pipeline.Analyze(sample);
+                            uiQueue->Push(sample);
+                        });
+                    }
+                });
+
+                uiQueue = std::make_shared<Common::BoundedQueue<Common::SensorSample>>(
+                    Common::OverflowPolicy::DropOldest, 16, Common::BoundedQueue<Common::SensorSample>::clock::duration::zero(), ui.Scheduler(),
+                    [this](const Common::SensorSample& sample)
+                    {
+                        Consume(pipeline.Show(sample).Rms);
+                        pipeline.Shown(sample);
+                    });
+
+                pipeline.Restart();
+            }
+
+            ~Scenario1Graph()
+            {
+                pipeline.Close();
+                uiQueue->Close();
+                ui.Idle();
+            }
+
+            /// <summary>
+            /// A reading from the sensor, on the sensor thread.
+            /// </summary>
+            void OnReading(const Common::SensorSample& reading)
+            {
+                Common::SensorSample sample = pipeline.Calibrate(reading);
+                if (!arbiter->Deliver(consumer, sample.Timestamp))
+                {
+                    return;
+                }
+                auto batch = hub->Allocate();
+                batch->Count = 1;
+                batch->Samples[0] = sample;
+                hub->Publish(batch);
+            }
+
+            /// <summary>
+            /// Starts the metrics afresh, e.g. once the graph is built, and waits for the ui thread.
+            /// </summary>
+            void ResetMetrics()
+            {
+                ui.Post([this]()
+                {
+                    pipeline.Metrics().Reset();
+                });
+                ui.Idle();
+            }
+
+            /// <summary>
+            /// Read on the ui thread, or once it is idle.
+            /// </summary>
+            const Common::PipelineMetrics& Metrics()
+            {
+                return pipeline.Metrics();
+            }
+
+            unsigned long long Dropped() const
+            {
+                return uiQueue->Dropped();
+            }
+
+            unsigned long long Activities() const
+            {
+                return activities;
+            }
+
+        private:
+            Scenario1Graph(const Scenario1Graph&);
+            Scenario1Graph& operator=(const Scenario1Graph&);
+
+            DispatcherThread& ui;
+            Common::Scenario1Pipeline pipeline;
+            std::shared_ptr<Common::SensorArbiter> arbiter;
+            Common::SensorArbiter::Consumer consumer;
+            std::shared_ptr<Common::BroadcastHub<Common::SensorBatch>> hub;
+            std::vector<char> ringMemory;
+            std::shared_ptr<Common::SeqlockRingWriter> ring;
+            Common::Resampler resampler;
+            std::shared_ptr<Common::BoundedQueue<Common::SensorSample>> uiQueue;
+            unsigned long long activities;
+        };
+
+        /// <summary>
+        /// The Scenario2 page without rx or the Windows Runtime: the steps of Scenario2Pipeline,
+        /// with each gesture posted to the ui thread, where it is counted.  Not run are the rx
+        /// subscriptions, the event args of each shake and the Strings the page shows.
+        /// </summary>
+        class Scenario2Graph
+        {
+        public:
+            Scenario2Graph(long long gap, DispatcherThread& ui) :
+                ui(ui),
+                pipeline(gap),
+                gestureCount(0),
+                last(0)
+            {
+            }
+
+            /// <summary>
+            /// A shake, on the sensor thread.
+            /// </summary>
+            void OnShake(long long timestamp, double intensity)
+            {
+                last = timestamp;
+                Common::ShakeGesture completed;
+                if (pipeline.Shake(timestamp, intensity, completed))
+                {
+                    Show(completed);
+                }
+            }
+
+            /// <summary>
+            /// What the ui timer does once the gap has passed without a shake.
+            /// </summary>
+            void Flush()
+            {
+                Common::ShakeGesture completed;
+                if (pipeline.Flush(last + pipeline.Gap(), completed))
+                {
+                    Show(completed);
+                }
+            }
+
+            /// <summary>
+            /// Starts the metrics afresh, e.g. once the graph is built, and waits for the ui thread.
+            /// </summary>
+            void ResetMetrics()
+            {
+                ui.Post([this]()
+                {
+                    pipeline.Metrics().Reset();
+                });
+                ui.Idle();
+            }
+
+            const Common::PipelineMetrics& Metrics()
+            {
+                return pipeline.Metrics();
+            }
+
+            unsigned int Gestures() const
+            {
+                return gestureCount;
+            }
+
+        private:
+            Scenario2Graph(const Scenario2Graph&);
+            Scenario2Graph& operator=(const Scenario2Graph&);
+
+            void Show(const Common::ShakeGesture& gesture)
+            {
+                ui.Post([this, gesture]()
+                {
+                    ++gestureCount;
+                    pipeline.Shown(gesture);
+                });
+            }
+
+            DispatcherThread& ui;
+            Common::Scenario2Pipeline pipeline;
+            unsigned int gestureCount;
+            long long last;
+        };
+
+        /// <summary>
+        /// The Scenario3 page without rx or the Windows Runtime: a timer polls the current
+        /// reading, which goes through the steps of Scenario3Pipeline and the SensorArbiter of
+        /// Arbitrate and is shown on the thread of the timer.  The timer runs on scheduler, a
+        /// DispatcherThread or a VirtualTimeScheduler.  Not run are the rx subscriptions and the
+        /// AccelerometerReading of each poll.
+        /// </summary>
+        class Scenario3Graph
+        {
+        public:
+            /// <summary>
+            /// period is the report interval in 100ns units.
+            /// </summary>
+            Scenario3Graph(long long period, Common::IntervalTimer::Scheduler scheduler) :
+                scheduler(std::move(scheduler)),
+                interval(std::chrono::duration_cast<Common::IntervalTimer::clock::duration>(std::chrono::nanoseconds(period * 100))),
+                pipeline(Common::CalibrationParameters::Identity()),
+                arbiter(std::make_shared<Common::SensorArbiter>(1, [](unsigned int) {})),
+                hasReading(false)
+            {
+                consumer = arbiter->Acquire(ReportInterval(period));
+            }
+
+            /// <summary>
+            /// The sensor has a new current reading, on the sensor thread.
+            /// </summary>
+            void OnReading(const Common::SensorSample& sample)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                current = sample;
+                hasReading = true;
+            }
+
+            /// <summary>
+            /// Starts the poll timer with fresh metrics.
+            /// </summary>
+            void Start()
+            {
+                pipeline.Metrics().Reset();
+                timer = Common::IntervalTimer::Start(scheduler, interval, [this](size_t)
+                {
+                    Poll();
+                });
+            }
+
+            /// <summary>
+            /// Stops the timer; wait for its thread to be idle before reading the metrics.
+            /// </summary>
+            void Stop()
+            {
+                timer->Cancel();
+            }
+
+            const Common::PipelineMetrics& Metrics()
+            {
+                return pipeline.Metrics();
+            }
+
+            size_t Polls() const
+            {
+                return timer != nullptr ? timer->Ticks() : 0;
+            }
+
+        private:
+            Scenario3Graph(const Scenario3Graph&);
+            Scenario3Graph& operator=(const Scenario3Graph&);
+
+            void Poll()
+            {
+                Common::SensorSample sample;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!hasReading)
+                    {
+                        return;
+                    }
+                    sample = current;
+                }
+                sample.Received = Common::SensorSample::clock::now();
+                sample = pipeline.Calibrate(sample);
+                if (arbiter->Deliver(consumer, sample.Timestamp))
+                {
+                    pipeline.Shown(sample);
+                }
+            }
+
+            Common::IntervalTimer::Scheduler scheduler;
+            Common::IntervalTimer::clock::duration interval;
+            std::shared_ptr<Common::IntervalTimer> timer;
+            Common::Scenario3Pipeline pipeline;
+            std::shared_ptr<Common::SensorArbiter> arbiter;
+            Common::SensorArbiter::Consumer consumer;
+            std::mutex lock;
+            Common::SensorSample current;
+            bool hasReading;
+        };
+    }
+}
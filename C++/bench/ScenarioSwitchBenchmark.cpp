@@ -0,0 +1,116 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ScenarioSwitchBenchmark.cpp
+// The time to switch between scenarios when each switch builds the scenario graph afresh, as
+// MainPage::LoadScenario used to, and when the graphs are kept in an LruCache
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "DispatcherThread.h"
+#include "ScenarioGraphs.h"
+
+#include "LruCache.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Period = 160000;
+
+    // the operators of scenario id, standing in for its page
+    std::shared_ptr<void> Build(unsigned int id, DispatcherThread& ui, const std::shared_ptr<WorkerPool>& pool)
+    {
+        switch (id)
+        {
+        case 0:
+            return std::make_shared<Scenario1Graph>(Period, ui, pool);
+        case 1:
+            return std::make_shared<Scenario2Graph>(5000000, ui);
+        default:
+            return std::make_shared<Scenario3Graph>(Period, ui.Scheduler());
+        }
+    }
+
+    void Report(const wchar_t* name, const std::vector<unsigned int>& switches, size_t built, const Stopwatch& time, const AllocationDelta& allocations)
+    {
+        std::wcout << name << L": switches=" << switches.size()
+            << L" built=" << built
+            << L" us/switch=" << time.Nanoseconds() / 1000.0 / static_cast<double>(switches.size())
+            << allocations.PerSample(switches.size(), L"switch") << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(2000);
+
+    // a user going back and forth between the three scenarios
+    std::mt19937 random(4);
+    std::uniform_int_distribution<unsigned int> scenarios(0, 2);
+    std::vector<unsigned int> switches;
+    unsigned int current = 0;
+    while (switches.size() < count)
+    {
+        unsigned int next = scenarios(random);
+        if (next != current)
+        {
+            switches.push_back(next);
+            current = next;
+        }
+    }
+
+    DispatcherThread ui;
+    auto pool = std::make_shared<WorkerPool>(WorkerPool::DefaultThreads());
+    {
+        // the page that is shown is the only one kept
+        std::shared_ptr<void> shown = Build(0, ui, pool);
+        size_t built = 0;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (auto id : switches)
+        {
+            shown.reset();
+            shown = Build(id, ui, pool);
+            ++built;
+        }
+        Report(L"rebuilt on each switch", switches, built, time, allocations);
+    }
+
+    size_t capacities[] = {1, 2, 3};
+    for (auto capacity : capacities)
+    {
+        LruCache<unsigned int, std::shared_ptr<void>> cache(capacity);
+        auto release = [](const unsigned int&, std::shared_ptr<void>& graph)
+        {
+            graph.reset();
+        };
+        cache.Insert(0, Build(0, ui, pool), release);
+        size_t built = 0;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (auto id : switches)
+        {
+            if (cache.Find(id) == nullptr)
+            {
+                cache.Insert(id, Build(id, ui, pool), release);
+                ++built;
+            }
+        }
+        std::wstring name = L"cached, capacity " + std::to_wstring(capacity);
+        Report(name.c_str(), switches, built, time, allocations);
+    }
+    return 0;
+}
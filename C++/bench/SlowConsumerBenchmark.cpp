@@ -0,0 +1,98 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SlowConsumerBenchmark.cpp
+// Each BoundedQueue policy between a 10 kHz producer and a consumer that keeps up with 1 kHz
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "DispatcherThread.h"
+
+#include "BoundedQueue.h"
+#include "PipelineMetrics.h"
+
+#include <thread>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef BoundedQueue<Stopwatch::clock::time_point> Queue;
+
+    struct Policy
+    {
+        const wchar_t* Name;
+        OverflowPolicy Value;
+    };
+
+    // busy for duration, as rendering a reading on a slow ui thread is
+    void Work(std::chrono::microseconds duration)
+    {
+        auto until = Stopwatch::clock::now() + duration;
+        while (Stopwatch::clock::now() < until)
+        {
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t readings = options.Count(10000);
+
+    const Policy policies[] = {
+        {L"LatestOnly", OverflowPolicy::LatestOnly},
+        {L"DropOldest", OverflowPolicy::DropOldest},
+        {L"BlockProducer", OverflowPolicy::BlockProducer},
+        {L"Sample", OverflowPolicy::Sample}
+    };
+    for (auto& policy : policies)
+    {
+        DispatcherThread ui;
+        // how old a value is when the consumer gets it
+        LatencyHistogram staleness;
+        auto queue = std::make_shared<Queue>(policy.Value, 16, std::chrono::milliseconds(16), ui.Scheduler(),
+            [&](const Stopwatch::clock::time_point& pushed)
+            {
+                staleness.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Stopwatch::clock::now() - pushed));
+                Work(std::chrono::microseconds(1000));
+            });
+
+        // ten readings every millisecond
+        Stopwatch time;
+        AllocationDelta allocations;
+        auto next = Stopwatch::clock::now();
+        for (size_t i = 0; i < readings; ++i)
+        {
+            if (i % 10 == 0)
+            {
+                next += std::chrono::milliseconds(1);
+                std::this_thread::sleep_until(next);
+            }
+            queue->Push(Stopwatch::clock::now());
+        }
+        double producerSeconds = time.Seconds();
+        auto producerAllocations = allocations.PerSample(readings, L"reading");
+        queue->Finish([]() {});
+        ui.Idle();
+        queue->Close();
+
+        std::wcout << policy.Name
+            << L": pushed=" << queue->Pushed()
+            << L" delivered=" << queue->Delivered()
+            << L" dropped=" << queue->Dropped()
+            << L" producer s=" << producerSeconds
+            << L" staleness p50=" << staleness.Percentile(0.5).count() / 1000 << L"us"
+            << L" p99=" << staleness.Percentile(0.99).count() / 1000 << L"us"
+            << producerAllocations << L"\n";
+        std::wcout << L"  " << queue->Report(policy.Name);
+    }
+    return 0;
+}
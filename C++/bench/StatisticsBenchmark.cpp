@@ -0,0 +1,118 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// StatisticsBenchmark.cpp
+// SlidingStatistics against recomputing the window from scratch, for windows up to 65536
+//
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "WindowedStatistics.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // what the dashboards did: keep the window in a ring and scan it for each value
+    class NaiveStatistics
+    {
+    public:
+        explicit NaiveStatistics(size_t window) : values(window), count(0), next(0)
+        {
+        }
+
+        void Push(double value)
+        {
+            values[next] = value;
+            next = (next + 1) % values.size();
+            count = (std::min)(count + 1, values.size());
+        }
+
+        Statistics Current() const
+        {
+            Statistics statistics = {count, 0.0, 0.0, 0.0, values[0], values[0]};
+            double sum = 0.0;
+            double squares = 0.0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                double value = values[i];
+                sum += value;
+                squares += value * value;
+                statistics.Minimum = (std::min)(statistics.Minimum, value);
+                statistics.Maximum = (std::max)(statistics.Maximum, value);
+            }
+            statistics.Mean = sum / count;
+            statistics.Variance = squares / count - statistics.Mean * statistics.Mean;
+            statistics.Rms = std::sqrt(squares / count);
+            return statistics;
+        }
+
+    private:
+        std::vector<double> values;
+        size_t count;
+        size_t next;
+    };
+
+    template<class Channel>
+    double Run(Channel& channel, const std::vector<double>& values, size_t count)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            channel.Push(values[i % values.size()]);
+            sum += channel.Current().Rms;
+        }
+        return sum;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+
+    std::mt19937 random(3);
+    std::normal_distribution<double> normal(1.0, 0.2);
+    std::vector<double> values(1 << 17);
+    for (auto& value : values)
+    {
+        value = normal(random);
+    }
+
+    const size_t windows[] = {16, 256, 4096, 65536};
+    for (auto window : windows)
+    {
+        // every value is summarized, as each reading updates the dashboard
+        size_t count = options.Count(2000000);
+        SlidingStatistics sliding(window);
+        AllocationDelta allocations;
+        Stopwatch time;
+        Consume(Run(sliding, values, count));
+        double slidingTime = time.Nanoseconds() / count;
+        auto slidingAllocations = allocations.PerSample(count, L"value");
+
+        // the scan costs the window per value, so it runs fewer values
+        size_t naiveCount = (std::max)(options.Count(20000000) / window, static_cast<size_t>(window + 1));
+        NaiveStatistics naive(window);
+        time.Restart();
+        Consume(Run(naive, values, naiveCount));
+        double naiveTime = time.Nanoseconds() / naiveCount;
+
+        std::wcout << L"window=" << window
+            << L" sliding ns/value=" << slidingTime
+            << L" naive ns/value=" << naiveTime
+            << L" speedup=" << naiveTime / slidingTime
+            << slidingAllocations << L"\n";
+    }
+    return 0;
+}
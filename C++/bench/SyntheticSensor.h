@@ -0,0 +1,144 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SyntheticSensor.h
+// Declaration of the SyntheticAccelerometer and SyntheticShakes classes
+//
+
+#pragma once
+
+#include "SensorSample.h"
+
+#include <cmath>
+#include <random>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        /// <summary>
+        /// A deterministic accelerometer: gravity on an axis that the device slowly tilts away
+        /// from, a sway of Sway g at SwayFrequency Hz, white noise of Noise g, and timestamps
+        /// Rate times a second with up to Jitter of a period of jitter.  The same seed always
+        /// gives the same readings.
+        /// </summary>
+        class SyntheticAccelerometer
+        {
+        public:
+            // a sensor timestamp in 100ns units since 1601, early 2013
+            static long long Epoch()
+            {
+                return 130000000000000000LL;
+            }
+
+            SyntheticAccelerometer(double rate, unsigned int seed) :
+                Sway(0.05),
+                SwayFrequency(2.0),
+                Noise(0.01),
+                Jitter(0.1),
+                rate(rate),
+                index(0),
+                random(seed),
+                uniform(-1.0, 1.0),
+                normal(0.0, 1.0)
+            {
+            }
+
+            double Sway;
+            double SwayFrequency;
+            double Noise;
+            double Jitter;
+
+            double Rate() const
+            {
+                return rate;
+            }
+
+            long long Period() const
+            {
+                return static_cast<long long>(10000000.0 / rate);
+            }
+
+            Common::SensorSample Next()
+            {
+                const double pi = 3.14159265358979323846;
+                double t = static_cast<double>(index) / rate;
+                double tilt = 0.3 * std::sin(2.0 * pi * 0.05 * t);
+                double sway = Sway * std::sin(2.0 * pi * SwayFrequency * t);
+
+                Common::SensorSample sample;
+                sample.Timestamp = Epoch() + static_cast<long long>(index) * Period() +
+                    static_cast<long long>(Jitter * Period() * uniform(random));
+                sample.X = std::sin(tilt) + sway + Noise * normal(random);
+                sample.Y = 0.5 * sway + Noise * normal(random);
+                sample.Z = -std::cos(tilt) + Noise * normal(random);
+                sample.Received = Common::SensorSample::clock::now();
+                ++index;
+                return sample;
+            }
+
+        private:
+            double rate;
+            unsigned long long index;
+            std::mt19937 random;
+            std::uniform_real_distribution<double> uniform;
+            std::normal_distribution<double> normal;
+        };
+
+        /// <summary>
+        /// Shaken events in bursts: BurstEvents events Rate times a second, then a pause of Pause
+        /// seconds, with an intensity between 1.5 and 3 g.  Timestamps are in 100ns units.
+        /// </summary>
+        class SyntheticShakes
+        {
+        public:
+            struct Event
+            {
+                long long Timestamp;
+                double Intensity;
+            };
+
+            SyntheticShakes(double rate, unsigned int burstEvents, double pause, unsigned int seed) :
+                rate(rate),
+                burstEvents(burstEvents),
+                pause(static_cast<long long>(pause * 10000000.0)),
+                inBurst(0),
+                timestamp(SyntheticAccelerometer::Epoch()),
+                random(seed),
+                intensity(1.5, 3.0)
+            {
+            }
+
+            unsigned int BurstEvents() const
+            {
+                return burstEvents;
+            }
+
+            Event Next()
+            {
+                if (inBurst == burstEvents)
+                {
+                    inBurst = 0;
+                    timestamp += pause;
+                }
+                Event event = {timestamp, intensity(random)};
+                timestamp += static_cast<long long>(10000000.0 / rate);
+                ++inBurst;
+                return event;
+            }
+
+        private:
+            double rate;
+            unsigned int burstEvents;
+            long long pause;
+            unsigned int inBurst;
+            long long timestamp;
+            std::mt19937 random;
+            std::uniform_real_distribution<double> intensity;
+        };
+    }
+}
@@ -0,0 +1,117 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceAnalysisBenchmark.cpp
+// How TraceAnalyzer scales with threads over a recorded trace file mapped with mmap, as
+// TraceAnalyze runs it.  The partitions are the same for every thread count, so every run has
+// to give the same result.  20M readings by default; --scale 50 records a billion.
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "MappedFile.h"
+#include "SyntheticSensor.h"
+
+#include "TraceAnalysis.h"
+#include "TraceFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Second = 10000000;
+    const char* Path = "TraceAnalysisBenchmark.trace";
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(20000000);
+
+    // 100 Hz readings with a shake of a second or so every few minutes
+    {
+        SyntheticAccelerometer sensor(100.0, 50);
+        TraceFileWriter writer(Path, 4096);
+        Stopwatch time;
+        for (size_t n = 0; n < count; ++n)
+        {
+            SensorSample reading = sensor.Next();
+            if (n % 20000 < 100)
+            {
+                reading.X += n % 4 < 2 ? 1.2 : -1.2;
+            }
+            writer.Append(reading);
+        }
+        if (!writer.Close())
+        {
+            std::wcerr << L"TraceAnalysisBenchmark: cannot write " << Path << L"\n";
+            return 2;
+        }
+        std::wcout << L"recorded readings=" << count << L" seconds=" << time.Seconds() << L"\n";
+    }
+
+    MappedFile file(Path);
+    TraceFileReader reader(file.Data(), file.Size());
+    if (!reader.Valid())
+    {
+        std::wcerr << L"TraceAnalysisBenchmark: cannot map " << Path << L"\n";
+        std::remove(Path);
+        return 2;
+    }
+
+    size_t cores = std::thread::hardware_concurrency();
+    cores = cores != 0 ? cores : 1;
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < cores; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(cores);
+
+    TraceAnalysisOptions analysisOptions = {64, 0.1, 0.5, Second / 2, (std::max)(static_cast<size_t>(64), 4 * cores)};
+    TraceAnalyzer analyzer(analysisOptions);
+    std::wcout << L"cores=" << cores << L" partitions=" << analysisOptions.Partitions << L"\n";
+
+    bool identical = true;
+    TraceAnalysis first;
+    double baseline = 0.0;
+    for (size_t i = 0; i < threadCounts.size(); ++i)
+    {
+        WorkerPool pool(threadCounts[i]);
+        Stopwatch time;
+        TraceAnalysis analysis = analyzer.Run(reader.Readings(), reader.Count(), pool);
+        double seconds = time.Seconds();
+        if (i == 0)
+        {
+            first = analysis;
+            baseline = seconds;
+            std::wcout << TraceAnalyzer::Report(L"analysis", analysis);
+        }
+        identical = identical && analysis.Magnitude.Mean == first.Magnitude.Mean &&
+            analysis.Magnitude.Variance == first.Magnitude.Variance && analysis.PeakWindowRms == first.PeakWindowRms &&
+            analysis.PeakSmoothedMagnitude == first.PeakSmoothedMagnitude && analysis.Gestures.size() == first.Gestures.size();
+        std::wcout << L"threads=" << threadCounts[i]
+            << L" seconds=" << seconds
+            << L" Mreadings/s=" << static_cast<double>(reader.Count()) / seconds / 1e6
+            << L" speedup=" << baseline / seconds << L"\n";
+    }
+
+    std::remove(Path);
+    if (!identical)
+    {
+        std::wcerr << L"TraceAnalysisBenchmark: the thread counts disagree\n";
+        return 1;
+    }
+    return 0;
+}
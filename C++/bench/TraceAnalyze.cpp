@@ -0,0 +1,167 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceAnalyze.cpp
+// Analyzes a recorded trace file with the operators of the scenario pipelines, in parallel
+//
+//   TraceAnalyze TRACE [--threads N] [--partitions N] [--window N] [--weight W]
+//                      [--threshold G] [--gap SECONDS] [--gestures]
+//   TraceAnalyze --record CSV TRACE
+//
+// maps TRACE, a file written by TraceFileWriter, and runs TraceAnalyzer over its readings in
+// place on a WorkerPool of N threads, one per core by default, split into partitions, four
+// per thread by default.  --gestures lists each shake gesture.  --record writes a trace file
+// from a trace of "timestamp,x,y,z" lines, such as the ones in traces.
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "CsvTrace.h"
+#include "MappedFile.h"
+
+#include "TraceAnalysis.h"
+#include "TraceFile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Second = 10000000;
+
+    int Usage()
+    {
+        std::wcerr << L"usage: TraceAnalyze TRACE [--threads N] [--partitions N] [--window N] [--weight W]\n"
+            << L"                          [--threshold G] [--gap SECONDS] [--gestures]\n"
+            << L"       TraceAnalyze --record CSV TRACE\n";
+        return 2;
+    }
+
+    int Record(const std::string& csv, const std::string& path)
+    {
+        try
+        {
+            auto readings = ReadCsvTrace(csv);
+            TraceFileWriter writer(path, 4096);
+            for (auto& reading : readings)
+            {
+                writer.Append(reading);
+            }
+            if (!writer.Valid() || !writer.Close())
+            {
+                std::wcerr << L"TraceAnalyze: cannot write " << path.c_str() << L"\n";
+                return 2;
+            }
+            std::wcout << L"recorded readings=" << writer.Count() << L" dropped=" << writer.Dropped() << L"\n";
+            return 0;
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::wcerr << L"TraceAnalyze: " << error.what() << L"\n";
+            return 2;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 4 && std::strcmp(argv[1], "--record") == 0)
+    {
+        return Record(argv[2], argv[3]);
+    }
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        return Usage();
+    }
+
+    size_t cores = std::thread::hardware_concurrency();
+    size_t threads = cores != 0 ? cores : 1;
+    size_t partitions = 0;
+    TraceAnalysisOptions options = {64, 0.1, 0.5, 5000000, 0};
+    bool gestures = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        bool value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--threads") == 0 && value)
+        {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--partitions") == 0 && value)
+        {
+            partitions = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--window") == 0 && value)
+        {
+            options.Window = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--weight") == 0 && value)
+        {
+            options.SmoothingWeight = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && value)
+        {
+            options.ShakeThreshold = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--gap") == 0 && value)
+        {
+            options.ShakeGap = static_cast<long long>(std::atof(argv[++i]) * Second);
+        }
+        else if (std::strcmp(argv[i], "--gestures") == 0)
+        {
+            gestures = true;
+        }
+        else
+        {
+            return Usage();
+        }
+    }
+    if (threads == 0 || options.Window == 0 || !(options.SmoothingWeight > 0.0 && options.SmoothingWeight <= 1.0))
+    {
+        return Usage();
+    }
+    options.Partitions = partitions != 0 ? partitions : 4 * threads;
+
+    MappedFile file(argv[1]);
+    TraceFileReader reader(file.Data(), file.Size());
+    if (!reader.Valid())
+    {
+        std::wcerr << L"TraceAnalyze: " << argv[1] << L" is not a trace file\n";
+        return 2;
+    }
+
+    WorkerPool pool(threads);
+    TraceAnalyzer analyzer(options);
+    Stopwatch time;
+    TraceAnalysis analysis = analyzer.Run(reader.Readings(), reader.Count(), pool);
+    double seconds = time.Seconds();
+
+    std::string path = argv[1];
+    std::wcout << TraceAnalyzer::Report(std::wstring(path.begin(), path.end()), analysis)
+        << L"threads=" << threads << L" partitions=" << options.Partitions
+        << L" seconds=" << seconds
+        << L" readings/s=" << (seconds > 0.0 ? reader.Count() / seconds : 0.0) << L"\n";
+    if (gestures)
+    {
+        long long first = reader.Count() != 0 ? reader.Readings()[0].Timestamp : 0;
+        for (auto& gesture : analysis.Gestures)
+        {
+            std::wcout << L"gesture at s=" << static_cast<double>(gesture.Start - first) / Second
+                << L" ms=" << static_cast<double>(gesture.Duration()) / 10000
+                << L" events=" << gesture.Events
+                << L" peak=" << gesture.PeakIntensity << L"\n";
+        }
+    }
+    return 0;
+}
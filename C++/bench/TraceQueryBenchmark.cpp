@@ -0,0 +1,231 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceQueryBenchmark.cpp
+// The latency of queries over a recorded trace file, mapped with mmap, through its block
+// index and by scanning the readings: the largest magnitude over ranges from ten seconds to
+// the whole trace, and the blocks whose RMS magnitude is above a threshold.  Each is run with
+// the pages mapped in and again after they are dropped from the mapping, as on first use.
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "MappedFile.h"
+#include "SyntheticSensor.h"
+
+#include "TraceFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Second = 10000000;
+    const uint32_t BlockReadings = 4096;
+    const char* Path = "TraceQueryBenchmark.trace";
+
+    double Magnitude(const TraceFile::Record& record)
+    {
+        return std::sqrt(record.X * record.X + record.Y * record.Y + record.Z * record.Z);
+    }
+
+    // what a reader without the index does: finds the range and reads every reading in it
+    double ScanMaximum(const TraceFileReader& reader, long long begin, long long end)
+    {
+        const TraceFile::Record* first = std::lower_bound(reader.Readings(), reader.Readings() + reader.Count(), begin,
+            [](const TraceFile::Record& record, long long timestamp)
+            {
+                return record.Timestamp < timestamp;
+            });
+        double maximum = 0.0;
+        for (const TraceFile::Record* record = first; record != reader.Readings() + reader.Count() && record->Timestamp <= end; ++record)
+        {
+            maximum = (std::max)(maximum, Magnitude(*record));
+        }
+        return maximum;
+    }
+
+    size_t ScanBlocksAbove(const TraceFileReader& reader, double rms)
+    {
+        size_t above = 0;
+        for (size_t begin = 0; begin < reader.Count(); begin += BlockReadings)
+        {
+            size_t end = (std::min)(begin + BlockReadings, reader.Count());
+            double sumOfSquares = 0.0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                double magnitude = Magnitude(reader.Readings()[i]);
+                sumOfSquares += magnitude * magnitude;
+            }
+            above += std::sqrt(sumOfSquares / static_cast<double>(end - begin)) > rms ? 1 : 0;
+        }
+        return above;
+    }
+
+    void Report(const std::wstring& name, size_t queries, double indexedSeconds, double scanSeconds, double blocksRead)
+    {
+        std::wcout << name
+            << L" indexed us/query=" << indexedSeconds * 1e6 / static_cast<double>(queries)
+            << L" blocks read/query=" << blocksRead
+            << L" scan us/query=" << scanSeconds * 1e6 / static_cast<double>(queries)
+            << L" speedup=" << (indexedSeconds > 0.0 ? scanSeconds / indexedSeconds : 0.0) << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(10000000);
+    size_t queries = options.Count(200);
+
+    // a day and more of 100 Hz readings, with a shake of a few seconds every few minutes
+    {
+        SyntheticAccelerometer sensor(100.0, 49);
+        std::mt19937 random(49);
+        std::uniform_int_distribution<int> gaps(6000, 60000);
+        std::uniform_int_distribution<int> lengths(100, 500);
+        size_t shakeAt = static_cast<size_t>(gaps(random));
+        size_t shakeEnd = 0;
+        TraceFileWriter writer(Path, BlockReadings);
+        Stopwatch time;
+        for (size_t n = 0; n < count; ++n)
+        {
+            SensorSample reading = sensor.Next();
+            if (n == shakeAt)
+            {
+                shakeEnd = n + static_cast<size_t>(lengths(random));
+                shakeAt = shakeEnd + static_cast<size_t>(gaps(random));
+            }
+            if (n < shakeEnd)
+            {
+                reading.X += n % 2 == 0 ? 1.5 : -1.5;
+            }
+            writer.Append(reading);
+        }
+        if (!writer.Close())
+        {
+            std::wcerr << L"TraceQueryBenchmark: cannot write " << Path << L"\n";
+            return 2;
+        }
+        std::wcout << L"recorded readings=" << count << L" ns/reading=" << time.Nanoseconds() / static_cast<double>(count) << L"\n";
+    }
+
+    MappedFile file(Path);
+    TraceFileReader reader(file.Data(), file.Size());
+    if (!reader.Valid())
+    {
+        std::wcerr << L"TraceQueryBenchmark: cannot map " << Path << L"\n";
+        std::remove(Path);
+        return 2;
+    }
+    std::wcout << L"mapped MB=" << static_cast<double>(file.Size()) / (1 << 20)
+        << L" index KB=" << static_cast<double>(reader.Index().EndBlock() * sizeof(TraceFile::Block)) / 1024 << L"\n";
+
+    const TraceFile::Record* readings = reader.Readings();
+    long long first = readings[0].Timestamp;
+    long long last = readings[reader.Count() - 1].Timestamp;
+    const long long spans[] = {10 * Second, 600 * Second, 3600 * Second, last - first};
+    const wchar_t* names[] = {L"10s", L"10min", L"1h", L"whole trace"};
+    std::mt19937 random(50);
+    bool agrees = true;
+    for (int s = 0; s < 4; ++s)
+    {
+        long long span = (std::min)(spans[s], last - first);
+        std::uniform_int_distribution<long long> starts(first, last - span);
+        std::vector<long long> begins(queries);
+        for (auto& begin : begins)
+        {
+            begin = starts(random);
+        }
+
+        // blocks read by the index, counted on a separate pass so the timed ones are the reader's
+        unsigned long long blocks = 0;
+        for (auto begin : begins)
+        {
+            double maximum;
+            reader.Index().MaximumMagnitude(begin, begin + span,
+                [&](unsigned long long number, const std::function<void(const SensorSample&)>& visit)
+                {
+                    ++blocks;
+                    reader.ReadBlock(number, visit);
+                },
+                maximum);
+        }
+
+        const bool evicts[] = {false, true};
+        for (auto evict : evicts)
+        {
+            std::vector<double> indexed(queries);
+            double indexedSeconds = 0.0;
+            for (size_t q = 0; q < queries; ++q)
+            {
+                if (evict)
+                {
+                    file.Evict();
+                }
+                Stopwatch time;
+                reader.MaximumMagnitude(begins[q], begins[q] + span, indexed[q]);
+                indexedSeconds += time.Seconds();
+            }
+            double scanSeconds = 0.0;
+            for (size_t q = 0; q < queries; ++q)
+            {
+                if (evict)
+                {
+                    file.Evict();
+                }
+                Stopwatch time;
+                double maximum = ScanMaximum(reader, begins[q], begins[q] + span);
+                scanSeconds += time.Seconds();
+                agrees = agrees && std::fabs(maximum - indexed[q]) < 1e-12;
+            }
+            std::wstring name = std::wstring(L"maximum magnitude, ") + names[s] + (evict ? L", pages dropped:" : L":");
+            Report(name, queries, indexedSeconds, scanSeconds, static_cast<double>(blocks) / static_cast<double>(queries));
+        }
+    }
+
+    // the shakes, as the blocks whose RMS is above 1.1 g
+    {
+        size_t rounds = options.Count(20);
+        size_t indexedAbove = 0;
+        Stopwatch time;
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            indexedAbove = reader.BlocksAbove(1.1, [](const BlockSummary&)
+            {
+            });
+        }
+        double indexedSeconds = time.Seconds();
+        size_t scannedAbove = 0;
+        time.Restart();
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            scannedAbove = ScanBlocksAbove(reader, 1.1);
+        }
+        double scanSeconds = time.Seconds();
+        agrees = agrees && indexedAbove == scannedAbove;
+        std::wstring name = L"blocks above RMS, " + std::to_wstring(indexedAbove) + L" of " + std::to_wstring(reader.Index().EndBlock()) + L":";
+        Report(name, rounds, indexedSeconds, scanSeconds, 0.0);
+    }
+
+    std::remove(Path);
+    if (!agrees)
+    {
+        std::wcerr << L"TraceQueryBenchmark: the index and the scan disagree\n";
+        return 1;
+    }
+    return 0;
+}
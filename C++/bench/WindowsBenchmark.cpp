@@ -0,0 +1,122 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// WindowsBenchmark.cpp
+// The cost per reading of EventTimeWindows and SessionWindows for streams in order and
+// shuffled within the allowed lateness
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "SyntheticSensor.h"
+
+#include "EventTimeWindows.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Lateness = 8 * 100000;
+
+    // the readings in the order they arrive when each is delayed by up to Lateness
+    std::vector<SensorSample> Shuffle(const std::vector<SensorSample>& readings, unsigned int seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<long long> delay(0, Lateness);
+        std::vector<std::pair<long long, size_t>> arrivals;
+        for (size_t i = 0; i < readings.size(); ++i)
+        {
+            arrivals.push_back(std::make_pair(readings[i].Timestamp + delay(random), i));
+        }
+        std::stable_sort(arrivals.begin(), arrivals.end());
+        std::vector<SensorSample> shuffled;
+        for (auto& arrival : arrivals)
+        {
+            shuffled.push_back(readings[arrival.second]);
+        }
+        return shuffled;
+    }
+
+    template<class Aggregate, class Windows>
+    void Run(const wchar_t* name, Windows& windows, const std::vector<SensorSample>& readings)
+    {
+        size_t emitted = 0;
+        auto count = [&emitted](long long, long long, Aggregate&)
+        {
+            ++emitted;
+        };
+        // a first pass grows the storage, the second is timed
+        for (auto& sample : readings)
+        {
+            windows.Push(sample, count);
+        }
+        windows.Flush(count);
+        windows.Reset();
+
+        emitted = 0;
+        AllocationDelta allocations;
+        Stopwatch time;
+        for (auto& sample : readings)
+        {
+            windows.Push(sample, count);
+        }
+        windows.Flush(count);
+        double nanoseconds = time.Nanoseconds();
+        std::wcout << name << L": readings=" << readings.size()
+            << L" windows=" << emitted
+            << L" ns/reading=" << nanoseconds / static_cast<double>(readings.size())
+            << L" late=" << windows.Late()
+            << allocations.PerSample(readings.size(), L"reading") << L"\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options::Parse(argc, argv);
+    size_t count = options.Count(1000000);
+
+    SyntheticAccelerometer sensor(100.0, 3);
+    sensor.Jitter = 0.0;
+    std::vector<SensorSample> ordered;
+    for (size_t i = 0; i < count; ++i)
+    {
+        ordered.push_back(sensor.Next());
+    }
+    long long period = ordered[1].Timestamp - ordered[0].Timestamp;
+    auto shuffled = Shuffle(ordered, 1);
+
+    const wchar_t* orders[] = {L"in order", L"shuffled"};
+    const std::vector<SensorSample>* streams[] = {&ordered, &shuffled};
+    for (int i = 0; i < 2; ++i)
+    {
+        std::wcout << orders[i] << L"\n";
+        {
+            EventTimeWindows<ReadingSummary> windows(64 * period, 64 * period, Lateness);
+            Run<ReadingSummary>(L"  tumbling summary", windows, *streams[i]);
+        }
+        {
+            EventTimeWindows<ReadingSummary> windows(64 * period, 16 * period, Lateness);
+            Run<ReadingSummary>(L"  sliding summary", windows, *streams[i]);
+        }
+        {
+            EventTimeWindows<ReadingCollector> windows(64 * period, 64 * period, Lateness);
+            Run<ReadingCollector>(L"  tumbling collector", windows, *streams[i]);
+        }
+        {
+            // a session per reading, the most that are ever open at once
+            SessionWindows<ReadingSummary> windows(period / 2, Lateness);
+            Run<ReadingSummary>(L"  sessions", windows, *streams[i]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,16 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// pch.h
+// Stands in for the app's precompiled header when the portable sources of Common are built
+// for the benchmarks and tests.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
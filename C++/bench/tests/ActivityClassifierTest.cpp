@@ -0,0 +1,120 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ActivityClassifierTest.cpp
+// Checks each branch of the decision tree and the accuracy on the bundled traces
+//
+// ActivityClassifierTest <directory of the traces>
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "Check.h"
+#include "CsvTrace.h"
+
+#include "ActivityClassifier.h"
+
+#include <string>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // the window of Scenario1
+    const size_t Window = 64;
+
+    ActivityFeatures Features(double mean, double deviation, double crossings, double highBand)
+    {
+        ActivityFeatures features;
+        features.Values[ActivityFeatures::Mean] = mean;
+        features.Values[ActivityFeatures::Deviation] = deviation;
+        features.Values[ActivityFeatures::Crossings] = crossings;
+        features.Values[ActivityFeatures::HighBand] = highBand;
+        return features;
+    }
+
+    void TestTree()
+    {
+        // every leaf, and each side of each threshold
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.005, 20.0, 0.9)) == Activity::Still);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.0199, 0.0, 0.0)) == Activity::Still);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.02, 10.0, 0.5)) == Activity::Vibrating);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.3, 3.0, 0.9)) == Activity::Vibrating);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.05, 3.0, 0.1)) == Activity::InTransit);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.0799, 3.0, 0.4999)) == Activity::InTransit);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.2, 1.9, 0.1)) == Activity::InTransit);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.08, 2.0, 0.1)) == Activity::Walking);
+        CHECK(ActivityClassifier::Classify(Features(1.0, 0.25, 4.0, 0.2)) == Activity::Walking);
+    }
+
+    void TestFeatures()
+    {
+        // a square wave of 4Hz at 64Hz: 8 crossings a second and a mean of 1g
+        ActivityClassifier classifier(Window, 10000000 / 64);
+        bool completed = false;
+        for (size_t i = 0; i < Window; ++i)
+        {
+            double z = (i / 8) % 2 == 0 ? -1.1 : -0.9;
+            SensorSample sample = {static_cast<long long>(i), 0.0, 0.0, z, SensorSample::clock::now()};
+            completed = classifier.Push(sample);
+        }
+        CHECK(completed);
+        auto& features = classifier.Features();
+        CHECK_NEAR(features.Values[ActivityFeatures::Mean], 1.0, 1e-12);
+        CHECK_NEAR(features.Values[ActivityFeatures::Deviation], 0.1, 1e-12);
+        CHECK_NEAR(features.Values[ActivityFeatures::Crossings], 7.0, 1e-12);
+    }
+
+    struct Trace
+    {
+        const char* Name;
+        Activity Expected;
+    };
+
+    void TestTraces(const std::string& directory)
+    {
+        const Trace traces[] = {
+            {"still", Activity::Still},
+            {"walking", Activity::Walking},
+            {"vibrating", Activity::Vibrating},
+            {"transit", Activity::InTransit}
+        };
+        for (auto& trace : traces)
+        {
+            auto readings = ReadCsvTrace(directory + "/" + trace.Name + ".csv");
+            CHECK(readings.size() >= 8 * Window);
+            ActivityClassifier classifier(Window, readings[1].Timestamp - readings[0].Timestamp);
+
+            AllocationDelta allocations;
+            size_t windows = 0;
+            size_t correct = 0;
+            for (auto& sample : readings)
+            {
+                if (classifier.Push(sample))
+                {
+                    ++windows;
+                    correct += classifier.Current() == trace.Expected ? 1 : 0;
+                }
+            }
+            auto allocated = allocations.Total();
+            std::wcout << trace.Name << L": " << correct << L" of " << windows << L" windows correct\n";
+            CHECK(windows == readings.size() / Window);
+            CHECK(correct * 10 >= windows * 9);
+            CHECK(allocated == 0);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    TestTree();
+    TestFeatures();
+    TestTraces(argc > 1 ? argv[1] : "traces");
+    return Result(L"ActivityClassifierTest");
+}
@@ -0,0 +1,99 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// AllocationBudgetTest.cpp
+// Fails when the steps of a scenario page allocate more per shown sample than the page allows
+//
+
+#include "pch.h"
+#include "Check.h"
+#include "ScenarioGraphs.h"
+#include "SyntheticSensor.h"
+#include "VirtualTimeScheduler.h"
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // the budget is the one the pipeline of the page sets on its metrics
+    void CheckBudget(const wchar_t* name, const PipelineMetrics& metrics, double budget)
+    {
+        std::wcout << metrics.Report(name);
+        CHECK(metrics.Samples() != 0);
+        CHECK(AllocationCounter::Enabled());
+        CHECK(!metrics.OverAllocationBudget());
+        CHECK(metrics.AllocationsPerSample() <= budget);
+    }
+
+    void TestScenario1()
+    {
+        // one reading at a time, so the ui queue never drops and every reading is accounted for
+        SyntheticAccelerometer source(1000.0, 1);
+        DispatcherThread ui;
+        auto pool = std::make_shared<WorkerPool>(1);
+        Scenario1Graph graph(source.Period(), ui, pool);
+        graph.ResetMetrics();
+        {
+            AllocationScope scope(AllocationStage::Sensor);
+            for (int i = 0; i < 4096; ++i)
+            {
+                graph.OnReading(source.Next());
+                ui.Idle();
+            }
+        }
+        CHECK(graph.Dropped() == 0);
+        CHECK(graph.Activities() != 0);
+        CheckBudget(L"Scenario1", graph.Metrics(), Scenario1Pipeline::AllocationBudget());
+    }
+
+    void TestScenario2()
+    {
+        SyntheticShakes shakes(50.0, 10, 1.0, 2);
+        DispatcherThread ui;
+        Scenario2Graph graph(5000000, ui);
+        graph.ResetMetrics();
+        {
+            AllocationScope scope(AllocationStage::Sensor);
+            for (int i = 0; i < 4096; ++i)
+            {
+                auto shake = shakes.Next();
+                graph.OnShake(shake.Timestamp, shake.Intensity);
+            }
+            graph.Flush();
+        }
+        ui.Idle();
+        CHECK(graph.Gestures() == 410);
+        CheckBudget(L"Scenario2", graph.Metrics(), Scenario2Pipeline::AllocationBudget());
+    }
+
+    void TestScenario3()
+    {
+        // the poll timer runs on virtual time, a reading and a poll each millisecond
+        SyntheticAccelerometer source(1000.0, 3);
+        VirtualTimeScheduler scheduler;
+        Scenario3Graph graph(source.Period(), scheduler.Scheduler());
+        graph.Start();
+        for (int i = 0; i < 4096; ++i)
+        {
+            graph.OnReading(source.Next());
+            scheduler.AdvanceBy(std::chrono::milliseconds(1));
+        }
+        graph.Stop();
+        CHECK(graph.Polls() == 4096);
+        CheckBudget(L"Scenario3", graph.Metrics(), Scenario3Pipeline::AllocationBudget());
+    }
+}
+
+int main()
+{
+    TestScenario1();
+    TestScenario2();
+    TestScenario3();
+    return Result(L"AllocationBudgetTest");
+}
@@ -0,0 +1,195 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BoundedQueueTest.cpp
+// The end of the stream behind the queued values, and Close while a drain is running
+//
+
+#include "pch.h"
+#include "Check.h"
+#include "DispatcherThread.h"
+
+#include "BoundedQueue.h"
+#include "VirtualTimeScheduler.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef BoundedQueue<int> Queue;
+
+    // what the consumer saw: values, and -1 for the end of the stream
+    struct Log
+    {
+        std::vector<int> Seen;
+
+        Queue::Consumer Consumer()
+        {
+            return [this](const int& value)
+            {
+                Seen.push_back(value);
+            };
+        }
+
+        Queue::Work Terminal()
+        {
+            return [this]()
+            {
+                Seen.push_back(-1);
+            };
+        }
+    };
+
+    void TestFinishAfterValues()
+    {
+        VirtualTimeScheduler scheduler;
+        Log log;
+        auto queue = std::make_shared<Queue>(OverflowPolicy::DropOldest, 8, Queue::clock::duration::zero(), scheduler.Scheduler(), log.Consumer());
+        queue->Push(1);
+        queue->Push(2);
+        queue->Push(3);
+        queue->Finish(log.Terminal());
+        queue->Push(4);
+        scheduler.RunAll();
+        CHECK(log.Seen.size() == 4 && log.Seen[0] == 1 && log.Seen[2] == 3 && log.Seen[3] == -1);
+        CHECK(queue->Pushed() == 3 && queue->Delivered() == 3);
+
+        // closed by the end of the stream
+        queue->Push(5);
+        scheduler.RunAll();
+        CHECK(log.Seen.size() == 4);
+    }
+
+    void TestFinishEmpty()
+    {
+        VirtualTimeScheduler scheduler;
+        Log log;
+        auto queue = std::make_shared<Queue>(OverflowPolicy::LatestOnly, 1, Queue::clock::duration::zero(), scheduler.Scheduler(), log.Consumer());
+        queue->Finish(log.Terminal());
+        queue->Finish(log.Terminal());
+        scheduler.RunAll();
+        CHECK(log.Seen.size() == 1 && log.Seen[0] == -1);
+    }
+
+    void TestSampledFinish()
+    {
+        // the last sample is delivered at its time, then the end
+        VirtualTimeScheduler scheduler;
+        Log log;
+        auto queue = std::make_shared<Queue>(OverflowPolicy::Sample, 1, std::chrono::milliseconds(10), scheduler.Scheduler(), log.Consumer());
+        queue->Push(1);
+        queue->Push(2);
+        queue->Finish(log.Terminal());
+        scheduler.AdvanceBy(std::chrono::milliseconds(9));
+        CHECK(log.Seen.empty());
+        scheduler.AdvanceBy(std::chrono::milliseconds(1));
+        CHECK(log.Seen.size() == 2 && log.Seen[0] == 2 && log.Seen[1] == -1);
+    }
+
+    void TestCloseDropsFinish()
+    {
+        // an unsubscribe before the end is delivered: neither the values nor the end arrive
+        VirtualTimeScheduler scheduler;
+        Log log;
+        auto queue = std::make_shared<Queue>(OverflowPolicy::DropOldest, 8, Queue::clock::duration::zero(), scheduler.Scheduler(), log.Consumer());
+        queue->Push(1);
+        queue->Finish(log.Terminal());
+        queue->Close();
+        scheduler.RunAll();
+        CHECK(log.Seen.empty());
+        CHECK(queue->Dropped() == 1);
+    }
+
+    void TestCloseFromConsumer()
+    {
+        VirtualTimeScheduler scheduler;
+        std::vector<int> seen;
+        std::shared_ptr<Queue> queue;
+        queue = std::make_shared<Queue>(OverflowPolicy::DropOldest, 8, Queue::clock::duration::zero(), scheduler.Scheduler(),
+            [&](const int& value)
+            {
+                seen.push_back(value);
+                queue->Close();
+            });
+        for (int i = 0; i < 5; ++i)
+        {
+            queue->Push(i);
+        }
+        scheduler.RunAll();
+        CHECK(seen.size() == 1 && seen[0] == 0);
+        CHECK(queue->Dropped() == 4);
+    }
+
+    void TestCloseWhileDelivering()
+    {
+        // Close from another thread while the consumer runs returns after it, and no value
+        // is delivered afterwards
+        DispatcherThread consumerThread;
+        std::promise<void> started;
+        std::atomic<int> calls(0);
+        std::atomic<bool> inConsumer(false);
+        auto queue = std::make_shared<Queue>(OverflowPolicy::DropOldest, 8, Queue::clock::duration::zero(), consumerThread.Scheduler(),
+            [&](const int&)
+            {
+                inConsumer = true;
+                if (calls++ == 0)
+                {
+                    started.set_value();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+                inConsumer = false;
+            });
+        for (int i = 0; i < 4; ++i)
+        {
+            queue->Push(i);
+        }
+        started.get_future().wait();
+        queue->Close();
+        CHECK(!inConsumer);
+        int callsAtClose = calls;
+        consumerThread.Idle();
+        CHECK(callsAtClose == 1);
+        CHECK(calls == 1);
+        CHECK(queue->Delivered() == 1 && queue->Dropped() == 3);
+    }
+
+    void TestFinishReleasesBlockedProducer()
+    {
+        VirtualTimeScheduler scheduler;
+        Log log;
+        auto queue = std::make_shared<Queue>(OverflowPolicy::BlockProducer, 1, Queue::clock::duration::zero(), scheduler.Scheduler(), log.Consumer());
+        queue->Push(1);
+        std::thread producer([&]()
+        {
+            queue->Push(2);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue->Finish(log.Terminal());
+        producer.join();
+        scheduler.RunAll();
+        CHECK(log.Seen.size() == 2 && log.Seen[0] == 1 && log.Seen[1] == -1);
+    }
+}
+
+int main()
+{
+    TestFinishAfterValues();
+    TestFinishEmpty();
+    TestSampledFinish();
+    TestCloseDropsFinish();
+    TestCloseFromConsumer();
+    TestCloseWhileDelivering();
+    TestFinishReleasesBlockedProducer();
+    return Result(L"BoundedQueueTest");
+}
@@ -0,0 +1,238 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BroadcastHubTest.cpp
+// Shared blocks, the block pool, terminal notifications and churn while publishing
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "Check.h"
+
+#include "BroadcastHub.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef BroadcastHub<SensorBatch> Hub;
+
+    std::shared_ptr<const SensorBatch> Batch(Hub& hub, long long timestamp)
+    {
+        auto batch = hub.Allocate();
+        batch->Count = 1;
+        batch->Samples[0].Timestamp = timestamp;
+        return batch;
+    }
+
+    void TestSharedBlock()
+    {
+        // every subscriber reads the one block
+        Hub hub;
+        std::vector<const SensorBatch*> seen;
+        for (int i = 0; i < 4; ++i)
+        {
+            hub.Subscribe([&](const Hub::Block& block)
+            {
+                seen.push_back(block.get());
+            });
+        }
+        auto block = Batch(hub, 1);
+        hub.Publish(block);
+        CHECK(seen.size() == 4);
+        bool same = true;
+        for (auto pointer : seen)
+        {
+            same = same && pointer == block.get();
+        }
+        CHECK(same);
+        CHECK(block.use_count() == 1);
+    }
+
+    void TestPool()
+    {
+        Hub hub;
+        Hub::Block kept;
+        hub.Subscribe([&](const Hub::Block& block)
+        {
+            if (block->Samples[0].Timestamp == 0)
+            {
+                kept = block;
+            }
+        });
+
+        // once the pool is warm, publishing does not allocate
+        hub.Publish(Batch(hub, 0));
+        hub.Publish(Batch(hub, 1));
+        AllocationDelta allocations;
+        for (long long i = 2; i < 1000; ++i)
+        {
+            hub.Publish(Batch(hub, i));
+        }
+        CHECK(allocations.Total() == 0);
+
+        // a block that is kept is not handed out again
+        CHECK(kept != nullptr && kept->Samples[0].Timestamp == 0);
+        auto next = hub.Allocate();
+        CHECK(next.get() != kept.get());
+    }
+
+    void TestPoolOutlivesHub()
+    {
+        // a block kept after the hub is gone still returns to the pool safely
+        Hub::Block kept;
+        {
+            Hub hub;
+            hub.Subscribe([&](const Hub::Block& block)
+            {
+                kept = block;
+            });
+            hub.Publish(Batch(hub, 5));
+        }
+        CHECK(kept->Samples[0].Timestamp == 5);
+        kept.reset();
+    }
+
+    void TestTerminate()
+    {
+        Hub hub;
+        int blocks = 0;
+        int completed = 0;
+        int failed = 0;
+        auto terminal = [&](const std::exception_ptr& error)
+        {
+            (error ? failed : completed) += 1;
+        };
+        auto count = [&](const Hub::Block&)
+        {
+            ++blocks;
+        };
+        hub.Subscribe(count, terminal);
+        hub.Subscribe(count, terminal);
+        hub.Subscribe(count);
+        hub.Publish(Batch(hub, 1));
+        CHECK(blocks == 3);
+
+        hub.Terminate(std::exception_ptr());
+        CHECK(completed == 2 && failed == 0);
+        CHECK(hub.Subscribers() == 0);
+        hub.Publish(Batch(hub, 2));
+        CHECK(blocks == 3);
+
+        // the hub can be subscribed to again, and an error reaches the new subscribers
+        hub.Subscribe(count, terminal);
+        hub.Publish(Batch(hub, 3));
+        CHECK(blocks == 4);
+        hub.Terminate(std::make_exception_ptr(std::runtime_error("sensor lost")));
+        CHECK(completed == 2 && failed == 1);
+        CHECK(hub.Subscribers() == 0);
+    }
+
+    void TestTerminateSome()
+    {
+        // as Broadcast ends a connection: its rx subscribers are told and dropped, and the sinks
+        // subscribed directly stay for the readings of the next connection
+        Hub hub;
+        int blocks = 0;
+        int completed = 0;
+        int failed = 0;
+        auto terminal = [&](const std::exception_ptr& error)
+        {
+            (error ? failed : completed) += 1;
+        };
+        auto count = [&](const Hub::Block&)
+        {
+            ++blocks;
+        };
+        hub.Subscribe(count);
+        std::vector<Hub::Token> connection;
+        connection.push_back(hub.Subscribe(count, terminal));
+        connection.push_back(hub.Subscribe(count, terminal));
+        hub.Subscribe(count, terminal);
+
+        hub.Terminate(std::make_exception_ptr(std::runtime_error("calibration failed")), connection);
+        CHECK(failed == 2 && completed == 0);
+        CHECK(hub.Subscribers() == 2);
+        hub.Publish(Batch(hub, 1));
+        CHECK(blocks == 2);
+
+        // tokens that are no longer subscribed are ignored
+        hub.Terminate(std::exception_ptr(), connection);
+        CHECK(failed == 2 && completed == 0);
+        CHECK(hub.Subscribers() == 2);
+    }
+
+    void TestUnsubscribeFromTerminal()
+    {
+        // a subscriber that unsubscribes when told, as the rx observers of Broadcast do
+        Hub hub;
+        Hub::Token token = 0;
+        bool told = false;
+        token = hub.Subscribe([](const Hub::Block&) {}, [&](const std::exception_ptr&)
+        {
+            told = true;
+            hub.Unsubscribe(token);
+        });
+        hub.Terminate(std::exception_ptr());
+        CHECK(told);
+    }
+
+    void TestChurnWhilePublishing()
+    {
+        // one thread publishes while another subscribes and unsubscribes, so lists are
+        // replaced while they are read
+        Hub hub;
+        std::atomic<unsigned long long> delivered(0);
+        hub.Subscribe([&](const Hub::Block& block)
+        {
+            delivered += block->Count;
+        });
+        std::atomic<bool> stop(false);
+        std::thread churn([&]()
+        {
+            while (!stop)
+            {
+                std::vector<Hub::Token> tokens;
+                for (int i = 0; i < 8; ++i)
+                {
+                    tokens.push_back(hub.Subscribe([](const Hub::Block&) {}));
+                }
+                for (auto token : tokens)
+                {
+                    hub.Unsubscribe(token);
+                }
+            }
+        });
+        const long long publishes = 200000;
+        for (long long i = 0; i < publishes; ++i)
+        {
+            hub.Publish(Batch(hub, i));
+        }
+        stop = true;
+        churn.join();
+        CHECK(delivered == static_cast<unsigned long long>(publishes));
+        CHECK(hub.Subscribers() == 1);
+    }
+}
+
+int main()
+{
+    TestSharedBlock();
+    TestPool();
+    TestPoolOutlivesHub();
+    TestTerminate();
+    TestTerminateSome();
+    TestUnsubscribeFromTerminal();
+    TestChurnWhilePublishing();
+    return Result(L"BroadcastHubTest");
+}
@@ -0,0 +1,211 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// BurstAggregatorTest.cpp
+// Gestures merged from synthetic bursts of shake events, closed by the next event or by Flush
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "BurstAggregator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Millisecond = 10000;
+    const long long Gap = 500 * Millisecond;
+
+    struct Event
+    {
+        long long Timestamp;
+        double Intensity;
+    };
+
+    // bursts of events less than the gap apart, with the bursts further apart than the gap;
+    // expected holds the gesture of each burst
+    std::vector<Event> Bursts(size_t bursts, unsigned int seed, std::vector<ShakeGesture>& expected)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> events(1, 12);
+        std::uniform_int_distribution<long long> within(10 * Millisecond, Gap - 1);
+        std::uniform_int_distribution<long long> between(Gap, 4 * Gap);
+        std::uniform_real_distribution<double> intensity(1.0, 4.0);
+
+        std::vector<Event> stream;
+        long long t = 0;
+        for (size_t b = 0; b < bursts; ++b)
+        {
+            t += between(random);
+            ShakeGesture gesture = {0, t, t, 0.0, ShakeGesture::clock::time_point()};
+            int count = events(random);
+            for (int e = 0; e < count; ++e)
+            {
+                t += e != 0 ? within(random) : 0;
+                Event event = {t, intensity(random)};
+                stream.push_back(event);
+                ++gesture.Events;
+                gesture.End = t;
+                gesture.PeakIntensity = (std::max)(gesture.PeakIntensity, event.Intensity);
+            }
+            expected.push_back(gesture);
+        }
+        return stream;
+    }
+
+    bool Same(const ShakeGesture& a, const ShakeGesture& b)
+    {
+        return a.Events == b.Events && a.Start == b.Start && a.End == b.End && a.PeakIntensity == b.PeakIntensity;
+    }
+
+    void TestBursts()
+    {
+        // each burst is closed by the first event of the next, and the last by Flush
+        std::vector<ShakeGesture> expected;
+        auto stream = Bursts(500, 1, expected);
+        BurstAggregator aggregator(Gap);
+        std::vector<ShakeGesture> gestures;
+        for (auto& event : stream)
+        {
+            ShakeGesture completed;
+            if (aggregator.Add(event.Timestamp, event.Intensity, completed))
+            {
+                gestures.push_back(completed);
+            }
+        }
+        ShakeGesture last;
+        CHECK(!aggregator.Flush(stream.back().Timestamp + Gap - 1, last));
+        CHECK(aggregator.Flush(stream.back().Timestamp + Gap, last));
+        gestures.push_back(last);
+
+        bool same = gestures.size() == expected.size();
+        for (size_t i = 0; same && i < gestures.size(); ++i)
+        {
+            same = Same(gestures[i], expected[i]);
+        }
+        CHECK(same);
+        CHECK(!aggregator.Flush(stream.back().Timestamp + 10 * Gap, last));
+    }
+
+    void TestDuration()
+    {
+        // a gesture of one event has no duration; the duration is in 100ns units
+        BurstAggregator aggregator(Gap);
+        ShakeGesture completed;
+        CHECK(!aggregator.Add(0, 2.0, completed));
+        CHECK(aggregator.Add(Gap, 3.0, completed));
+        CHECK(completed.Events == 1 && completed.Duration() == 0 && completed.PeakIntensity == 2.0);
+        CHECK(!aggregator.Add(Gap + 200 * Millisecond, 1.5, completed));
+        CHECK(!aggregator.Add(Gap + 450 * Millisecond, 2.5, completed));
+        CHECK(aggregator.Flush(Gap + 950 * Millisecond, completed));
+        CHECK(completed.Events == 3);
+        CHECK(completed.Duration() == 450 * Millisecond);
+        CHECK(completed.PeakIntensity == 3.0);
+    }
+
+    void TestLateEvent()
+    {
+        // an event a little older than the last one still joins its gesture
+        BurstAggregator aggregator(Gap);
+        ShakeGesture completed;
+        aggregator.Add(1000 * Millisecond, 1.0, completed);
+        aggregator.Add(1200 * Millisecond, 1.0, completed);
+        CHECK(!aggregator.Add(1100 * Millisecond, 5.0, completed));
+        CHECK(aggregator.Flush(1200 * Millisecond + Gap, completed));
+        CHECK(completed.Events == 3 && completed.Start == 1000 * Millisecond && completed.End == 1200 * Millisecond);
+        CHECK(completed.PeakIntensity == 5.0);
+    }
+
+    void TestReset()
+    {
+        // a gesture in progress when the scenario ends is dropped
+        BurstAggregator aggregator(Gap);
+        ShakeGesture completed;
+        aggregator.Add(0, 1.0, completed);
+        aggregator.Reset();
+        CHECK(!aggregator.Flush(10 * Gap, completed));
+        CHECK(!aggregator.Add(20 * Gap, 1.0, completed));
+        CHECK(aggregator.Flush(21 * Gap, completed));
+        CHECK(completed.Events == 1 && completed.Start == 20 * Gap);
+    }
+
+    void TestFlushFromAnotherThread()
+    {
+        // events added on one thread and a timer flushing on another lose and repeat nothing
+        std::vector<ShakeGesture> expected;
+        auto stream = Bursts(2000, 2, expected);
+        BurstAggregator aggregator(Gap);
+        std::mutex lock;
+        std::vector<ShakeGesture> gestures;
+        std::atomic<long long> clock(0);
+        std::atomic<bool> done(false);
+
+        std::thread timer([&]()
+        {
+            while (!done)
+            {
+                ShakeGesture completed;
+                if (aggregator.Flush(clock, completed))
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    gestures.push_back(completed);
+                }
+                std::this_thread::yield();
+            }
+        });
+        for (auto& event : stream)
+        {
+            // the timer's clock reaches each event as it arrives, so the timer and the event
+            // race to close the gesture before it
+            clock = event.Timestamp;
+            ShakeGesture completed;
+            if (aggregator.Add(event.Timestamp, event.Intensity, completed))
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                gestures.push_back(completed);
+            }
+        }
+        done = true;
+        timer.join();
+        ShakeGesture last;
+        if (aggregator.Flush(stream.back().Timestamp + Gap, last))
+        {
+            gestures.push_back(last);
+        }
+
+        std::sort(gestures.begin(), gestures.end(), [](const ShakeGesture& a, const ShakeGesture& b)
+        {
+            return a.Start < b.Start;
+        });
+        bool same = gestures.size() == expected.size();
+        for (size_t i = 0; same && i < gestures.size(); ++i)
+        {
+            same = Same(gestures[i], expected[i]);
+        }
+        CHECK(same);
+    }
+}
+
+int main()
+{
+    TestBursts();
+    TestDuration();
+    TestLateEvent();
+    TestReset();
+    TestFlushFromAnotherThread();
+    return Result(L"BurstAggregatorTest");
+}
@@ -0,0 +1,140 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CalibrationTest.cpp
+// Fits bias and scale from synthetic readings of a sensor with known errors
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "SensorCalibration.h"
+
+#include <random>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const double Bias[3] = {0.04, -0.03, 0.06};
+    const double Scale[3] = {1.05, 0.97, 1.02};
+
+    // a sensor with the errors above, reading gravity held in one orientation after another
+    class BiasedSensor
+    {
+    public:
+        explicit BiasedSensor(double noise) : random(7), normal(0.0, noise), timestamp(0)
+        {
+        }
+
+        SensorSample Read(const double (&gravity)[3])
+        {
+            SensorSample sample;
+            sample.Timestamp = timestamp += 160000;
+            double* axes[3] = {&sample.X, &sample.Y, &sample.Z};
+            for (int i = 0; i < 3; ++i)
+            {
+                *axes[i] = gravity[i] / Scale[i] + Bias[i] + normal(random);
+            }
+            sample.Received = SensorSample::clock::now();
+            return sample;
+        }
+
+        // gravity in direction i of a spread of orientations
+        static void Orientation(int i, int count, double (&gravity)[3])
+        {
+            // a spiral over the sphere, so every point is far from the one before
+            const double pi = 3.14159265358979323846;
+            double z = 1.0 - 2.0 * (i + 0.5) / count;
+            double radius = std::sqrt(1.0 - z * z);
+            double angle = pi * (3.0 - std::sqrt(5.0)) * i;
+            gravity[0] = radius * std::cos(angle);
+            gravity[1] = radius * std::sin(angle);
+            gravity[2] = z;
+        }
+
+    private:
+        std::mt19937 random;
+        std::normal_distribution<double> normal;
+        long long timestamp;
+    };
+
+    void TestFit()
+    {
+        BiasedSensor sensor(0.005);
+        SensorCalibration calibration;
+        const int orientations = 24;
+        int refits = 0;
+        for (int i = 0; i < orientations; ++i)
+        {
+            double gravity[3];
+            BiasedSensor::Orientation(i, orientations, gravity);
+            for (int r = 0; r < 2 * SensorCalibration::WindowLength; ++r)
+            {
+                refits += calibration.Update(sensor.Read(gravity)) ? 1 : 0;
+            }
+        }
+
+        CHECK(calibration.Points() == static_cast<unsigned int>(orientations));
+        CHECK(refits != 0);
+        auto parameters = calibration.Parameters();
+        for (int i = 0; i < 3; ++i)
+        {
+            CHECK_NEAR(parameters.Bias[i], Bias[i], 0.005);
+            CHECK_NEAR(parameters.Scale[i], Scale[i], 0.005);
+        }
+
+        // a corrected reading of a still device is 1g in any orientation
+        double gravity[3];
+        BiasedSensor::Orientation(5, 7, gravity);
+        auto corrected = calibration.Apply(sensor.Read(gravity));
+        CHECK_NEAR(std::sqrt(corrected.X * corrected.X + corrected.Y * corrected.Y + corrected.Z * corrected.Z), 1.0, 0.02);
+    }
+
+    void TestMovingDeviceIsIgnored()
+    {
+        // readings that swing by 0.1g are never still, so nothing is fitted
+        BiasedSensor sensor(0.1);
+        SensorCalibration calibration;
+        for (int i = 0; i < 24; ++i)
+        {
+            double gravity[3];
+            BiasedSensor::Orientation(i, 24, gravity);
+            for (int r = 0; r < 2 * SensorCalibration::WindowLength; ++r)
+            {
+                calibration.Update(sensor.Read(gravity));
+            }
+        }
+        CHECK(calibration.Points() == 0);
+        auto parameters = calibration.Parameters();
+        CHECK(parameters.Bias[0] == 0.0 && parameters.Scale[0] == 1.0);
+    }
+
+    void TestOneOrientationIsNotEnough()
+    {
+        // a device left on a table gives one point however long it lies there
+        BiasedSensor sensor(0.005);
+        SensorCalibration calibration;
+        double gravity[3] = {0.0, 0.0, -1.0};
+        for (int r = 0; r < 100 * SensorCalibration::WindowLength; ++r)
+        {
+            calibration.Update(sensor.Read(gravity));
+        }
+        CHECK(calibration.Points() == 1);
+        CHECK(calibration.Parameters().Scale[2] == 1.0);
+    }
+}
+
+int main()
+{
+    TestFit();
+    TestMovingDeviceIsIgnored();
+    TestOneOrientationIsNotEnough();
+    return Result(L"CalibrationTest");
+}
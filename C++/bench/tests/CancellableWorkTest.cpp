@@ -0,0 +1,280 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CancellableWorkTest.cpp
+// Runs a fake warm-up workload and the warm-up of Scenario1 on the worker pool and cancels them
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "DispatcherThread.h"
+
+#include "CancellableWork.h"
+#include "ProcessingGraph.h"
+#include "ScenarioPipelines.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // stands in for the warm-up of Scenario1: steps of 5ms until done or cancelled
+    bool FakeWarmup(CancellableWork& work, int steps, int& completed)
+    {
+        auto ticket = work.Begin();
+        completed = 0;
+        while (completed < steps && work.WaitFor(ticket, std::chrono::milliseconds(5)))
+        {
+            ++completed;
+        }
+        work.End(ticket);
+        return completed == steps;
+    }
+
+    void TestRunsToCompletion()
+    {
+        WorkerPool pool(2);
+        CancellableWork work;
+        std::promise<bool> done;
+        int completed = 0;
+        work.Queued();
+        pool.Post([&]()
+        {
+            done.set_value(FakeWarmup(work, 4, completed));
+        });
+        CHECK(done.get_future().get());
+        CHECK(completed == 4);
+        std::wcout << work.Report(L"complete");
+    }
+
+    void TestCancelReleasesThread()
+    {
+        // a warm-up of 10s is cancelled after it starts and gives up its thread at once
+        WorkerPool pool(1);
+        CancellableWork work;
+        std::promise<void> started;
+        std::promise<bool> done;
+        int completed = 0;
+        work.Queued();
+        pool.Post([&]()
+        {
+            started.set_value();
+            done.set_value(FakeWarmup(work, 2000, completed));
+        });
+        started.get_future().wait();
+        auto cancelledAt = std::chrono::steady_clock::now();
+        work.Cancel();
+        auto result = done.get_future();
+        CHECK(result.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        CHECK(!result.get());
+        CHECK(completed < 2000);
+        CHECK(std::chrono::steady_clock::now() - cancelledAt < std::chrono::milliseconds(500));
+
+        // the thread is free for the next command
+        std::promise<void> next;
+        pool.Post([&]()
+        {
+            next.set_value();
+        });
+        CHECK(next.get_future().wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        std::wcout << work.Report(L"cancelled");
+    }
+
+    void TestCancelBeforeStart()
+    {
+        // disable while the command is still queued behind other work
+        WorkerPool pool(1);
+        CancellableWork work;
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        pool.Post([released]()
+        {
+            released.wait();
+        });
+
+        std::promise<bool> done;
+        int completed = -1;
+        work.Queued();
+        pool.Post([&]()
+        {
+            done.set_value(FakeWarmup(work, 4, completed));
+        });
+        work.Cancel();
+        release.set_value();
+        CHECK(!done.get_future().get());
+        CHECK(completed == 0);
+    }
+
+    // what WorkerPoolScheduler does in the app: a timer thread waits out the delay and posts the
+    // work to the pool
+    IntervalTimer::Scheduler PoolScheduler(DispatcherThread& timer, const std::shared_ptr<WorkerPool>& pool)
+    {
+        return [&timer, pool](IntervalTimer::clock::duration delay, IntervalTimer::Work work)
+        {
+            timer.Schedule(delay, [pool, work]()
+            {
+                pool->Post(work);
+            });
+        };
+    }
+
+    std::shared_ptr<Scenario1Pipeline> Pipeline(const std::shared_ptr<WorkerPool>& pool)
+    {
+        return std::make_shared<Scenario1Pipeline>(pool,
+            []()
+            {
+                return 100000LL;
+            },
+            [](const Activity&)
+            {
+            },
+            CalibrationParameters::Identity());
+    }
+
+    void TestWarmupStepsOnPool()
+    {
+        // the warm-up of Scenario1 polls once per step, and its only worker runs other work
+        // between the steps
+        auto pool = std::make_shared<WorkerPool>(1);
+        DispatcherThread timer;
+        auto pipeline = Pipeline(pool);
+        auto work = std::make_shared<CancellableWork>();
+        std::atomic<int> polls(0);
+        std::promise<bool> done;
+        work->Queued();
+        Scenario1Pipeline::Warmup(pipeline, work, PoolScheduler(timer, pool), std::chrono::milliseconds(20),
+            [&](SensorSample& sample) -> bool
+            {
+                SensorSample polled = {++polls, 0.0, 0.0, 1.0, SensorSample::clock::now()};
+                sample = polled;
+                return true;
+            },
+            [&](bool seeded)
+            {
+                done.set_value(seeded);
+            });
+        auto result = done.get_future();
+
+        std::promise<void> other;
+        pool->Post([&]()
+        {
+            other.set_value();
+        });
+        CHECK(other.get_future().wait_for(std::chrono::milliseconds(100)) == std::future_status::ready);
+        CHECK(result.wait_for(std::chrono::milliseconds(0)) == std::future_status::timeout);
+
+        CHECK(result.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        CHECK(result.get());
+        CHECK(polls == SensorCalibration::WindowLength);
+        std::wcout << work->Report(L"warm-up");
+    }
+
+    void TestWarmupCancel()
+    {
+        // disable cancels the warm-up between two polls; the next step ends it
+        auto pool = std::make_shared<WorkerPool>(1);
+        DispatcherThread timer;
+        auto pipeline = Pipeline(pool);
+        auto work = std::make_shared<CancellableWork>();
+        std::atomic<int> polls(0);
+        std::promise<void> polled;
+        std::promise<bool> done;
+        work->Queued();
+        Scenario1Pipeline::Warmup(pipeline, work, PoolScheduler(timer, pool), std::chrono::milliseconds(20),
+            [&](SensorSample& sample) -> bool
+            {
+                if (polls == 0)
+                {
+                    polled.set_value();
+                }
+                SensorSample reading = {++polls, 0.0, 0.0, 1.0, SensorSample::clock::now()};
+                sample = reading;
+                return true;
+            },
+            [&](bool seeded)
+            {
+                done.set_value(seeded);
+            });
+        polled.get_future().wait();
+        work->Cancel();
+        auto result = done.get_future();
+        CHECK(result.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        CHECK(!result.get());
+        CHECK(polls < SensorCalibration::WindowLength);
+        std::wcout << work->Report(L"warm-up cancelled");
+    }
+
+    void TestStealing()
+    {
+        // one worker splits its work, the idle ones steal the pieces
+        WorkerPool pool(4);
+        const int pieces = 64;
+        std::atomic<int> remaining(pieces);
+        std::promise<void> finished;
+        pool.Post([&]()
+        {
+            for (int i = 0; i < pieces; ++i)
+            {
+                pool.Post([&]()
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    if (--remaining == 0)
+                    {
+                        finished.set_value();
+                    }
+                });
+            }
+        });
+        CHECK(finished.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        CHECK(pool.Stolen() != 0);
+        std::wcout << L"stolen " << pool.Stolen() << L" of " << pieces << L"\n";
+    }
+
+    void TestOrderFromOutside()
+    {
+        // work posted from outside starts in order on a single worker
+        WorkerPool pool(1);
+        std::vector<int> order;
+        std::promise<void> finished;
+        for (int i = 0; i < 16; ++i)
+        {
+            pool.Post([&, i]()
+            {
+                order.push_back(i);
+                if (i == 15)
+                {
+                    finished.set_value();
+                }
+            });
+        }
+        finished.get_future().wait();
+        bool ordered = order.size() == 16;
+        for (size_t i = 0; ordered && i < order.size(); ++i)
+        {
+            ordered = order[i] == static_cast<int>(i);
+        }
+        CHECK(ordered);
+    }
+}
+
+int main()
+{
+    TestRunsToCompletion();
+    TestCancelReleasesThread();
+    TestCancelBeforeStart();
+    TestWarmupStepsOnPool();
+    TestWarmupCancel();
+    TestStealing();
+    TestOrderFromOutside();
+    return Result(L"CancellableWorkTest");
+}
@@ -0,0 +1,62 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// Check.h
+// The checks of the unit tests, which count failures instead of stopping at the first one
+//
+
+#pragma once
+
+#include <cmath>
+#include <iostream>
+
+namespace SDKSample
+{
+    namespace Bench
+    {
+        inline int& Failures()
+        {
+            static int failures = 0;
+            return failures;
+        }
+
+        inline bool Check(bool passed, const char* expression, const char* file, int line)
+        {
+            if (!passed)
+            {
+                ++Failures();
+                std::wcout << file << L"(" << line << L"): check failed: " << expression << L"\n";
+            }
+            return passed;
+        }
+
+        inline bool CheckNear(double actual, double expected, double tolerance, const char* expression, const char* file, int line)
+        {
+            if (!(std::fabs(actual - expected) <= tolerance))
+            {
+                ++Failures();
+                std::wcout << file << L"(" << line << L"): check failed: " << expression
+                    << L" is " << actual << L", expected " << expected << L" within " << tolerance << L"\n";
+                return false;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// What main returns: 0 when every check passed.
+        /// </summary>
+        inline int Result(const wchar_t* name)
+        {
+            std::wcout << name << (Failures() == 0 ? L": passed\n" : L": FAILED\n");
+            return Failures() == 0 ? 0 : 1;
+        }
+    }
+}
+
+#define CHECK(condition) SDKSample::Bench::Check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_NEAR(actual, expected, tolerance) \
+    SDKSample::Bench::CheckNear((actual), (expected), (tolerance), #actual, __FILE__, __LINE__)
@@ -0,0 +1,215 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// CompressedHistoryTest.cpp
+// Round trips through the history for every timestamp bucket, range queries, retention and
+// the on-demand summary
+//
+
+#include "pch.h"
+#include "Check.h"
+#include "SyntheticSensor.h"
+
+#include "CompressedHistory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Second = 10000000;
+    const long long Forever = 1000LL * 24 * 3600 * Second;
+
+    std::vector<SensorSample> Readings(size_t count, double rate, unsigned int seed)
+    {
+        SyntheticAccelerometer sensor(rate, seed);
+        std::vector<SensorSample> readings(count);
+        for (auto& reading : readings)
+        {
+            reading = sensor.Next();
+        }
+        return readings;
+    }
+
+    bool Same(const SensorSample& a, const SensorSample& b)
+    {
+        return a.Timestamp == b.Timestamp && a.X == b.X && a.Y == b.Y && a.Z == b.Z;
+    }
+
+    // everything the history returns for begin to end, which should be readings[first, last)
+    bool Matches(const CompressedHistory& history, long long begin, long long end,
+        const std::vector<SensorSample>& readings, size_t first, size_t last)
+    {
+        std::vector<SensorSample> seen;
+        size_t visited = history.Query(begin, end, [&](const SensorSample& sample)
+        {
+            seen.push_back(sample);
+        });
+        bool same = visited == seen.size() && seen.size() == last - first;
+        for (size_t i = 0; same && i < seen.size(); ++i)
+        {
+            same = Same(seen[i], readings[first + i]);
+        }
+        return same;
+    }
+
+    void TestRoundTrip()
+    {
+        // a jittered 60 Hz sensor, with chunks sealed and one left open
+        auto readings = Readings(5000, 60.0, 48);
+        CompressedHistory history(Forever, 512);
+        for (auto& reading : readings)
+        {
+            CHECK(history.Append(reading));
+        }
+        CHECK(history.Samples() == readings.size());
+        CHECK(Matches(history, (std::numeric_limits<long long>::min)(), (std::numeric_limits<long long>::max)(), readings, 0, readings.size()));
+
+        // ranges within a chunk, across chunk boundaries and into the open chunk
+        CHECK(Matches(history, readings[10].Timestamp, readings[20].Timestamp, readings, 10, 21));
+        CHECK(Matches(history, readings[500].Timestamp, readings[1600].Timestamp, readings, 500, 1601));
+        CHECK(Matches(history, readings[4800].Timestamp + 1, readings.back().Timestamp, readings, 4801, readings.size()));
+        CHECK(Matches(history, readings.back().Timestamp + 1, readings.back().Timestamp + Second, readings, 0, 0));
+    }
+
+    void TestTimestampBuckets()
+    {
+        // changes of interval at the edge of each delta-of-delta bucket, both ways, and beyond
+        const long long changes[] = {0, 1, -1, 8191, -8192, 8192, -8193, 524287, -524288, 524288, -524289,
+            2147483647LL, -2147483648LL, 2147483648LL, 40LL * 24 * 3600 * Second};
+        std::vector<SensorSample> readings;
+        long long timestamp = SyntheticAccelerometer::Epoch();
+        long long interval = 3LL * 24 * 3600 * Second;
+        SensorSample sample = {timestamp, 0.25, -0.5, 1.0, SensorSample::clock::time_point()};
+        for (auto change : changes)
+        {
+            interval += change;
+            timestamp += interval;
+            sample.Timestamp = timestamp;
+            sample.X = -sample.X;
+            readings.push_back(sample);
+        }
+        CompressedHistory history(Forever, 64);
+        for (auto& reading : readings)
+        {
+            CHECK(history.Append(reading));
+        }
+        CHECK(Matches(history, (std::numeric_limits<long long>::min)(), (std::numeric_limits<long long>::max)(), readings, 0, readings.size()));
+    }
+
+    void TestCompression()
+    {
+        // with the axes held still, the timestamps are what is left: 0.3ms of jitter at 100 Hz
+        // fits the 14-bit bucket and 1ms the 20-bit one, where the 12-bit bucket of Gorilla
+        // took 68 bits for nearly every reading, 9 bytes in all
+        const double jitters[] = {0.03, 0.1};
+        const double bounds[] = {3.5, 4.0};
+        for (int i = 0; i < 2; ++i)
+        {
+            SyntheticAccelerometer sensor(100.0, 3);
+            sensor.Jitter = jitters[i];
+            CompressedHistory history(Forever, 512);
+            size_t count = 30000;
+            for (size_t n = 0; n < count; ++n)
+            {
+                SensorSample reading = sensor.Next();
+                reading.X = 0.0;
+                reading.Y = 0.0;
+                reading.Z = -1.0;
+                history.Append(reading);
+            }
+            CHECK(static_cast<double>(history.Bytes()) / count < bounds[i]);
+        }
+    }
+
+    void TestRetentionAndOrder()
+    {
+        // whole chunks older than the retention are forgotten, and late readings are dropped
+        auto readings = Readings(6000, 50.0, 9);
+        CompressedHistory history(30 * Second, 100);
+        for (auto& reading : readings)
+        {
+            history.Append(reading);
+        }
+        long long oldest;
+        long long newest;
+        CHECK(history.Span(oldest, newest));
+        CHECK(newest == readings.back().Timestamp);
+        CHECK(oldest <= newest - 30 * Second && oldest > newest - 30 * Second - 3 * Second);
+        CHECK(history.Samples() < 1700);
+
+        SensorSample late = readings.back();
+        late.Timestamp -= 1;
+        CHECK(!history.Append(late));
+        CHECK(history.Report(L"history").find(L"dropped=1") != std::wstring::npos);
+
+        CompressedHistory empty(Second, 16);
+        CHECK(!empty.Span(oldest, newest));
+    }
+
+    void TestMaximumMagnitude()
+    {
+        auto readings = Readings(3000, 60.0, 21);
+        readings[1234].X = 3.0;
+        CompressedHistory history(Forever, 256);
+        for (auto& reading : readings)
+        {
+            history.Append(reading);
+        }
+        double expected = 0.0;
+        for (size_t i = 1000; i <= 2990; ++i)
+        {
+            auto& r = readings[i];
+            expected = (std::max)(expected, std::sqrt(r.X * r.X + r.Y * r.Y + r.Z * r.Z));
+        }
+        double maximum;
+        CHECK(history.MaximumMagnitude(readings[1000].Timestamp, readings[2990].Timestamp, maximum));
+        CHECK(std::fabs(maximum - expected) < 1e-12);
+        CHECK(!history.MaximumMagnitude(readings.back().Timestamp + 1, readings.back().Timestamp + Second, maximum));
+
+        // random ranges, whose edges fall inside sealed chunks and the open one
+        std::mt19937 random(49);
+        std::uniform_int_distribution<size_t> positions(0, readings.size() - 1);
+        bool agrees = true;
+        for (int query = 0; query < 500 && agrees; ++query)
+        {
+            size_t first = positions(random);
+            size_t last = positions(random);
+            if (first > last)
+            {
+                std::swap(first, last);
+            }
+            expected = 0.0;
+            for (size_t i = first; i <= last; ++i)
+            {
+                auto& r = readings[i];
+                expected = (std::max)(expected, std::sqrt(r.X * r.X + r.Y * r.Y + r.Z * r.Z));
+            }
+            agrees = history.MaximumMagnitude(readings[first].Timestamp, readings[last].Timestamp, maximum) &&
+                std::fabs(maximum - expected) < 1e-12;
+        }
+        CHECK(agrees);
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestTimestampBuckets();
+    TestCompression();
+    TestRetentionAndOrder();
+    TestMaximumMagnitude();
+    return Result(L"CompressedHistoryTest");
+}
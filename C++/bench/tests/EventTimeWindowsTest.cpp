@@ -0,0 +1,256 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// EventTimeWindowsTest.cpp
+// Tumbling, sliding and session windows of shuffled streams against the windows of the
+// readings in timestamp order
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "Check.h"
+
+#include "EventTimeWindows.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Period = 100000;
+
+    // a window as emitted: its bounds, how many readings and the sum of their indices
+    struct Emitted
+    {
+        long long Start;
+        long long End;
+        size_t Count;
+        double Indices;
+
+        bool operator==(const Emitted& other) const
+        {
+            return Start == other.Start && End == other.End && Count == other.Count && Indices == other.Indices;
+        }
+    };
+
+    SensorSample Reading(long long timestamp)
+    {
+        SensorSample sample = {timestamp, static_cast<double>(timestamp / Period), 0.0, 1.0, SensorSample::clock::now()};
+        return sample;
+    }
+
+    // readings at the timestamps, in the order they arrive when each is delayed by up to
+    // lateness
+    std::vector<SensorSample> Shuffle(const std::vector<long long>& timestamps, long long lateness, unsigned int seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<long long> delay(0, lateness);
+        std::vector<std::pair<long long, long long>> arrivals;
+        for (auto t : timestamps)
+        {
+            arrivals.push_back(std::make_pair(t + delay(random), t));
+        }
+        std::stable_sort(arrivals.begin(), arrivals.end());
+        std::vector<SensorSample> readings;
+        for (auto& arrival : arrivals)
+        {
+            readings.push_back(Reading(arrival.second));
+        }
+        return readings;
+    }
+
+    std::vector<long long> Steady(size_t count)
+    {
+        std::vector<long long> timestamps;
+        for (size_t i = 0; i < count; ++i)
+        {
+            timestamps.push_back(static_cast<long long>(i) * Period);
+        }
+        return timestamps;
+    }
+
+    // the non-empty windows [k * slide, k * slide + size) of the timestamps, by scanning; the
+    // first windows of a sliding stream start before its first reading
+    std::vector<Emitted> Expected(const std::vector<long long>& timestamps, long long size, long long slide)
+    {
+        std::map<long long, Emitted> windows;
+        for (auto t : timestamps)
+        {
+            for (long long k = t / slide; k * slide + size > t; --k)
+            {
+                Emitted empty = {k * slide, k * slide + size, 0, 0.0};
+                auto& window = windows.insert(std::make_pair(k, empty)).first->second;
+                ++window.Count;
+                window.Indices += static_cast<double>(t / Period);
+            }
+        }
+        std::vector<Emitted> expected;
+        for (auto& window : windows)
+        {
+            expected.push_back(window.second);
+        }
+        return expected;
+    }
+
+    template<class Windows>
+    std::vector<Emitted> Run(Windows& windows, const std::vector<SensorSample>& readings)
+    {
+        std::vector<Emitted> emitted;
+        auto collect = [&](long long start, long long end, const ReadingSummary& summary)
+        {
+            Emitted window = {start, end, summary.Count, summary.Sum[0]};
+            emitted.push_back(window);
+        };
+        for (auto& sample : readings)
+        {
+            windows.Push(sample, collect);
+        }
+        windows.Flush(collect);
+        return emitted;
+    }
+
+    void TestTumbling()
+    {
+        auto timestamps = Steady(2000);
+        for (long long lateness = 0; lateness <= 8 * Period; lateness += 2 * Period)
+        {
+            EventTimeWindows<ReadingSummary> windows(16 * Period, 16 * Period, lateness);
+            auto emitted = Run(windows, Shuffle(timestamps, lateness, 3));
+            CHECK(emitted == Expected(timestamps, 16 * Period, 16 * Period));
+            CHECK(windows.Late() == 0);
+        }
+    }
+
+    void TestSliding()
+    {
+        // windows of 16 readings every 4, with readings up to 10 periods late
+        auto timestamps = Steady(2000);
+        const long long lateness = 10 * Period;
+        EventTimeWindows<ReadingSummary> windows(16 * Period, 4 * Period, lateness);
+        auto emitted = Run(windows, Shuffle(timestamps, lateness, 5));
+        CHECK(emitted == Expected(timestamps, 16 * Period, 4 * Period));
+        CHECK(windows.Late() == 0);
+    }
+
+    void TestGapsAreSkipped()
+    {
+        // a stream that pauses for many windows emits none for the pause
+        std::vector<long long> timestamps = Steady(100);
+        for (long long i = 1000; i < 1100; ++i)
+        {
+            timestamps.push_back(i * Period);
+        }
+        const long long lateness = 3 * Period;
+        EventTimeWindows<ReadingSummary> windows(8 * Period, 8 * Period, lateness);
+        auto emitted = Run(windows, Shuffle(timestamps, lateness, 7));
+        CHECK(emitted == Expected(timestamps, 8 * Period, 8 * Period));
+    }
+
+    void TestTooLate()
+    {
+        // a reading whose window has been emitted is counted and dropped
+        EventTimeWindows<ReadingSummary> windows(4 * Period, 4 * Period, Period);
+        std::vector<SensorSample> readings;
+        for (long long i = 0; i < 40; ++i)
+        {
+            readings.push_back(Reading(i * Period));
+        }
+        readings.push_back(Reading(2 * Period));
+        readings.push_back(Reading(37 * Period));
+        auto emitted = Run(windows, readings);
+        CHECK(windows.Late() == 1);
+        CHECK(emitted.size() == 10);
+        CHECK(emitted.back().Count == 5);
+        size_t total = 0;
+        for (auto& window : emitted)
+        {
+            total += window.Count;
+        }
+        CHECK(total == 41);
+    }
+
+    void TestReset()
+    {
+        // a restarted stream may begin before the one that ended
+        EventTimeWindows<ReadingSummary> windows(4 * Period, 4 * Period, Period);
+        auto first = Run(windows, Shuffle(Steady(100), Period, 9));
+        CHECK(first.size() == 25);
+        windows.Reset();
+        auto again = Run(windows, Shuffle(Steady(100), Period, 11));
+        CHECK(again == first);
+        CHECK(windows.Late() == 0);
+    }
+
+    void TestSessions()
+    {
+        // bursts of 50 readings, 21 periods apart, with lateness enough to split a burst
+        // into sessions that the late readings join again
+        std::vector<long long> timestamps;
+        std::vector<Emitted> expected;
+        for (long long burst = 0; burst < 40; ++burst)
+        {
+            long long start = burst * 70 * Period;
+            Emitted session = {start, start + 49 * Period + 1, 50, 0.0};
+            for (long long i = 0; i < 50; ++i)
+            {
+                timestamps.push_back(start + i * Period);
+                session.Indices += static_cast<double>(burst * 70 + i);
+            }
+            expected.push_back(session);
+        }
+        const long long gap = 5 * Period;
+        const long long lateness = 12 * Period;
+        SessionWindows<ReadingSummary> sessions(gap, lateness);
+        auto emitted = Run(sessions, Shuffle(timestamps, lateness, 13));
+        CHECK(emitted == expected);
+        CHECK(sessions.Late() == 0);
+    }
+
+    void TestNoAllocations()
+    {
+        // the ring and the session storage are reused once they have grown
+        auto readings = Shuffle(Steady(5000), 4 * Period, 17);
+        EventTimeWindows<ReadingSummary> sliding(16 * Period, 4 * Period, 4 * Period);
+        SessionWindows<ReadingSummary> sessions(Period / 2, 4 * Period);
+        size_t emitted = 0;
+        auto count = [&](long long, long long, const ReadingSummary&)
+        {
+            ++emitted;
+        };
+        for (size_t i = 0; i < 100; ++i)
+        {
+            sliding.Push(readings[i], count);
+            sessions.Push(readings[i], count);
+        }
+        AllocationDelta allocations;
+        for (size_t i = 100; i < readings.size(); ++i)
+        {
+            sliding.Push(readings[i], count);
+            sessions.Push(readings[i], count);
+        }
+        CHECK(allocations.Total() == 0);
+        CHECK(emitted > readings.size());
+    }
+}
+
+int main()
+{
+    TestTumbling();
+    TestSliding();
+    TestGapsAreSkipped();
+    TestTooLate();
+    TestReset();
+    TestSessions();
+    TestNoAllocations();
+    return Result(L"EventTimeWindowsTest");
+}
@@ -0,0 +1,185 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// FixedPointTest.cpp
+// The fixed-point kernels and statistics against the double path, within the bounds that
+// FixedPoint.h documents
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "FixedPoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // one Q15 step, and the bounds of the header
+    const double Step = 16.0 / 32768.0;
+    const double AxisBound = Step / 2.0;
+    const double MagnitudeBound = 0.001;
+
+    void TestQuantization()
+    {
+        std::mt19937 random(47);
+        // the largest Q15 value is one step short of the full scale
+        std::uniform_real_distribution<double> values(-FixedPoint::FullScale(), FixedPoint::FullScale() - Step);
+        double worst = 0.0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            double value = values(random);
+            worst = (std::max)(worst, std::fabs(FixedPoint::FromQ15(FixedPoint::ToQ15(value)) - value));
+        }
+        CHECK(worst <= AxisBound + 1e-12);
+
+        // readings beyond the full scale are clamped
+        CHECK(FixedPoint::ToQ15(40.0) == 32767);
+        CHECK(FixedPoint::ToQ15(-40.0) == -32768);
+        CHECK(FixedPoint::ToQ15(0.0) == 0);
+    }
+
+    void TestSquareRoot()
+    {
+        // exact around every perfect square the float estimate can get wrong, and at the
+        // largest sum of squares
+        bool exact = true;
+        for (uint32_t root = 0; root < 56756 && exact; root += 7)
+        {
+            uint32_t square = root * root;
+            exact = FixedPoint::SquareRoot(square) == root &&
+                (square == 0 || FixedPoint::SquareRoot(square - 1) == root - 1) &&
+                FixedPoint::SquareRoot(square + 1) == (root == 0 ? 1 : root);
+        }
+        CHECK(exact);
+        uint32_t largest = 3u * 32768u * 32768u;
+        uint32_t root = FixedPoint::SquareRoot(largest);
+        CHECK(static_cast<uint64_t>(root) * root <= largest && static_cast<uint64_t>(root + 1) * (root + 1) > largest);
+    }
+
+    void TestMagnitude()
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> axes(-4.0, 4.0);
+        double worst = 0.0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            double x = axes(random);
+            double y = axes(random);
+            double z = axes(random);
+            uint32_t magnitude = FixedPoint::Magnitude(FixedPoint::ToQ15(x), FixedPoint::ToQ15(y), FixedPoint::ToQ15(z));
+            worst = (std::max)(worst, std::fabs(FixedPoint::FromQ15(magnitude) - std::sqrt(x * x + y * y + z * z)));
+        }
+        CHECK(worst <= MagnitudeBound);
+    }
+
+    void TestSlidingStatistics()
+    {
+        // a random walk, so the extremes move in and out of the window
+        std::mt19937 random(12);
+        std::normal_distribution<double> steps(0.0, 0.05);
+        const size_t windows[] = {1, 3, 64, 500};
+        for (auto window : windows)
+        {
+            FixedSlidingStatistics fixed(window);
+            SlidingStatistics reference(window);
+            std::vector<int16_t> quantized;
+            double value = 0.0;
+            bool extremesExact = true;
+            double worstMean = 0.0;
+            double worstRms = 0.0;
+            double worstVariance = 0.0;
+            for (int i = 0; i < 5000; ++i)
+            {
+                value = (std::max)(-8.0, (std::min)(8.0, value + steps(random)));
+                int16_t q = FixedPoint::ToQ15(value);
+                quantized.push_back(q);
+                fixed.Push(q);
+                reference.Push(value);
+
+                auto a = fixed.Current();
+                auto b = reference.Current();
+                size_t count = (std::min)(window, quantized.size());
+                auto begin = quantized.end() - count;
+                extremesExact = extremesExact && a.Count == b.Count &&
+                    a.Minimum == FixedPoint::FromQ15(*std::min_element(begin, quantized.end())) &&
+                    a.Maximum == FixedPoint::FromQ15(*std::max_element(begin, quantized.end()));
+                worstMean = (std::max)(worstMean, std::fabs(a.Mean - b.Mean));
+                worstRms = (std::max)(worstRms, std::fabs(a.Rms - b.Rms));
+                worstVariance = (std::max)(worstVariance, std::fabs(a.Variance - b.Variance));
+            }
+            CHECK(extremesExact);
+            CHECK(worstMean <= AxisBound);
+            CHECK(worstRms <= AxisBound + 1e-9);
+            CHECK(worstVariance <= 16.0 * AxisBound);
+        }
+
+        // Reset forgets the window, extremes included
+        FixedSlidingStatistics statistics(4);
+        statistics.Push(1000);
+        statistics.Reset();
+        statistics.Push(-5);
+        CHECK(statistics.Current().Count == 1 && statistics.Current().Maximum == FixedPoint::FromQ15(-5));
+    }
+
+    void TestSensorStatistics()
+    {
+        std::mt19937 random(3);
+        std::normal_distribution<double> noise(0.0, 0.3);
+        FixedSensorStatistics fixed(64);
+        SensorStatistics<SlidingStatistics> reference(size_t(64));
+        double worst = 0.0;
+        for (int i = 0; i < 10000; ++i)
+        {
+            SensorSample sample;
+            sample.Timestamp = i;
+            sample.X = noise(random);
+            sample.Y = noise(random);
+            sample.Z = -1.0 + noise(random);
+            fixed.Push(sample);
+            reference.Push(sample);
+            auto a = fixed.Magnitude();
+            auto b = reference.Magnitude();
+            worst = (std::max)(worst, (std::max)(std::fabs(a.Mean - b.Mean),
+                (std::max)(std::fabs(a.Minimum - b.Minimum), std::fabs(a.Maximum - b.Maximum))));
+        }
+        CHECK(worst <= MagnitudeBound);
+    }
+
+    void TestEmptyWindow()
+    {
+        bool thrown = false;
+        try
+        {
+            FixedSlidingStatistics statistics(0);
+        }
+        catch (const std::invalid_argument&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}
+
+int main()
+{
+    TestQuantization();
+    TestSquareRoot();
+    TestMagnitude();
+    TestSlidingStatistics();
+    TestSensorStatistics();
+    TestEmptyWindow();
+    return Result(L"FixedPointTest");
+}
@@ -0,0 +1,97 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// LayoutTrackerTest.cpp
+// Coalescing of size events and the width and layout changes that LayoutTracker reports
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "LayoutTracker.h"
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    void TestBuckets()
+    {
+        // split where LayoutAwarePage::DetermineVisualState splits
+        CHECK(LayoutTracker::BucketFor(0.0) == LayoutBucket::Below768);
+        CHECK(LayoutTracker::BucketFor(767.9) == LayoutBucket::Below768);
+        CHECK(LayoutTracker::BucketFor(768.0) == LayoutBucket::Default);
+        CHECK(LayoutTracker::BucketFor(1920.0) == LayoutBucket::Default);
+    }
+
+    void TestCoalescing()
+    {
+        // a burst of events schedules one update, and the next burst another
+        LayoutTracker tracker;
+        CHECK(tracker.Schedule());
+        for (int i = 0; i < 100; ++i)
+        {
+            CHECK(!tracker.Schedule());
+        }
+        tracker.Update(1366.0);
+        CHECK(tracker.Schedule());
+        CHECK(!tracker.Schedule());
+    }
+
+    void TestChanges()
+    {
+        LayoutTracker tracker;
+
+        // the first update lays everything out
+        auto changes = tracker.Update(1366.0);
+        CHECK(changes.Width && changes.Bucket);
+
+        // a size event that did not change the width, e.g. only the height
+        changes = tracker.Update(1366.0);
+        CHECK(!changes.Width && !changes.Bucket);
+
+        // less than half a pixel is no change
+        changes = tracker.Update(1366.4);
+        CHECK(!changes.Width && !changes.Bucket);
+
+        // narrower, in the same layout
+        changes = tracker.Update(1000.0);
+        CHECK(changes.Width && !changes.Bucket);
+
+        // across the split and back
+        changes = tracker.Update(700.0);
+        CHECK(changes.Width && changes.Bucket);
+        changes = tracker.Update(760.0);
+        CHECK(changes.Width && !changes.Bucket);
+        changes = tracker.Update(768.0);
+        CHECK(changes.Width && changes.Bucket);
+    }
+
+    void TestApplied()
+    {
+        // a layout applied for a new scenario is not applied again by the next update
+        LayoutTracker tracker;
+        tracker.Applied(500.0);
+        auto changes = tracker.Update(500.0);
+        CHECK(!changes.Width && !changes.Bucket);
+        tracker.Applied(900.0);
+        changes = tracker.Update(900.0);
+        CHECK(!changes.Width && !changes.Bucket);
+        changes = tracker.Update(600.0);
+        CHECK(changes.Width && changes.Bucket);
+    }
+}
+
+int main()
+{
+    TestBuckets();
+    TestCoalescing();
+    TestChanges();
+    TestApplied();
+    return Result(L"LayoutTrackerTest");
+}
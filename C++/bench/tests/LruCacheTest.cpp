@@ -0,0 +1,178 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// LruCacheTest.cpp
+// Eviction order, recency, replacement and capacity changes of LruCache, and random use
+// against a list kept in recency order
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "LruCache.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef LruCache<unsigned int, std::string> Cache;
+
+    // collects the evicted keys
+    struct Evicted
+    {
+        std::vector<unsigned int>* Keys;
+
+        void operator()(const unsigned int& key, std::string&) const
+        {
+            Keys->push_back(key);
+        }
+    };
+
+    void TestEvictsLeastRecentlyUsed()
+    {
+        Cache cache(3);
+        std::vector<unsigned int> evicted;
+        Evicted evict = {&evicted};
+        cache.Insert(1, "one", evict);
+        cache.Insert(2, "two", evict);
+        cache.Insert(3, "three", evict);
+        CHECK(evicted.empty() && cache.Size() == 3);
+
+        // finding 1 makes 2 the oldest
+        CHECK(cache.Find(1) != nullptr && *cache.Find(1) == "one");
+        cache.Insert(4, "four", evict);
+        CHECK(evicted.size() == 1 && evicted[0] == 2);
+        CHECK(cache.Find(2) == nullptr);
+        CHECK(cache.Find(3) != nullptr && cache.Find(4) != nullptr && cache.Size() == 3);
+    }
+
+    void TestReplace()
+    {
+        // replacing a value keeps one entry, makes it the newest and evicts nothing
+        Cache cache(2);
+        std::vector<unsigned int> evicted;
+        Evicted evict = {&evicted};
+        cache.Insert(1, "one", evict);
+        cache.Insert(2, "two", evict);
+        cache.Insert(1, "uno", evict);
+        CHECK(evicted.empty() && cache.Size() == 2);
+        CHECK(*cache.Find(1) == "uno");
+        cache.Insert(3, "three", evict);
+        CHECK(evicted.size() == 1 && evicted[0] == 2);
+    }
+
+    void TestSetCapacity()
+    {
+        Cache cache(4);
+        std::vector<unsigned int> evicted;
+        Evicted evict = {&evicted};
+        for (unsigned int key = 1; key <= 4; ++key)
+        {
+            cache.Insert(key, std::to_string(key), evict);
+        }
+        cache.Find(1);
+        cache.SetCapacity(2, evict);
+        CHECK(evicted.size() == 2 && evicted[0] == 2 && evicted[1] == 3);
+        CHECK(cache.Capacity() == 2 && cache.Size() == 2);
+        CHECK(cache.Find(1) != nullptr && cache.Find(4) != nullptr);
+
+        // growing evicts nothing, and a cache of no values keeps none
+        cache.SetCapacity(8, evict);
+        CHECK(evicted.size() == 2 && cache.Size() == 2);
+        cache.SetCapacity(0, evict);
+        CHECK(cache.Size() == 0 && evicted.size() == 4);
+        cache.Insert(5, "five", evict);
+        CHECK(cache.Size() == 0 && evicted.back() == 5);
+    }
+
+    void TestRemove()
+    {
+        // a removed value is not passed to evict
+        Cache cache(2);
+        std::vector<unsigned int> evicted;
+        Evicted evict = {&evicted};
+        cache.Insert(1, "one", evict);
+        cache.Insert(2, "two", evict);
+        CHECK(cache.Remove(1));
+        CHECK(!cache.Remove(1));
+        cache.Insert(3, "three", evict);
+        CHECK(evicted.empty() && cache.Size() == 2);
+        CHECK(cache.Find(1) == nullptr);
+    }
+
+    void TestAgainstModel()
+    {
+        // the cache and a list of keys from newest to oldest agree after random use
+        std::mt19937 random(21);
+        std::uniform_int_distribution<unsigned int> keys(0, 11);
+        std::uniform_int_distribution<int> operations(0, 9);
+        Cache cache(5);
+        std::vector<unsigned int> model;
+        std::vector<unsigned int> evicted;
+        std::vector<unsigned int> expectedEvictions;
+        Evicted evict = {&evicted};
+        bool agrees = true;
+        for (int step = 0; step < 20000 && agrees; ++step)
+        {
+            unsigned int key = keys(random);
+            auto found = std::find(model.begin(), model.end(), key);
+            int operation = operations(random);
+            if (operation < 4)
+            {
+                bool cached = cache.Find(key) != nullptr;
+                agrees = cached == (found != model.end());
+                if (found != model.end())
+                {
+                    model.erase(found);
+                    model.insert(model.begin(), key);
+                }
+            }
+            else if (operation < 9)
+            {
+                cache.Insert(key, std::to_string(key), evict);
+                if (found != model.end())
+                {
+                    model.erase(found);
+                }
+                model.insert(model.begin(), key);
+                if (model.size() > 5)
+                {
+                    expectedEvictions.push_back(model.back());
+                    model.pop_back();
+                }
+            }
+            else
+            {
+                agrees = cache.Remove(key) == (found != model.end());
+                if (found != model.end())
+                {
+                    model.erase(found);
+                }
+            }
+            agrees = agrees && cache.Size() == model.size() && evicted == expectedEvictions;
+        }
+        CHECK(agrees);
+    }
+}
+
+int main()
+{
+    TestEvictsLeastRecentlyUsed();
+    TestReplace();
+    TestSetCapacity();
+    TestRemove();
+    TestAgainstModel();
+    return Result(L"LruCacheTest");
+}
@@ -0,0 +1,383 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ProcessingGraphTest.cpp
+// Order of results, allocations per value, Close and the queues of the worker pool
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "Check.h"
+
+#include "ProcessingGraph.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    typedef ProcessingStage<int, int> Stage;
+
+    // counts down until every value has reached the sink
+    class Latch
+    {
+    public:
+        explicit Latch(int count) : count(count)
+        {
+        }
+
+        void Arrive()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (--count == 0)
+            {
+                done.notify_all();
+            }
+        }
+
+        bool Wait()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            return done.wait_for(guard, std::chrono::seconds(30), [this]()
+            {
+                return count <= 0;
+            });
+        }
+
+    private:
+        std::mutex lock;
+        std::condition_variable done;
+        int count;
+    };
+
+    // the last worker to finish may hold the stage for a moment after its sink
+    bool Released(const std::weak_ptr<Stage>& weak)
+    {
+        for (int i = 0; i < 1000 && !weak.expired(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return weak.expired();
+    }
+
+    void TestRingQueue()
+    {
+        // growing keeps the order of a queue that has wrapped around
+        RingQueue<int> queue;
+        int value = 0;
+        for (int i = 0; i < 10; ++i)
+        {
+            queue.PushBack(i);
+        }
+        for (int i = 0; i < 8; ++i)
+        {
+            queue.PopFront(value);
+        }
+        for (int i = 10; i < 100; ++i)
+        {
+            queue.PushBack(i);
+        }
+        CHECK(queue.Size() == 92);
+        CHECK(queue.PopBack(value) && value == 99);
+        bool ordered = true;
+        for (int i = 8; i < 99; ++i)
+        {
+            ordered = queue.PopFront(value) && value == i && ordered;
+        }
+        CHECK(ordered);
+        CHECK(queue.Empty() && !queue.PopFront(value) && !queue.PopBack(value));
+    }
+
+    void TestWorkerIndex()
+    {
+        auto pool = std::make_shared<WorkerPool>(3);
+        CHECK(pool->Worker() == 3);
+        std::vector<std::atomic<int>> seen(4);
+        Latch latch(64);
+        for (int i = 0; i < 64; ++i)
+        {
+            pool->Post([&]()
+            {
+                ++seen[pool->Worker()];
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                latch.Arrive();
+            });
+        }
+        CHECK(latch.Wait());
+        CHECK(seen[0] + seen[1] + seen[2] == 64);
+        CHECK(seen[3] == 0);
+    }
+
+    void TestOrder()
+    {
+        // values that take longer the earlier they were pushed still come out in order
+        auto pool = std::make_shared<WorkerPool>(4);
+        const int count = 400;
+        std::vector<int> results;
+        Latch latch(2 * count);
+        auto stage = std::make_shared<Stage>(pool, 4,
+            [count](const int& value, const Stage::Emit& emit)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(((count - value) % 7) * 50));
+                emit(2 * value);
+                emit(2 * value + 1);
+            },
+            [&](const int& result)
+            {
+                results.push_back(result);
+                latch.Arrive();
+            });
+        for (int i = 0; i < count; ++i)
+        {
+            stage->Push(i);
+        }
+        CHECK(latch.Wait());
+        bool ordered = results.size() == 2 * count;
+        for (size_t i = 0; ordered && i < results.size(); ++i)
+        {
+            ordered = results[i] == static_cast<int>(i);
+        }
+        CHECK(ordered);
+        stage->Close();
+    }
+
+    void TestChainedAllocations()
+    {
+        // once the queues and result slots have grown, values flow through two stages
+        // without allocating
+        auto pool = std::make_shared<WorkerPool>(2);
+        std::atomic<int> delivered(0);
+        auto last = std::make_shared<Stage>(pool, 2,
+            [](const int& value, const Stage::Emit& emit)
+            {
+                emit(value + 1);
+            },
+            [&](const int&)
+            {
+                ++delivered;
+            });
+        auto first = std::make_shared<Stage>(pool, 1,
+            [](const int& value, const Stage::Emit& emit)
+            {
+                emit(value * 3);
+            },
+            [last](const int& result)
+            {
+                last->Push(result);
+            });
+
+        auto run = [&](int count)
+        {
+            int target = delivered + count;
+            for (int i = 0; i < count; ++i)
+            {
+                first->Push(i);
+            }
+            while (delivered < target)
+            {
+                std::this_thread::yield();
+            }
+        };
+        run(2000);
+        AllocationDelta allocations;
+        run(2000);
+        auto total = allocations.Total();
+        CHECK(total == 0);
+        if (total != 0)
+        {
+            std::wcout << L"  allocations for 2000 values=" << total << L"\n";
+        }
+        first->Close();
+        last->Close();
+    }
+
+    void TestClose()
+    {
+        // Close waits for a value being processed, drops the rest and then the sink is quiet
+        auto pool = std::make_shared<WorkerPool>(2);
+        std::atomic<bool> started(false);
+        std::atomic<int> sunk(0);
+        auto stage = std::make_shared<Stage>(pool, 1,
+            [&](const int& value, const Stage::Emit& emit)
+            {
+                started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                emit(value);
+            },
+            [&](const int&)
+            {
+                ++sunk;
+            });
+        std::weak_ptr<Stage> weak = stage;
+        for (int i = 0; i < 10; ++i)
+        {
+            stage->Push(i);
+        }
+        while (!started)
+        {
+            std::this_thread::yield();
+        }
+        stage->Close();
+        int afterClose = sunk;
+        stage->Push(100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(sunk == afterClose);
+        CHECK(afterClose <= 1);
+
+        // nothing is left queued on the pool, so the stage goes with its owner
+        stage.reset();
+        CHECK(Released(weak));
+    }
+
+    void TestStageOutlivesOwner()
+    {
+        // an owner may drop a stage with work in flight; the work still finishes
+        auto pool = std::make_shared<WorkerPool>(2);
+        Latch latch(20);
+        std::weak_ptr<Stage> weak;
+        {
+            auto stage = std::make_shared<Stage>(pool, 2,
+                [](const int& value, const Stage::Emit& emit)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    emit(value);
+                },
+                [&](const int&)
+                {
+                    latch.Arrive();
+                });
+            weak = stage;
+            for (int i = 0; i < 20; ++i)
+            {
+                stage->Push(i);
+            }
+        }
+        CHECK(latch.Wait());
+        CHECK(Released(weak));
+    }
+
+    // true when the stage went within a while, polled from its own sink
+    bool GoesWithin(const std::weak_ptr<Stage>& weak, int milliseconds)
+    {
+        for (int i = 0; i < milliseconds && !weak.expired(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return weak.expired();
+    }
+
+    void TestOwnerDroppedWhileEmitting()
+    {
+        // the last value in flight finishes while another worker is still in the sink with the
+        // one before it, after the owner has dropped the stage: the stage stays until the sink
+        // returns
+        auto pool = std::make_shared<WorkerPool>(2);
+        std::weak_ptr<Stage> weak;
+        std::atomic<bool> emitting(false);
+        std::atomic<bool> lastDone(false);
+        std::atomic<bool> wentInSink(false);
+        Latch latch(2);
+        {
+            auto stage = std::make_shared<Stage>(pool, 2,
+                [&](const int& value, const Stage::Emit& emit)
+                {
+                    while (value == 1 && !emitting)
+                    {
+                        std::this_thread::yield();
+                    }
+                    emit(value);
+                    if (value == 1)
+                    {
+                        lastDone = true;
+                    }
+                },
+                [&](const int& value)
+                {
+                    if (value == 0)
+                    {
+                        emitting = true;
+                        while (!lastDone)
+                        {
+                            std::this_thread::yield();
+                        }
+                        wentInSink = GoesWithin(weak, 50);
+                    }
+                    latch.Arrive();
+                });
+            weak = stage;
+            stage->Push(0);
+            stage->Push(1);
+        }
+        CHECK(latch.Wait());
+        CHECK(!wentInSink);
+        CHECK(Released(weak));
+    }
+
+    void TestCloseFromWorkerWhileEmitting()
+    {
+        // Close on a worker of the pool does not wait, and still leaves the stage to the
+        // thread in the sink
+        auto pool = std::make_shared<WorkerPool>(2);
+        std::weak_ptr<Stage> weak;
+        std::atomic<bool> emitting(false);
+        std::atomic<bool> closed(false);
+        std::atomic<bool> wentInSink(false);
+        Latch latch(1);
+        auto stage = std::make_shared<Stage>(pool, 1,
+            [](const int& value, const Stage::Emit& emit)
+            {
+                emit(value);
+            },
+            [&](const int&)
+            {
+                emitting = true;
+                while (!closed)
+                {
+                    std::this_thread::yield();
+                }
+                wentInSink = GoesWithin(weak, 50);
+                latch.Arrive();
+            });
+        weak = stage;
+        stage->Push(0);
+        while (!emitting)
+        {
+            std::this_thread::yield();
+        }
+        // the posted work holds the last reference, dropped when it returns
+        pool->Post([stage, &closed]()
+        {
+            stage->Close();
+            closed = true;
+        });
+        stage.reset();
+        CHECK(latch.Wait());
+        CHECK(!wentInSink);
+        CHECK(Released(weak));
+    }
+}
+
+int main()
+{
+    TestRingQueue();
+    TestWorkerIndex();
+    TestOrder();
+    TestChainedAllocations();
+    TestClose();
+    TestStageOutlivesOwner();
+    TestOwnerDroppedWhileEmitting();
+    TestCloseFromWorkerWhileEmitting();
+    return Result(L"ProcessingGraphTest");
+}
@@ -0,0 +1,206 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// ResamplerTest.cpp
+// Accuracy of the Resampler for sources slower than, as fast as and faster than the output
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "Resampler.h"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const double pi = 3.14159265358979323846;
+    const long long Second = 10000000;
+
+    struct Tone
+    {
+        double Frequency;
+        double Amplitude;
+    };
+
+    double Signal(const std::vector<Tone>& tones, long long timestamp)
+    {
+        double t = static_cast<double>(timestamp) / Second;
+        double value = 0.0;
+        for (auto& tone : tones)
+        {
+            value += tone.Amplitude * std::sin(2.0 * pi * tone.Frequency * t);
+        }
+        return value;
+    }
+
+    // resamples seconds of the tones read at inputRate with up to jitter of a period of
+    // jitter, and returns the largest difference of an output from expected
+    double Run(double inputRate, double outputRate, double jitter, double seconds,
+        const std::vector<Tone>& tones, const std::vector<Tone>& expected, size_t& outputs)
+    {
+        long long inputPeriod = static_cast<long long>(Second / inputRate);
+        long long outputPeriod = static_cast<long long>(Second / outputRate);
+        Resampler resampler(outputPeriod);
+        std::mt19937 random(11);
+        std::uniform_real_distribution<double> uniform(-jitter, jitter);
+
+        double error = 0.0;
+        long long previous = -1;
+        bool spaced = true;
+        outputs = 0;
+        size_t count = static_cast<size_t>(seconds * inputRate);
+        for (size_t i = 0; i < count; ++i)
+        {
+            SensorSample sample;
+            sample.Timestamp = Second + static_cast<long long>(i) * inputPeriod + static_cast<long long>(uniform(random) * inputPeriod);
+            sample.X = Signal(tones, sample.Timestamp);
+            sample.Y = 1.0;
+            sample.Z = -sample.X;
+            resampler.Push(sample, [&](const SensorSample& output)
+            {
+                double want = Signal(expected, output.Timestamp);
+                error = (std::max)(error, std::fabs(output.X - want));
+                error = (std::max)(error, std::fabs(output.Y - 1.0));
+                error = (std::max)(error, std::fabs(output.Z + want));
+                spaced = spaced && (previous < 0 || output.Timestamp - previous == outputPeriod);
+                previous = output.Timestamp;
+                ++outputs;
+            });
+        }
+        CHECK(spaced);
+        return error;
+    }
+
+    void TestSameRate()
+    {
+        // the app's case: a jittery sensor at the report interval
+        std::vector<Tone> tones(1, Tone{2.0, 0.5});
+        size_t outputs;
+        double error = Run(100.0, 100.0, 0.2, 10.0, tones, tones, outputs);
+        CHECK(outputs > 990 && outputs <= 1000);
+        CHECK_NEAR(error, 0.0, 2e-3);
+    }
+
+    void TestUpsampling()
+    {
+        // a slow wave, so that joining the readings by lines is close to it
+        std::vector<Tone> tones(1, Tone{0.5, 0.5});
+        size_t outputs;
+        double error = Run(25.0, 100.0, 0.1, 10.0, tones, tones, outputs);
+        CHECK(outputs > 980);
+        CHECK_NEAR(error, 0.0, 5e-3);
+    }
+
+    void TestDecimationDoesNotAlias()
+    {
+        // tones a hair off multiples of the output rate fold onto 1 Hz when only some of the
+        // readings are used; all of them must be filtered out
+        std::vector<Tone> tones;
+        tones.push_back(Tone{2.0, 0.5});
+        tones.push_back(Tone{401.0, 0.25});
+        tones.push_back(Tone{1001.0, 0.25});
+        tones.push_back(Tone{2499.0, 0.25});
+        std::vector<Tone> expected(1, Tone{2.0, 0.5});
+        size_t outputs;
+        double error = Run(10000.0, 100.0, 0.1, 5.0, tones, expected, outputs);
+        CHECK(outputs > 490);
+        CHECK_NEAR(error, 0.0, 5e-3);
+
+        // a tone just under the input Nyquist rate, which jitter alone would smear into noise
+        tones.push_back(Tone{4999.0, 0.25});
+        error = Run(10000.0, 100.0, 0.0, 5.0, tones, expected, outputs);
+        CHECK_NEAR(error, 0.0, 1e-3);
+    }
+
+    void TestInvalidPeriod()
+    {
+        // a period shorter than the grid has cells of no width
+        for (long long period = 0; period < Resampler::Oversampling; ++period)
+        {
+            bool thrown = false;
+            try
+            {
+                Resampler resampler(period);
+            }
+            catch (const std::invalid_argument&)
+            {
+                thrown = true;
+            }
+            CHECK(thrown);
+        }
+    }
+
+    void TestShortestPeriod()
+    {
+        // cells of one or two 100ns units, with readings in every unit
+        for (long long period = Resampler::Oversampling; period < 2 * Resampler::Oversampling + 3; ++period)
+        {
+            Resampler resampler(period);
+            size_t outputs = 0;
+            for (long long t = 0; t < 1000; ++t)
+            {
+                SensorSample sample = {t, 1.0, 2.0, 3.0, SensorSample::clock::now()};
+                resampler.Push(sample, [&](const SensorSample& output)
+                {
+                    CHECK_NEAR(output.Z, 3.0, 1e-9);
+                    ++outputs;
+                });
+            }
+            CHECK(outputs != 0);
+        }
+    }
+
+    void TestGapRestarts()
+    {
+        // no output falls into a gap of more than MaximumGap periods
+        const long long period = 100000;
+        Resampler resampler(period);
+        std::vector<long long> times;
+        auto push = [&](long long t)
+        {
+            SensorSample sample = {t, 0.0, 0.0, 1.0, SensorSample::clock::now()};
+            resampler.Push(sample, [&](const SensorSample& output)
+            {
+                times.push_back(output.Timestamp);
+            });
+        };
+        for (long long t = 0; t < 50 * period; t += period)
+        {
+            push(t);
+        }
+        long long resumed = 49 * period + (Resampler::MaximumGap + 1) * period;
+        for (long long t = resumed; t < resumed + 50 * period; t += period)
+        {
+            push(t);
+        }
+        bool inGap = false;
+        for (auto t : times)
+        {
+            inGap = inGap || (t > 49 * period && t < resumed);
+        }
+        CHECK(!inGap);
+        CHECK(!times.empty() && times.back() > resumed);
+    }
+}
+
+int main()
+{
+    TestSameRate();
+    TestUpsampling();
+    TestDecimationDoesNotAlias();
+    TestInvalidPeriod();
+    TestShortestPeriod();
+    TestGapRestarts();
+    return Result(L"ResamplerTest");
+}
@@ -0,0 +1,134 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SensorArbiterTest.cpp
+// The interval SensorArbiter runs a fake device at as consumers come and go, and the readings
+// it thins out for each consumer
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "SensorArbiter.h"
+
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // stands in for the accelerometer, recording each report interval it is set to
+    struct FakeDevice
+    {
+        std::vector<unsigned int> Applied;
+
+        SensorArbiter::Apply Apply()
+        {
+            return [this](unsigned int interval)
+            {
+                Applied.push_back(interval);
+            };
+        }
+    };
+
+    // readings every interval milliseconds, off by up to an eighth of it in turn
+    size_t Delivered(SensorArbiter& arbiter, SensorArbiter::Consumer consumer, unsigned int interval, size_t readings)
+    {
+        size_t delivered = 0;
+        for (size_t i = 0; i < readings; ++i)
+        {
+            long long jitter = (i % 3 == 0 ? -1 : (i % 3 == 1 ? 1 : 0)) * static_cast<long long>(interval) * 1250;
+            long long timestamp = static_cast<long long>(i) * interval * 10000 + jitter;
+            delivered += arbiter.Deliver(consumer, timestamp) ? 1 : 0;
+        }
+        return delivered;
+    }
+
+    void TestShortestInterval()
+    {
+        FakeDevice device;
+        SensorArbiter arbiter(10, device.Apply());
+        CHECK(arbiter.Interval() == 0 && arbiter.Consumers() == 0);
+
+        auto slow = arbiter.Acquire(100);
+        CHECK(arbiter.Interval() == 100);
+        auto fast = arbiter.Acquire(20);
+        CHECK(arbiter.Interval() == 20);
+
+        // a consumer without a preference, or a slower one, changes nothing
+        auto any = arbiter.Acquire(0);
+        auto slower = arbiter.Acquire(50);
+        CHECK(arbiter.Interval() == 20 && arbiter.Consumers() == 4);
+
+        // the sensor slows down once the fast consumer leaves, and goes back to its default
+        // once the last one does
+        arbiter.Release(fast);
+        CHECK(arbiter.Interval() == 50);
+        arbiter.Release(slower);
+        CHECK(arbiter.Interval() == 100);
+        arbiter.Release(slow);
+        CHECK(arbiter.Interval() == 0 && arbiter.Consumers() == 1);
+        arbiter.Release(any);
+        CHECK(arbiter.Consumers() == 0);
+
+        unsigned int expected[] = {100, 20, 50, 100, 0};
+        CHECK(device.Applied == std::vector<unsigned int>(expected, expected + 5));
+    }
+
+    void TestMinimumInterval()
+    {
+        // a request faster than the device supports runs it at its minimum
+        FakeDevice device;
+        SensorArbiter arbiter(16, device.Apply());
+        auto consumer = arbiter.Acquire(5);
+        CHECK(arbiter.Interval() == 16);
+        arbiter.Release(consumer);
+        arbiter.Release(consumer);
+        CHECK(device.Applied.size() == 2 && device.Applied.back() == 0);
+    }
+
+    void TestDecimation()
+    {
+        FakeDevice device;
+        SensorArbiter arbiter(1, device.Apply());
+        auto fast = arbiter.Acquire(16);
+        auto half = arbiter.Acquire(32);
+        auto slow = arbiter.Acquire(160);
+
+        // despite the jitter, each consumer gets the share of the readings due at its interval
+        CHECK(Delivered(arbiter, fast, 16, 600) == 600);
+        CHECK(Delivered(arbiter, half, 16, 600) == 300);
+        CHECK(Delivered(arbiter, slow, 16, 600) == 60);
+
+        // a released consumer gets nothing
+        arbiter.Release(slow);
+        CHECK(!arbiter.Deliver(slow, 1000000000));
+    }
+
+    void TestReport()
+    {
+        FakeDevice device;
+        SensorArbiter arbiter(1, device.Apply());
+        auto consumer = arbiter.Acquire(20);
+        arbiter.Deliver(consumer, 0);
+        arbiter.Deliver(consumer, 1);
+        auto report = arbiter.Report(L"accelerometer");
+        CHECK(report.find(L"accelerometer: consumers=1 interval=20ms") == 0);
+        CHECK(report.find(L"delivered=1 skipped=1") != std::wstring::npos);
+    }
+}
+
+int main()
+{
+    TestShortestInterval();
+    TestMinimumInterval();
+    TestDecimation();
+    TestReport();
+    return Result(L"SensorArbiterTest");
+}
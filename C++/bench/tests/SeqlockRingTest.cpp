@@ -0,0 +1,175 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// SeqlockRingTest.cpp
+// The ring layout, lost records, continuing a ring and a reader racing the writer
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "SeqlockRing.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    SensorSample Record(unsigned long long n)
+    {
+        SensorSample sample;
+        sample.Timestamp = static_cast<long long>(n) * 100000;
+        sample.X = static_cast<double>(n);
+        sample.Y = -sample.X;
+        sample.Z = sample.X / 2.0;
+        return sample;
+    }
+
+    // memory for a ring of capacity records, aligned for the atomics
+    std::vector<uint64_t> Memory(uint32_t capacity)
+    {
+        return std::vector<uint64_t>((SeqlockRing::Bytes(capacity) + 7) / 8);
+    }
+
+    void TestLayout()
+    {
+        CHECK(sizeof(SeqlockRing::Record) == 40);
+        CHECK(sizeof(SeqlockRing::Header) == 24);
+        CHECK(SeqlockRing::Bytes(4096) == 24 + 4096 * 40);
+
+        // memory that holds no ring is not read
+        auto memory = Memory(16);
+        SeqlockRingReader reader(memory.data(), memory.size() * 8);
+        CHECK(!reader.Valid());
+    }
+
+    void TestInOrder()
+    {
+        auto memory = Memory(16);
+        SeqlockRingWriter writer(memory.data(), memory.size() * 8);
+        SeqlockRingReader reader(memory.data(), memory.size() * 8);
+        CHECK(reader.Valid());
+        std::vector<double> seen;
+        for (unsigned long long n = 0; n < 100; ++n)
+        {
+            writer.Publish(Record(n));
+            if (n % 5 == 4)
+            {
+                reader.Poll([&](const SensorSample& sample)
+                {
+                    seen.push_back(sample.X);
+                });
+            }
+        }
+        bool ordered = seen.size() == 100;
+        for (size_t i = 0; ordered && i < seen.size(); ++i)
+        {
+            ordered = seen[i] == static_cast<double>(i);
+        }
+        CHECK(ordered);
+        CHECK(reader.Lost() == 0);
+    }
+
+    void TestLost()
+    {
+        // a reader more than a ring behind loses the oldest records and reads the rest
+        auto memory = Memory(16);
+        SeqlockRingWriter writer(memory.data(), memory.size() * 8);
+        SeqlockRingReader reader(memory.data(), memory.size() * 8);
+        for (unsigned long long n = 0; n < 50; ++n)
+        {
+            writer.Publish(Record(n));
+        }
+        std::vector<double> seen;
+        CHECK(reader.Poll([&](const SensorSample& sample)
+        {
+            seen.push_back(sample.X);
+        }) == 16);
+        CHECK(reader.Lost() == 34);
+        CHECK(!seen.empty() && seen.front() == 34.0 && seen.back() == 49.0);
+    }
+
+    void TestContinue()
+    {
+        // a new writer on the same memory continues the ring, and a new reader starts at its end
+        auto memory = Memory(16);
+        {
+            SeqlockRingWriter writer(memory.data(), memory.size() * 8);
+            for (unsigned long long n = 0; n < 20; ++n)
+            {
+                writer.Publish(Record(n));
+            }
+        }
+        SeqlockRingReader reader(memory.data(), memory.size() * 8);
+        SeqlockRingWriter writer(memory.data(), memory.size() * 8);
+        writer.Publish(Record(20));
+        std::vector<double> seen;
+        reader.Poll([&](const SensorSample& sample)
+        {
+            seen.push_back(sample.X);
+        });
+        CHECK(seen.size() == 1 && seen[0] == 20.0);
+    }
+
+    void TestRacingReader()
+    {
+        // a reader on another thread never sees a torn record, and accounts for every one
+        const unsigned long long count = 2000000;
+        auto memory = Memory(64);
+        SeqlockRingWriter writer(memory.data(), memory.size() * 8);
+        SeqlockRingReader reader(memory.data(), memory.size() * 8);
+        std::atomic<bool> started(false);
+        unsigned long long received = 0;
+        unsigned long long torn = 0;
+        unsigned long long disordered = 0;
+        std::thread follower([&]()
+        {
+            double last = -1.0;
+            started = true;
+            while (received + reader.Lost() < count)
+            {
+                reader.Poll([&](const SensorSample& sample)
+                {
+                    ++received;
+                    torn += (sample.Y != -sample.X || sample.Z != sample.X / 2.0 ||
+                        sample.Timestamp != static_cast<long long>(sample.X) * 100000) ? 1 : 0;
+                    disordered += sample.X <= last ? 1 : 0;
+                    last = sample.X;
+                });
+                std::this_thread::yield();
+            }
+        });
+        while (!started)
+        {
+            std::this_thread::yield();
+        }
+        for (unsigned long long n = 0; n < count; ++n)
+        {
+            writer.Publish(Record(n));
+        }
+        follower.join();
+        CHECK(torn == 0);
+        CHECK(disordered == 0);
+        CHECK(received + reader.Lost() == count);
+        CHECK(received != 0);
+    }
+}
+
+int main()
+{
+    TestLayout();
+    TestInOrder();
+    TestLost();
+    TestContinue();
+    TestRacingReader();
+    return Result(L"SeqlockRingTest");
+}
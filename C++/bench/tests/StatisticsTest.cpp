@@ -0,0 +1,125 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// StatisticsTest.cpp
+// Compares SlidingStatistics with a scan of the window and checks its arguments
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "WindowedStatistics.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    // the statistics of the last window values, from scratch
+    Statistics Scan(const std::vector<double>& values, size_t window)
+    {
+        size_t count = (std::min)(window, values.size());
+        Statistics statistics = {count, 0.0, 0.0, 0.0, 0.0, 0.0};
+        auto begin = values.end() - count;
+        statistics.Minimum = *std::min_element(begin, values.end());
+        statistics.Maximum = *std::max_element(begin, values.end());
+        for (auto i = begin; i != values.end(); ++i)
+        {
+            statistics.Mean += *i / count;
+        }
+        for (auto i = begin; i != values.end(); ++i)
+        {
+            statistics.Variance += (*i - statistics.Mean) * (*i - statistics.Mean) / count;
+        }
+        statistics.Rms = std::sqrt(statistics.Variance + statistics.Mean * statistics.Mean);
+        return statistics;
+    }
+
+    void TestAgainstScan()
+    {
+        // a drifting signal, so that the extremes leave the window as well as arrive
+        std::mt19937 random(5);
+        std::normal_distribution<double> normal(0.0, 0.3);
+        const size_t windows[] = {1, 2, 7, 64, 500};
+        for (auto window : windows)
+        {
+            SlidingStatistics sliding(window);
+            std::vector<double> values;
+            bool matched = true;
+            for (int i = 0; i < 3000; ++i)
+            {
+                double value = std::sin(i * 0.01) + normal(random);
+                values.push_back(value);
+                sliding.Push(value);
+                auto actual = sliding.Current();
+                auto expected = Scan(values, window);
+                matched = matched && actual.Count == expected.Count
+                    && std::fabs(actual.Mean - expected.Mean) < 1e-9
+                    && std::fabs(actual.Variance - expected.Variance) < 1e-9
+                    && std::fabs(actual.Rms - expected.Rms) < 1e-9
+                    && actual.Minimum == expected.Minimum
+                    && actual.Maximum == expected.Maximum;
+            }
+            CHECK(matched);
+        }
+    }
+
+    void TestReset()
+    {
+        SlidingStatistics sliding(4);
+        sliding.Push(10.0);
+        sliding.Push(-10.0);
+        sliding.Reset();
+        CHECK(sliding.Current().Count == 0);
+        sliding.Push(2.0);
+        auto statistics = sliding.Current();
+        CHECK(statistics.Count == 1 && statistics.Mean == 2.0 && statistics.Minimum == 2.0 && statistics.Maximum == 2.0);
+        CHECK(statistics.Variance == 0.0);
+    }
+
+    void TestEmptyWindow()
+    {
+        bool thrown = false;
+        try
+        {
+            SlidingStatistics sliding(0);
+        }
+        catch (const std::invalid_argument&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    void TestSensorStatistics()
+    {
+        SensorStatistics<SlidingStatistics> statistics(static_cast<size_t>(2));
+        SensorSample first = {0, 3.0, 0.0, 4.0, SensorSample::clock::now()};
+        SensorSample second = {1, 0.0, 0.0, 1.0, SensorSample::clock::now()};
+        statistics.Push(first);
+        statistics.Push(second);
+        CHECK_NEAR(statistics.Magnitude().Mean, 3.0, 1e-12);
+        CHECK_NEAR(statistics.Magnitude().Peak(), 5.0, 1e-12);
+        CHECK_NEAR(statistics.Z().Minimum, 1.0, 1e-12);
+        CHECK_NEAR(statistics.X().Rms, std::sqrt(4.5), 1e-12);
+    }
+}
+
+int main()
+{
+    TestAgainstScan();
+    TestReset();
+    TestEmptyWindow();
+    TestSensorStatistics();
+    return Result(L"StatisticsTest");
+}
@@ -0,0 +1,241 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// StatusThrottleTest.cpp
+// Coalescing, per-class rate limits and flush scheduling of StatusThrottle, driven the way
+// MainPage drives it, on virtual time
+//
+
+#include "pch.h"
+#include "Check.h"
+
+#include "StatusThrottle.h"
+#include "VirtualTimeScheduler.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    enum MessageClass
+    {
+        StatusMessage,
+        ErrorMessage
+    };
+
+    const long long Millisecond = 10000;
+
+    // MainPage::NotifyUser and FlushStatus on a virtual clock, recording what the status bar
+    // showed and when
+    class StatusBar
+    {
+    public:
+        struct Shown
+        {
+            long long Time;
+            unsigned int Class;
+            std::wstring Text;
+            unsigned long long Suppressed;
+        };
+
+        StatusBar(VirtualTimeScheduler& scheduler) :
+            scheduler(scheduler),
+            throttle(2, 250 * Millisecond),
+            flushes(0)
+        {
+        }
+
+        void Notify(unsigned int messageClass, const std::wstring& text)
+        {
+            long long delay;
+            if (throttle.Post(Now(), messageClass, text, delay))
+            {
+                Schedule(delay);
+            }
+        }
+
+        long long Now() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(
+                scheduler.Now().time_since_epoch()).count();
+        }
+
+        StatusThrottle& Throttle()
+        {
+            return throttle;
+        }
+
+        const std::vector<Shown>& Screen() const
+        {
+            return screen;
+        }
+
+        size_t Flushes() const
+        {
+            return flushes;
+        }
+
+    private:
+        void Schedule(long long delay)
+        {
+            scheduler.Schedule(std::chrono::duration_cast<VirtualTimeScheduler::duration>(
+                std::chrono::duration<long long, std::ratio<1, 10000000>>(delay)), [this]()
+            {
+                Flush();
+            });
+        }
+
+        void Flush()
+        {
+            ++flushes;
+            StatusThrottle::Status status;
+            long long retry;
+            bool taken = throttle.Take(Now(), status, retry);
+            if (retry != 0)
+            {
+                Schedule(retry);
+            }
+            if (taken)
+            {
+                Shown shown = {Now(), status.Class, status.Text, status.Suppressed};
+                screen.push_back(shown);
+            }
+        }
+
+        VirtualTimeScheduler& scheduler;
+        StatusThrottle throttle;
+        std::vector<Shown> screen;
+        size_t flushes;
+    };
+
+    void TestCoalesced()
+    {
+        // a failure reported with every reading is shown once
+        VirtualTimeScheduler scheduler;
+        StatusBar bar(scheduler);
+        for (int i = 0; i < 600; ++i)
+        {
+            bar.Notify(ErrorMessage, L"sensor failed");
+            scheduler.AdvanceBy(std::chrono::milliseconds(16));
+        }
+        CHECK(bar.Screen().size() == 1 && bar.Screen()[0].Text == L"sensor failed" && bar.Screen()[0].Time == 0);
+        CHECK(bar.Throttle().Posted() == 600 && bar.Throttle().Suppressed() == 599);
+        CHECK(bar.Flushes() == 1);
+    }
+
+    void TestRateLimited()
+    {
+        // a message that changes with every reading is shown every quarter second, the
+        // latest one each time, with nothing waiting once the messages stop
+        VirtualTimeScheduler scheduler;
+        StatusBar bar(scheduler);
+        for (int i = 0; i < 63; ++i)
+        {
+            bar.Notify(StatusMessage, L"reading " + std::to_wstring(i));
+            scheduler.AdvanceBy(std::chrono::milliseconds(16));
+        }
+        scheduler.RunAll();
+        auto& screen = bar.Screen();
+        CHECK(screen.size() == 5);
+        bool paced = true;
+        unsigned long long suppressed = 0;
+        for (size_t i = 0; i < screen.size(); ++i)
+        {
+            paced = paced && screen[i].Time == static_cast<long long>(i) * 250 * Millisecond;
+            suppressed += screen[i].Suppressed;
+        }
+        CHECK(paced);
+        CHECK(screen.back().Text == L"reading 62");
+        CHECK(suppressed + screen.size() == 63);
+        CHECK(scheduler.Empty());
+    }
+
+    void TestClassesIndependent()
+    {
+        // an error waiting for its class does not hold back a status message, and is shown
+        // once its class is due
+        VirtualTimeScheduler scheduler;
+        StatusBar bar(scheduler);
+        bar.Notify(ErrorMessage, L"first error");
+        scheduler.AdvanceBy(std::chrono::milliseconds(10));
+        bar.Notify(ErrorMessage, L"second error");
+        scheduler.AdvanceBy(std::chrono::milliseconds(10));
+        bar.Notify(StatusMessage, L"status");
+        scheduler.AdvanceBy(std::chrono::milliseconds(10));
+        scheduler.RunAll();
+
+        auto& screen = bar.Screen();
+        CHECK(screen.size() == 3);
+        CHECK(screen[0].Text == L"first error" && screen[0].Time == 0);
+        CHECK(screen[1].Text == L"status" && screen[1].Time == 20 * Millisecond);
+        CHECK(screen[2].Text == L"second error" && screen[2].Time == 250 * Millisecond);
+    }
+
+    void TestEarliestFlush()
+    {
+        // the flush is scheduled for the waiting message that is due first, and a message that
+        // is due sooner than the scheduled flush asks for its own
+        StatusThrottle throttle(2, 100 * Millisecond);
+        throttle.SetInterval(ErrorMessage, 400 * Millisecond);
+        long long delay;
+        StatusThrottle::Status status;
+        long long retry;
+        CHECK(throttle.Post(0, ErrorMessage, L"e1", delay) && delay == 0);
+        CHECK(!throttle.Post(0, StatusMessage, L"s1", delay));
+        CHECK(throttle.Take(0, status, retry) && status.Text == L"s1" && retry == 0);
+
+        // e1 was due as well but older than s1, so it was dropped
+        CHECK(status.Suppressed == 1);
+        CHECK(!throttle.Take(0, status, retry) && retry == 0);
+
+        CHECK(throttle.Post(10 * Millisecond, StatusMessage, L"s2", delay) && delay == 90 * Millisecond);
+        CHECK(!throttle.Post(20 * Millisecond, StatusMessage, L"s3", delay));
+        CHECK(throttle.Take(100 * Millisecond, status, retry) && status.Text == L"s3" && retry == 0);
+
+        CHECK(throttle.Post(110 * Millisecond, ErrorMessage, L"e2", delay) && delay == 0);
+        CHECK(throttle.Take(110 * Millisecond, status, retry) && status.Text == L"e2");
+        CHECK(throttle.Post(120 * Millisecond, ErrorMessage, L"e3", delay) && delay == 390 * Millisecond);
+        CHECK(throttle.Post(130 * Millisecond, StatusMessage, L"s4", delay) && delay == 70 * Millisecond);
+
+        // the flush for s4 leaves e3 waiting and asks for the flush for it, which a flush
+        // that runs early does not ask for again
+        CHECK(throttle.Take(200 * Millisecond, status, retry) && status.Text == L"s4" && retry == 310 * Millisecond);
+        CHECK(!throttle.Take(300 * Millisecond, status, retry) && retry == 0);
+        CHECK(throttle.Take(510 * Millisecond, status, retry) && status.Text == L"e3" && retry == 0);
+        CHECK(throttle.Shown() == 5);
+    }
+
+    void TestRepeatOfShown()
+    {
+        // a repeat of the message on screen is coalesced even once its class is due again, and
+        // an empty message clears it
+        StatusThrottle throttle(2, 100 * Millisecond);
+        long long delay;
+        StatusThrottle::Status status;
+        long long retry;
+        CHECK(throttle.Post(0, StatusMessage, L"ready", delay));
+        CHECK(throttle.Take(0, status, retry));
+        CHECK(!throttle.Post(500 * Millisecond, StatusMessage, L"ready", delay));
+        CHECK(throttle.Post(500 * Millisecond, StatusMessage, L"", delay) && delay == 0);
+        CHECK(throttle.Take(500 * Millisecond, status, retry) && status.Text.empty() && status.Suppressed == 1);
+    }
+}
+
+int main()
+{
+    TestCoalesced();
+    TestRateLimited();
+    TestClassesIndependent();
+    TestEarliestFlush();
+    TestRepeatOfShown();
+    return Result(L"StatusThrottleTest");
+}
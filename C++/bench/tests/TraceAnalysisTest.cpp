@@ -0,0 +1,227 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceAnalysisTest.cpp
+// TraceAnalyzer against a single pass of the same operators: the result does not depend on
+// how the trace is partitioned or how many threads analyze it, gestures cut by a partition
+// boundary are joined again, and runs are repeatable bit for bit
+//
+
+#include "pch.h"
+#include "Check.h"
+#include "SyntheticSensor.h"
+
+#include "TraceAnalysis.h"
+#include "TraceFile.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const long long Second = 10000000;
+
+    TraceAnalysisOptions Options(size_t partitions)
+    {
+        TraceAnalysisOptions options = {50, 0.05, 0.5, Second / 2, partitions};
+        return options;
+    }
+
+    // 100 Hz readings with a shake of a second or so every half minute
+    std::vector<SensorSample> Readings(size_t count, unsigned int seed)
+    {
+        SyntheticAccelerometer sensor(100.0, seed);
+        std::vector<SensorSample> readings(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            readings[i] = sensor.Next();
+            if (i % 3000 >= 1500 && i % 3000 < 1500 + 80 + (i / 3000) % 40)
+            {
+                readings[i].X += i % 4 < 2 ? 1.2 : -1.2;
+            }
+        }
+        return readings;
+    }
+
+    double Magnitude(const SensorSample& sample)
+    {
+        return std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+    }
+
+    // the operators in one pass over every reading, as a scenario pipeline runs them
+    TraceAnalysis SinglePass(const std::vector<SensorSample>& readings, const TraceAnalysisOptions& options)
+    {
+        TraceAnalysis analysis;
+        analysis.PeakWindowRms = 0.0;
+        analysis.PeakWindowEnd = 0;
+        analysis.PeakSmoothedMagnitude = 0.0;
+        analysis.PeakSmoothedAt = 0;
+        SlidingStatistics sliding(options.Window);
+        ExponentialStatistics smoothed(options.SmoothingWeight);
+        BurstAggregator shakes(options.ShakeGap);
+        ShakeGesture gesture;
+        double sums[4] = {};
+        double squares[4] = {};
+        for (auto& sample : readings)
+        {
+            double values[4] = {sample.X, sample.Y, sample.Z, Magnitude(sample)};
+            for (int i = 0; i < 4; ++i)
+            {
+                sums[i] += values[i];
+                squares[i] += values[i] * values[i];
+            }
+
+            sliding.Push(values[3]);
+            Statistics window = sliding.Current();
+            if (window.Count == options.Window && window.Rms > analysis.PeakWindowRms)
+            {
+                analysis.PeakWindowRms = window.Rms;
+                analysis.PeakWindowEnd = sample.Timestamp;
+            }
+            smoothed.Push(values[3]);
+            if (smoothed.Current().Mean > analysis.PeakSmoothedMagnitude)
+            {
+                analysis.PeakSmoothedMagnitude = smoothed.Current().Mean;
+                analysis.PeakSmoothedAt = sample.Timestamp;
+            }
+            if (std::fabs(values[3] - 1.0) > options.ShakeThreshold && shakes.Add(sample.Timestamp, values[3], gesture))
+            {
+                analysis.Gestures.push_back(gesture);
+            }
+        }
+        if (shakes.Flush(readings.back().Timestamp + options.ShakeGap, gesture))
+        {
+            analysis.Gestures.push_back(gesture);
+        }
+
+        Statistics* statistics[4] = {&analysis.X, &analysis.Y, &analysis.Z, &analysis.Magnitude};
+        double count = static_cast<double>(readings.size());
+        for (int i = 0; i < 4; ++i)
+        {
+            statistics[i]->Count = readings.size();
+            statistics[i]->Mean = sums[i] / count;
+            statistics[i]->Variance = squares[i] / count - statistics[i]->Mean * statistics[i]->Mean;
+        }
+        return analysis;
+    }
+
+    bool SameGestures(const TraceAnalysis& a, const TraceAnalysis& b)
+    {
+        bool same = a.Gestures.size() == b.Gestures.size();
+        for (size_t i = 0; same && i < a.Gestures.size(); ++i)
+        {
+            same = a.Gestures[i].Start == b.Gestures[i].Start && a.Gestures[i].End == b.Gestures[i].End &&
+                a.Gestures[i].Events == b.Gestures[i].Events && a.Gestures[i].PeakIntensity == b.Gestures[i].PeakIntensity;
+        }
+        return same;
+    }
+
+    // the same result up to rounding, which depends on the partitions
+    bool Equivalent(const TraceAnalysis& actual, const TraceAnalysis& expected)
+    {
+        const Statistics* a[4] = {&actual.X, &actual.Y, &actual.Z, &actual.Magnitude};
+        const Statistics* e[4] = {&expected.X, &expected.Y, &expected.Z, &expected.Magnitude};
+        bool same = true;
+        for (int i = 0; i < 4; ++i)
+        {
+            same = same && a[i]->Count == e[i]->Count &&
+                std::fabs(a[i]->Mean - e[i]->Mean) < 1e-9 && std::fabs(a[i]->Variance - e[i]->Variance) < 1e-9;
+        }
+        return same &&
+            std::fabs(actual.PeakWindowRms - expected.PeakWindowRms) < 1e-9 && actual.PeakWindowEnd == expected.PeakWindowEnd &&
+            std::fabs(actual.PeakSmoothedMagnitude - expected.PeakSmoothedMagnitude) < 1e-9 && actual.PeakSmoothedAt == expected.PeakSmoothedAt &&
+            SameGestures(actual, expected);
+    }
+
+    bool Identical(const TraceAnalysis& a, const TraceAnalysis& b)
+    {
+        return a.Magnitude.Mean == b.Magnitude.Mean && a.Magnitude.Variance == b.Magnitude.Variance &&
+            a.X.Mean == b.X.Mean && a.Z.Variance == b.Z.Variance &&
+            a.PeakWindowRms == b.PeakWindowRms && a.PeakSmoothedMagnitude == b.PeakSmoothedMagnitude &&
+            SameGestures(a, b);
+    }
+
+    void TestPartitionsAgreeWithSinglePass()
+    {
+        auto readings = Readings(60000, 50);
+        TraceAnalysis expected = SinglePass(readings, Options(1));
+        CHECK(expected.Gestures.size() >= 19);
+
+        WorkerPool pool(4);
+        const size_t partitions[] = {1, 2, 7, 64, 1000, 59999, 60000, 100000};
+        for (auto p : partitions)
+        {
+            TraceAnalysis actual = TraceAnalyzer(Options(p)).Run(readings.data(), readings.size(), pool);
+            CHECK(Equivalent(actual, expected));
+        }
+    }
+
+    void TestCutGestures()
+    {
+        // shifted so that every boundary of 30 partitions falls inside a shake
+        auto readings = Readings(91540, 51);
+        readings.erase(readings.begin(), readings.begin() + 1540);
+        TraceAnalysis expected = SinglePass(readings, Options(1));
+        WorkerPool pool(3);
+        TraceAnalysisOptions options = Options(30);
+        TraceAnalysis actual = TraceAnalyzer(options).Run(readings.data(), readings.size(), pool);
+        CHECK(expected.Gestures.size() >= 30);
+        CHECK(SameGestures(actual, expected));
+
+        // and half of the boundaries of 60 fall between shakes, where nothing is joined
+        options.Partitions = 60;
+        actual = TraceAnalyzer(options).Run(readings.data(), readings.size(), pool);
+        CHECK(SameGestures(actual, expected));
+    }
+
+    void TestRepeatable()
+    {
+        // the partitions, not the threads or their timing, decide the rounding
+        auto readings = Readings(40000, 52);
+        WorkerPool one(1);
+        WorkerPool four(4);
+        TraceAnalyzer analyzer(Options(37));
+        TraceAnalysis first = analyzer.Run(readings.data(), readings.size(), one);
+        bool identical = true;
+        for (int run = 0; run < 5; ++run)
+        {
+            identical = identical && Identical(analyzer.Run(readings.data(), readings.size(), four), first);
+        }
+        CHECK(identical);
+    }
+
+    void TestMappedRecords()
+    {
+        // the records of a trace file give the result that the readings do
+        auto readings = Readings(20000, 53);
+        std::vector<TraceFile::Record> records(readings.size());
+        for (size_t i = 0; i < readings.size(); ++i)
+        {
+            TraceFile::Record record = {readings[i].Timestamp, readings[i].X, readings[i].Y, readings[i].Z};
+            records[i] = record;
+        }
+        WorkerPool pool(2);
+        TraceAnalyzer analyzer(Options(8));
+        CHECK(Identical(analyzer.Run(records.data(), records.size(), pool), analyzer.Run(readings.data(), readings.size(), pool)));
+
+        TraceAnalysis empty = analyzer.Run(records.data(), 0, pool);
+        CHECK(empty.Magnitude.Count == 0 && empty.Gestures.empty());
+    }
+}
+
+int main()
+{
+    TestPartitionsAgreeWithSinglePass();
+    TestCutGestures();
+    TestRepeatable();
+    TestMappedRecords();
+    return Result(L"TraceAnalysisTest");
+}
@@ -0,0 +1,253 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// TraceFileTest.cpp
+// Recording a trace file and reading it mapped: the readings and the index round trip, indexed
+// queries agree with a full scan, and damaged files are refused
+//
+
+#include "pch.h"
+#include "Check.h"
+#include "MappedFile.h"
+#include "SyntheticSensor.h"
+
+#include "TraceFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    const char* Path = "TraceFileTest.trace";
+
+    std::vector<SensorSample> Readings(size_t count, unsigned int seed)
+    {
+        SyntheticAccelerometer sensor(100.0, seed);
+        std::vector<SensorSample> readings(count);
+        for (auto& reading : readings)
+        {
+            reading = sensor.Next();
+        }
+        // a few shakes for the index to find
+        for (size_t i = 700; i < readings.size(); i += 2900)
+        {
+            for (size_t j = i; j < i + 150 && j < readings.size(); ++j)
+            {
+                readings[j].X += (j % 2 == 0 ? 1.5 : -1.5);
+            }
+        }
+        return readings;
+    }
+
+    bool Record(const std::vector<SensorSample>& readings, uint32_t blockReadings)
+    {
+        TraceFileWriter writer(Path, blockReadings);
+        for (auto& reading : readings)
+        {
+            writer.Append(reading);
+        }
+        return writer.Valid() && writer.Close();
+    }
+
+    double Magnitude(const SensorSample& sample)
+    {
+        return std::sqrt(sample.X * sample.X + sample.Y * sample.Y + sample.Z * sample.Z);
+    }
+
+    void TestRoundTrip()
+    {
+        // a last block that is not full
+        auto readings = Readings(10000, 50);
+        CHECK(Record(readings, 256));
+        MappedFile file(Path);
+        CHECK(file.Valid());
+        CHECK(file.Size() == sizeof(TraceFile::Header) + 10000 * sizeof(TraceFile::Record) + 40 * sizeof(TraceFile::Block));
+        TraceFileReader reader(file.Data(), file.Size());
+        CHECK(reader.Valid());
+        CHECK(reader.Count() == readings.size());
+        CHECK(reader.Index().EndBlock() == 40);
+
+        bool same = true;
+        for (size_t i = 0; i < readings.size() && same; ++i)
+        {
+            const TraceFile::Record& record = reader.Readings()[i];
+            same = record.Timestamp == readings[i].Timestamp && record.X == readings[i].X &&
+                record.Y == readings[i].Y && record.Z == readings[i].Z;
+        }
+        CHECK(same);
+
+        // the block summaries are the ones of the readings
+        const BlockSummary& last = reader.Index().Block(39);
+        BlockSummary expected;
+        expected.Reset();
+        for (size_t i = 39 * 256; i < readings.size(); ++i)
+        {
+            expected.Add(readings[i]);
+        }
+        CHECK(last.Count == expected.Count && last.First == expected.First && last.Last == expected.Last);
+        CHECK(last.MaximumMagnitude == expected.MaximumMagnitude && last.SumOfSquares == expected.SumOfSquares);
+
+        // a range query reads the readings in place
+        std::vector<long long> seen;
+        size_t visited = reader.Query(readings[300].Timestamp, readings[1000].Timestamp, [&](const SensorSample& sample)
+        {
+            seen.push_back(sample.Timestamp);
+        });
+        CHECK(visited == 701 && seen.size() == 701 && seen.front() == readings[300].Timestamp && seen.back() == readings[1000].Timestamp);
+    }
+
+    void TestQueriesAgreeWithScan()
+    {
+        auto readings = Readings(40000, 51);
+        CHECK(Record(readings, 128));
+        MappedFile file(Path);
+        TraceFileReader reader(file.Data(), file.Size());
+        CHECK(reader.Valid());
+
+        std::mt19937 random(49);
+        std::uniform_int_distribution<size_t> positions(0, readings.size() - 1);
+        bool agrees = true;
+        for (int query = 0; query < 500 && agrees; ++query)
+        {
+            size_t first = positions(random);
+            size_t last = positions(random);
+            if (first > last)
+            {
+                std::swap(first, last);
+            }
+            double expected = 0.0;
+            for (size_t i = first; i <= last; ++i)
+            {
+                expected = (std::max)(expected, Magnitude(readings[i]));
+            }
+            double maximum;
+            agrees = reader.MaximumMagnitude(readings[first].Timestamp, readings[last].Timestamp, maximum) &&
+                std::fabs(maximum - expected) < 1e-12;
+        }
+        CHECK(agrees);
+        double maximum;
+        CHECK(!reader.MaximumMagnitude(readings.back().Timestamp + 1, readings.back().Timestamp + 10000000, maximum));
+
+        // the blocks above an RMS, against the RMS of each block of the readings
+        const double rms = 1.2;
+        std::vector<long long> expected;
+        for (size_t begin = 0; begin < readings.size(); begin += 128)
+        {
+            double sumOfSquares = 0.0;
+            size_t end = (std::min)(begin + 128, readings.size());
+            for (size_t i = begin; i < end; ++i)
+            {
+                sumOfSquares += Magnitude(readings[i]) * Magnitude(readings[i]);
+            }
+            if (std::sqrt(sumOfSquares / (end - begin)) > rms)
+            {
+                expected.push_back(readings[begin].Timestamp);
+            }
+        }
+        std::vector<long long> found;
+        size_t above = reader.BlocksAbove(rms, [&](const BlockSummary& summary)
+        {
+            found.push_back(summary.First);
+        });
+        CHECK(!expected.empty() && above == expected.size() && found == expected);
+    }
+
+    void TestOrder()
+    {
+        // a late reading is dropped, one at the same time is kept
+        auto readings = Readings(300, 52);
+        {
+            TraceFileWriter writer(Path, 100);
+            for (auto& reading : readings)
+            {
+                CHECK(writer.Append(reading));
+            }
+            SensorSample late = readings.back();
+            late.Timestamp -= 1;
+            CHECK(!writer.Append(late));
+            CHECK(writer.Append(readings.back()));
+            CHECK(writer.Count() == 301 && writer.Dropped() == 1);
+        }
+        MappedFile file(Path);
+        TraceFileReader reader(file.Data(), file.Size());
+        CHECK(reader.Valid() && reader.Count() == 301 && reader.Index().EndBlock() == 4);
+    }
+
+    void TestDamaged()
+    {
+        auto readings = Readings(1000, 53);
+        CHECK(Record(readings, 64));
+        std::vector<char> bytes;
+        {
+            MappedFile file(Path);
+            const char* data = static_cast<const char*>(file.Data());
+            bytes.assign(data, data + file.Size());
+        }
+        CHECK(TraceFileReader(bytes.data(), bytes.size()).Valid());
+
+        // cut short, in the index and in the readings
+        CHECK(!TraceFileReader(bytes.data(), bytes.size() - 1).Valid());
+        CHECK(!TraceFileReader(bytes.data(), bytes.size() / 2).Valid());
+        CHECK(!TraceFileReader(bytes.data(), sizeof(TraceFile::Header) - 1).Valid());
+
+        // another format, or a header that does not match the file
+        std::vector<char> wrong = bytes;
+        wrong[0] = 'X';
+        CHECK(!TraceFileReader(wrong.data(), wrong.size()).Valid());
+        wrong = bytes;
+        TraceFile::Header header;
+        std::memcpy(&header, wrong.data(), sizeof(header));
+        header.Count += 1;
+        std::memcpy(wrong.data(), &header, sizeof(header));
+        CHECK(!TraceFileReader(wrong.data(), wrong.size()).Valid());
+
+        // a file whose writer never closed it has no header
+        {
+            TraceFileWriter writer(Path, 64);
+            for (auto& reading : readings)
+            {
+                writer.Append(reading);
+            }
+            std::ifstream unfinished(Path, std::ios::binary);
+            std::vector<char> partial((std::istreambuf_iterator<char>(unfinished)), std::istreambuf_iterator<char>());
+            CHECK(!TraceFileReader(partial.data(), partial.size()).Valid());
+        }
+
+        // an empty trace is a header alone
+        {
+            TraceFileWriter writer(Path, 64);
+            CHECK(writer.Close());
+            CHECK(!writer.Close());
+        }
+        MappedFile empty(Path);
+        CHECK(empty.Valid());
+        TraceFileReader reader(empty.Data(), empty.Size());
+        CHECK(reader.Valid() && reader.Count() == 0);
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestQueriesAgreeWithScan();
+    TestOrder();
+    TestDamaged();
+    std::remove(Path);
+    return Result(L"TraceFileTest");
+}
@@ -0,0 +1,177 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+//*********************************************************
+
+//
+// VirtualTimeTest.cpp
+// Runs the timer, the bounded queue and a Scenario3 session on virtual time
+//
+
+#include "pch.h"
+#include "Bench.h"
+#include "Check.h"
+#include "ScenarioGraphs.h"
+#include "SyntheticSensor.h"
+#include "VirtualTimeScheduler.h"
+
+using namespace SDKSample;
+using namespace SDKSample::Bench;
+using namespace SDKSample::Common;
+
+namespace
+{
+    void TestIntervalTimer()
+    {
+        VirtualTimeScheduler scheduler;
+        std::vector<size_t> ticks;
+        std::vector<VirtualTimeScheduler::time_point> times;
+        auto timer = IntervalTimer::Start(scheduler.Scheduler(), std::chrono::milliseconds(16), [&](size_t tick)
+        {
+            ticks.push_back(tick);
+            times.push_back(scheduler.Now());
+        });
+
+        scheduler.AdvanceBy(std::chrono::milliseconds(15));
+        CHECK(ticks.empty());
+        scheduler.AdvanceBy(std::chrono::milliseconds(1));
+        CHECK(ticks.size() == 1 && ticks[0] == 0);
+        scheduler.AdvanceBy(std::chrono::milliseconds(16 * 9));
+        CHECK(ticks.size() == 10 && ticks[9] == 9);
+        CHECK(times[9] - times[0] == std::chrono::milliseconds(16 * 9));
+
+        timer->Cancel();
+        scheduler.AdvanceBy(std::chrono::seconds(1));
+        CHECK(ticks.size() == 10);
+        CHECK(scheduler.Empty());
+    }
+
+    void TestIntervalTimerCancelledFromTick()
+    {
+        VirtualTimeScheduler scheduler;
+        std::shared_ptr<IntervalTimer> timer;
+        size_t ticks = 0;
+        timer = IntervalTimer::Start(scheduler.Scheduler(), std::chrono::milliseconds(10), [&](size_t tick)
+        {
+            ++ticks;
+            if (tick == 4)
+            {
+                timer->Cancel();
+            }
+        });
+        scheduler.RunAll();
+        CHECK(ticks == 5);
+        CHECK(timer->Ticks() == 5);
+        timer.reset();
+    }
+
+    void TestSampledQueue()
+    {
+        // a value every millisecond, sampled every 10: each sample is the latest value
+        VirtualTimeScheduler scheduler;
+        std::vector<int> delivered;
+        std::vector<VirtualTimeScheduler::time_point> times;
+        auto queue = std::make_shared<BoundedQueue<int>>(OverflowPolicy::Sample, 1, std::chrono::milliseconds(10), scheduler.Scheduler(),
+            [&](const int& value)
+            {
+                delivered.push_back(value);
+                times.push_back(scheduler.Now());
+            });
+        auto start = scheduler.Now();
+        for (int i = 0; i < 1000; ++i)
+        {
+            queue->Push(i);
+            scheduler.AdvanceBy(std::chrono::milliseconds(1));
+        }
+        CHECK(delivered.size() == 100);
+        CHECK(queue->Dropped() == 900);
+        CHECK(!delivered.empty() && delivered.front() == 9 && delivered.back() == 999);
+        CHECK(!times.empty() && times.front() - start == std::chrono::milliseconds(10));
+        queue->Close();
+    }
+
+    void TestStalledQueue()
+    {
+        // the consumer thread is busy while 10 values arrive: only the newest 4 are delivered
+        VirtualTimeScheduler scheduler;
+        std::vector<int> delivered;
+        auto queue = std::make_shared<BoundedQueue<int>>(OverflowPolicy::DropOldest, 4, BoundedQueue<int>::clock::duration::zero(), scheduler.Scheduler(),
+            [&](const int& value)
+            {
+                delivered.push_back(value);
+            });
+        for (int i = 0; i < 10; ++i)
+        {
+            queue->Push(i);
+        }
+        CHECK(delivered.empty());
+        scheduler.RunAll();
+        CHECK(delivered.size() == 4 && delivered.front() == 6 && delivered.back() == 9);
+        CHECK(queue->Dropped() == 6);
+        queue->Close();
+    }
+
+    struct Session
+    {
+        size_t Readings;
+        size_t Polls;
+        unsigned long long Shown;
+    };
+
+    // an hour of Scenario3 polling a 60 Hz sensor every 16ms, with the sensor on the same clock
+    Session RunScenario3Hour(bool report)
+    {
+        VirtualTimeScheduler scheduler;
+        SyntheticAccelerometer source(60.0, 3);
+        Scenario3Graph graph(ReportInterval(source.Period()) * 10000LL, scheduler.Scheduler());
+        auto sensor = IntervalTimer::Start(scheduler.Scheduler(),
+            std::chrono::duration_cast<VirtualTimeScheduler::duration>(std::chrono::nanoseconds(source.Period() * 100)),
+            [&](size_t)
+            {
+                graph.OnReading(source.Next());
+            });
+        graph.Start();
+
+        Stopwatch time;
+        scheduler.AdvanceBy(std::chrono::hours(1));
+        graph.Stop();
+        sensor->Cancel();
+        scheduler.RunAll();
+
+        Session session = {sensor->Ticks(), graph.Polls(), graph.Metrics().Samples()};
+        if (report)
+        {
+            std::wcout << L"an hour of Scenario3 in " << time.Seconds() << L"s: readings=" << session.Readings
+                << L" polls=" << session.Polls << L" shown=" << session.Shown
+                << L" work p50=" << scheduler.WorkCost().Percentile(0.5).count() << L"ns"
+                << L" p99=" << scheduler.WorkCost().Percentile(0.99).count() << L"ns\n";
+        }
+        return session;
+    }
+
+    void TestScenario3Hour()
+    {
+        auto first = RunScenario3Hour(true);
+        CHECK(first.Polls == 3600 * 1000 / 16);
+        CHECK(first.Readings == static_cast<size_t>(3600 * 10000000LL / SyntheticAccelerometer(60.0, 3).Period()));
+        // a reading is shown once, however many polls see it
+        CHECK(first.Shown <= first.Readings);
+        CHECK(first.Shown > first.Readings * 9 / 10);
+
+        auto second = RunScenario3Hour(false);
+        CHECK(second.Polls == first.Polls);
+        CHECK(second.Readings == first.Readings);
+        CHECK(second.Shown == first.Shown);
+    }
+}
+
+int main()
+{
+    TestIntervalTimer();
+    TestIntervalTimerCancelledFromTick();
+    TestSampledQueue();
+    TestStalledQueue();
+    TestScenario3Hour();
+    return Result(L"VirtualTimeTest");
+}